@@ -1,4 +1,11 @@
+#include "../src/BboConsolidator.h"
 #include "../src/Exchange.hpp"
+#include "../src/ShardedExchange.hpp"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <thread>
 #include <gtest/gtest.h>
 #include <chrono>
 
@@ -32,7 +39,7 @@ TEST_F(ExchangeTest, TestSearchingForTickerNotInExchange) {
 TEST_F(ExchangeTest, TestAddingLimitOrderToExchange) {
     std::string ttfTicker = "TTF 24Q-ICN";
     exchange->addInstrument(ttfTicker);
-    exchange->addOrder(ttfTicker, Side::Buy, 5, 47, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Buy, 5, 4700, OrderType::Limit);
 
     Book* ob = exchange->getOrderBook(ttfTicker);
 
@@ -49,7 +56,7 @@ TEST_F(ExchangeTest, AddingGTCOrderWithoutPrice) {
     exchange->addInstrument(ttfTicker);
 
     EXPECT_THROW({
-        exchange->addOrder(ttfTicker, Side::Buy, 5, -1, OrderType::Limit);
+        exchange->addOrder(ttfTicker, Side::Buy, 5, NO_PRICE, OrderType::Limit);
     }, std::invalid_argument);
 }
 
@@ -57,7 +64,7 @@ TEST_F(ExchangeTest, AddingGTCOrderWithoutPrice) {
 TEST_F(ExchangeTest, TestAddingMarketOrderToExchange) {
     std::string ttfTicker = "TTF 24Q-ICN";
     exchange->addInstrument(ttfTicker);
-    exchange->addOrder(ttfTicker, Side::Buy, 5, 47, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Buy, 5, 4700, OrderType::Limit);
     exchange->addOrder(ttfTicker, Side::Sell, 2, -1, OrderType::Market);
 
     Book* ob = exchange->getOrderBook(ttfTicker);
@@ -75,7 +82,7 @@ TEST_F(ExchangeTest, TestModifyOrderSizeFromExchange) {
     std::string ttfTicker = "TTF 24Q-ICN";
     exchange->addInstrument(ttfTicker);
 
-    exchange->addOrder(ttfTicker, Side::Buy, 5, 47, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Buy, 5, 4700, OrderType::Limit);
 
     Book* ob = exchange->getOrderBook(ttfTicker);
 
@@ -91,11 +98,11 @@ TEST_F(ExchangeTest, TestModifyOrderLimitFromExchange) {
     std::string ttfTicker = "TTF 24Q-ICN";
     exchange->addInstrument(ttfTicker);
 
-    exchange->addOrder(ttfTicker, Side::Buy, 5, 47, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Buy, 5, 4700, OrderType::Limit);
 
     Book* ob = exchange->getOrderBook(ttfTicker);
 
-    exchange->modifyLimitPrice(ttfTicker, 0, 50);
+    exchange->modifyLimitPrice(ttfTicker, 0, 5000);
 
     EXPECT_EQ(ob->getBuySide().getBestLimit()->getLimitPrice(), 5000);
     EXPECT_EQ(ob->getBuySide().getBestLimit()->getSize(), 1);
@@ -129,8 +136,8 @@ TEST_F(ExchangeTest, TestGetNBBO) {
     std::string ttfTicker = "TTF 24Q-ICN";
     exchange->addInstrument(ttfTicker);
 
-    exchange->addOrder(ttfTicker, Side::Buy, 5, 100, OrderType::Limit);
-    exchange->addOrder(ttfTicker, Side::Sell, 5, 200, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Buy, 5, 10000, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Sell, 5, 20000, OrderType::Limit);
 
     auto nbbo = exchange->getNBBO(ttfTicker);
 
@@ -143,7 +150,7 @@ TEST_F(ExchangeTest, TestGetNBBOWhenNoBid) {
     std::string ttfTicker = "TTF 24Q-ICN";
     exchange->addInstrument(ttfTicker);
 
-    exchange->addOrder(ttfTicker, Side::Sell, 5, 200, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Sell, 5, 20000, OrderType::Limit);
 
     auto nbbo = exchange->getNBBO(ttfTicker);
 
@@ -156,10 +163,516 @@ TEST_F(ExchangeTest, TestGetNBBOWhenNoAsk) {
     std::string ttfTicker = "TTF 24Q-ICN";
     exchange->addInstrument(ttfTicker);
 
-    exchange->addOrder(ttfTicker, Side::Buy, 5, 200, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Buy, 5, 20000, OrderType::Limit);
 
     auto nbbo = exchange->getNBBO(ttfTicker);
 
     EXPECT_EQ(nbbo.first, 20000);
     EXPECT_TRUE(!nbbo.second.has_value());
 }
+
+// the top of book slot changes once per message that moves the best levels, and a reader on
+// another thread only ever sees complete copies
+TEST_F(ExchangeTest, TestTopOfBookSlot) {
+    InstrumentId ttf = exchange->addInstrument("TTF 24Q-ICN");
+    const TopOfBookSlot& slot = exchange->getTopOfBook(ttf);
+    EXPECT_EQ(slot.read(), TopOfBook{});
+
+    exchange->addOrder(ttf, Side::Buy, 5, 4500, OrderType::Limit);
+    exchange->addOrder(ttf, Side::Buy, 3, 4500, OrderType::Limit);
+    exchange->addOrder(ttf, Side::Sell, 4, 4700, OrderType::Limit);
+    EXPECT_EQ(slot.read(), (TopOfBook{4500, 8, 2, 4700, 4, 1}));
+
+    const uint64_t version = slot.getVersion();
+    exchange->addOrder(ttf, Side::Buy, 1, 4400, OrderType::Limit);
+    EXPECT_EQ(slot.getVersion(), version);
+    exchange->addOrder(ttf, Side::Sell, 6, 4500, OrderType::Limit);
+    EXPECT_EQ(slot.getVersion(), version + 2);
+    EXPECT_EQ(slot.read(), (TopOfBook{4500, 2, 1, 4700, 4, 1}));
+    EXPECT_THROW(exchange->getTopOfBook(InstrumentId{7}), std::invalid_argument);
+
+    TopOfBookSlot shared;
+    shared.publish(TopOfBook{0, 0, 0, 0, 0, 0});
+    std::atomic<bool> done{false};
+    bool consistent = true;
+    std::thread reader([&] {
+        int32_t last = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            const TopOfBook top = shared.read();
+            const int32_t v = top.bidPrice;
+            consistent &= top.bidVolume == v && top.bidOrders == v && top.askPrice == v && top.askVolume == v
+                          && top.askOrders == v && v >= last;
+            last = v;
+        }
+    });
+    for (int32_t i = 1; i <= 200000; ++i) {
+        shared.publish(TopOfBook{i, i, i, i, i, i});
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(shared.getVersion(), 2 * 200001u);
+}
+
+// the consolidated quote follows each venue's top of book, attributes it, and matches a rescan
+TEST_F(ExchangeTest, TestConsolidatedBbo) {
+    Exchange ice("ICE");
+    Exchange eex("EEX");
+    const std::string ttfTicker = "TTF 24Q-ICN";
+    exchange->addInstrument(ttfTicker);
+    ice.addInstrument(ttfTicker);
+
+    BboConsolidator consolidator(4);
+    const VenueId endex = consolidator.addVenue(*exchange);
+    InstrumentId ttf = consolidator.track(ttfTicker);
+    const VenueId iceVenue = consolidator.addVenue(ice);
+    const VenueId eexVenue = consolidator.addVenue(eex);
+
+    exchange->addOrder(ttfTicker, Side::Buy, 5, 4500, OrderType::Limit);
+    exchange->addOrder(ttfTicker, Side::Sell, 5, 4700, OrderType::Limit);
+    ice.addOrder(ttfTicker, Side::Buy, 2, 4550, OrderType::Limit);
+    ice.addOrder(ttfTicker, Side::Sell, 9, 4700, OrderType::Limit);
+    EXPECT_EQ(consolidator.poll(), 2);
+    ConsolidatedQuote best = consolidator.getBest(ttf);
+    EXPECT_EQ(best.bidPrice, 4550);
+    EXPECT_EQ(best.bidVenue, iceVenue);
+    EXPECT_EQ(best.askPrice, 4700);
+    EXPECT_EQ(best.askVolume, 9); // the larger size wins a tie on price
+    EXPECT_EQ(best.askVenue, iceVenue);
+    EXPECT_EQ(consolidator.poll(), 0);
+
+    // a venue listing the instrument late is bound by tracking it again
+    eex.addInstrument(ttfTicker);
+    eex.addOrder(ttfTicker, Side::Sell, 1, 4600, OrderType::Limit);
+    EXPECT_EQ(consolidator.track(ttfTicker), ttf);
+    ice.cancelOrder(ttfTicker, 0);
+    EXPECT_EQ(consolidator.poll(), 2);
+    best = consolidator.getBest(ttf);
+    EXPECT_EQ(best.bidVenue, endex);
+    EXPECT_EQ(best.bidPrice, 4500);
+    EXPECT_EQ(best.askVenue, eexVenue);
+    EXPECT_EQ(best.askPrice, 4600);
+
+    Exchange cme("CME");
+    cme.addInstrument(ttfTicker, TickScale(1000));
+    BboConsolidator mixed(2);
+    mixed.addVenue(*exchange);
+    mixed.addVenue(cme);
+    EXPECT_THROW(mixed.track(ttfTicker), std::invalid_argument);
+
+    // random updates through the push API against a rescan of every venue
+    BboConsolidator pushed(7);
+    std::vector<std::unique_ptr<Exchange>> pushVenues;
+    for (int v = 0; v < 7; ++v) {
+        pushVenues.push_back(std::make_unique<Exchange>("VENUE" + std::to_string(v)));
+        pushed.addVenue(*pushVenues.back());
+    }
+    InstrumentId instrument = pushed.track(ttfTicker);
+    uint64_t lcg = 42;
+    for (int i = 0; i < 5000; ++i) {
+        lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+        const VenueId venue = static_cast<VenueId>((lcg >> 33) % 7);
+        const int32_t bid = static_cast<int32_t>((lcg >> 40) % 12);
+        const int32_t ask = static_cast<int32_t>((lcg >> 48) % 12);
+        pushed.update(instrument, venue, TopOfBook{bid == 0 ? NO_PRICE : 4000 + bid, bid % 3 + 1, 1,
+                                                   ask == 0 ? NO_PRICE : 4100 + ask, ask % 3 + 1, 1});
+
+        ConsolidatedQuote expected;
+        for (VenueId v = 0; v < 7; ++v) {
+            const TopOfBook& quote = pushed.getQuote(instrument, v);
+            if (quote.bidPrice != NO_PRICE && (expected.bidVenue == NO_VENUE || quote.bidPrice > expected.bidPrice
+                                               || (quote.bidPrice == expected.bidPrice && quote.bidVolume > expected.bidVolume))) {
+                expected.bidPrice = quote.bidPrice;
+                expected.bidVolume = quote.bidVolume;
+                expected.bidVenue = v;
+            }
+            if (quote.askPrice != NO_PRICE && (expected.askVenue == NO_VENUE || quote.askPrice < expected.askPrice
+                                               || (quote.askPrice == expected.askPrice && quote.askVolume > expected.askVolume))) {
+                expected.askPrice = quote.askPrice;
+                expected.askVolume = quote.askVolume;
+                expected.askVenue = v;
+            }
+        }
+        const ConsolidatedQuote actual = pushed.getBest(instrument);
+        ASSERT_EQ(actual.bidVenue, expected.bidVenue) << "update " << i;
+        ASSERT_EQ(actual.bidPrice, expected.bidPrice);
+        ASSERT_EQ(actual.askVenue, expected.askVenue) << "update " << i;
+        ASSERT_EQ(actual.askPrice, expected.askPrice);
+    }
+
+    // only added venues and tracked instruments are accepted, even where a row has room for more venues
+    EXPECT_THROW(consolidator.update(ttf, 3, TopOfBook{}), std::invalid_argument);
+    EXPECT_THROW(consolidator.getQuote(ttf, 3), std::invalid_argument);
+    EXPECT_THROW(pushed.getBest(InstrumentId{1}), std::invalid_argument);
+    EXPECT_NO_THROW(pushed.getBest(instrument));
+}
+
+// instruments are spread across shards and each book sees its own orders
+TEST_F(ExchangeTest, TestShardedExchangeRoutesByInstrument) {
+    ShardedExchange sharded("ENDEX", 3);
+    const std::string tickers[] = {"TTF 24Q-ICN", "TTF 24U-ICN", "TTF 24V-ICN", "TTF 24X-ICN"};
+    for (const auto& ticker : tickers)
+        sharded.addInstrument(ticker);
+
+    for (int i = 0; i < 100; ++i) {
+        for (const auto& ticker : tickers)
+            sharded.addOrder(ticker, Side::Buy, 1, 4000 + (i % 5) * 100, OrderType::Limit);
+    }
+    sharded.flush();
+
+    EXPECT_EQ(sharded.getShardFor(tickers[0]), sharded.getShardFor(tickers[3]));
+    EXPECT_NE(sharded.getShardFor(tickers[0]), sharded.getShardFor(tickers[1]));
+    for (const auto& ticker : tickers) {
+        Book* book = sharded.getOrderBook(ticker);
+        ASSERT_NE(book, nullptr);
+        EXPECT_EQ(book->getAllOrders().size(), 100);
+        EXPECT_EQ(book->getBuySide().getBestPrice(), 4400);
+    }
+    EXPECT_EQ(sharded.getRejectCount(), 0);
+}
+
+// the InstrumentId API reaches the same book as the ticker API
+TEST_F(ExchangeTest, TestOrdersByInstrumentId) {
+    std::string ttfTicker = "TTF 24Q-ICN";
+    InstrumentId ttf = exchange->addInstrument(ttfTicker);
+    InstrumentId other = exchange->addInstrument("TTF 24Z-ICN");
+
+    EXPECT_EQ(exchange->addInstrument(ttfTicker), ttf);
+    EXPECT_NE(ttf, other);
+    EXPECT_EQ(exchange->findInstrument(ttfTicker), ttf);
+    EXPECT_EQ(exchange->getOrderBook(ttf), exchange->getOrderBook(ttfTicker));
+
+    exchange->addOrder(ttf, Side::Buy, 5, 4700, OrderType::Limit);
+    exchange->modifyOrderSize(ttf, 0, 8);
+    exchange->modifyLimitPrice(ttf, 0, 4800);
+
+    auto nbbo = exchange->getNBBO(ttf);
+    EXPECT_EQ(nbbo.first, 4800);
+    EXPECT_EQ(exchange->getOrderBook(ttf)->getBuySide().getTotalVolume(), 8);
+
+    exchange->removeInstrument(ttfTicker);
+    EXPECT_EQ(exchange->getOrderBook(ttf), nullptr);
+    EXPECT_FALSE(exchange->findInstrument(ttfTicker).has_value());
+    EXPECT_THROW(exchange->addOrder(ttf, Side::Buy, 5, 4700, OrderType::Limit), std::runtime_error);
+}
+
+// shard threads deliver executions and count rejected commands
+TEST_F(ExchangeTest, TestShardedExchangeExecutionsAndRejects) {
+    ShardedExchange sharded("ENDEX", 2);
+    std::mutex mutex;
+    std::vector<ExecutionReport> fills;
+    sharded.setExecutionHandler([&](size_t, std::span<const ExecutionReport> batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fills.insert(fills.end(), batch.begin(), batch.end());
+    });
+
+    std::string ttfTicker = "TTF 24Q-ICN";
+    sharded.addInstrument(ttfTicker);
+    int64_t restingId = sharded.addOrder(ttfTicker, Side::Sell, 5, 4700, OrderType::Limit);
+    int64_t aggressorId = sharded.addOrder(ttfTicker, Side::Buy, 3, 4800, OrderType::Limit);
+    sharded.cancelOrder(ttfTicker, 12345);
+    sharded.flush();
+
+    ASSERT_EQ(fills.size(), 1);
+    EXPECT_EQ(fills[0].restingId, restingId);
+    EXPECT_EQ(fills[0].aggressorId, aggressorId);
+    EXPECT_EQ(fills[0].quantity, 3);
+    EXPECT_EQ(sharded.getRejectCount(), 1);
+    EXPECT_THROW(sharded.addOrder("UNKNOWN", Side::Buy, 1, 1000, OrderType::Limit), std::runtime_error);
+
+    // commands refused up front do not consume an order ID
+    EXPECT_THROW(sharded.addOrder(InstrumentId{9}, Side::Buy, 1, 1000, OrderType::Limit), std::runtime_error);
+    EXPECT_THROW(sharded.addStopOrder(InstrumentId{9}, Side::Buy, 1, 1000), std::runtime_error);
+    EXPECT_THROW(sharded.addStopOrder(ttfTicker, Side::Buy, 1, 0), std::invalid_argument);
+    EXPECT_THROW(sharded.addStopOrder(ttfTicker, Side::Buy, 1, 4900, -5), std::invalid_argument);
+    EXPECT_EQ(sharded.addStopOrder(ttfTicker, Side::Buy, 1, 4900), aggressorId + 1);
+}
+
+// the exchange drains every book's executions and depth updates after each message, even a sweep larger than the ring
+TEST_F(ExchangeTest, TestExchangeExecutionHandler) {
+    InstrumentId ttf = exchange->addInstrument("TTF 24Q-ICN");
+    Book* book = exchange->getOrderBook(ttf);
+    const int resting = static_cast<int>(ExecutionReportBuffer::DEFAULT_CAPACITY) + 44;
+    for (int i = 0; i < resting; ++i) {
+        exchange->addOrder(ttf, Side::Sell, 1, 4700 + i % 3, OrderType::Limit);
+    }
+    exchange->addOrder(ttf, Side::Buy, 1, 4700, OrderType::Limit);
+    EXPECT_TRUE(book->getExecutions().empty());
+    EXPECT_TRUE(book->getDepthUpdates().empty());
+
+    std::vector<ExecutionReport> fills;
+    exchange->setExecutionHandler([&](InstrumentId instrument, std::span<const ExecutionReport> batch) {
+        EXPECT_EQ(instrument, ttf);
+        fills.insert(fills.end(), batch.begin(), batch.end());
+    });
+    std::vector<DepthUpdate> levels;
+    exchange->setDepthHandler([&](InstrumentId instrument, const Book& updated, std::span<const DepthUpdate> batch) {
+        EXPECT_EQ(instrument, ttf);
+        EXPECT_EQ(&updated, book);
+        levels.insert(levels.end(), batch.begin(), batch.end());
+    });
+    exchange->addOrder(ttf, Side::Buy, resting - 1, NO_PRICE, OrderType::Market);
+
+    ASSERT_EQ(fills.size(), static_cast<size_t>(resting - 1));
+    for (size_t i = 1; i < fills.size(); ++i) {
+        EXPECT_EQ(fills[i].sequence, fills[i - 1].sequence + 1);
+    }
+    EXPECT_TRUE(book->getExecutions().empty());
+    EXPECT_EQ(book->getExecutions().getDroppedCount(), 0);
+    EXPECT_EQ(book->getExecutions().capacity(), ExecutionReportBuffer::DEFAULT_CAPACITY);
+    ASSERT_EQ(levels.size(), 3);
+    EXPECT_EQ(levels[0].price, 4700);
+    EXPECT_EQ(levels[2].price, 4702);
+    EXPECT_EQ(levels[2].volume, 0);
+    EXPECT_TRUE(book->getDepthUpdates().empty());
+}
+
+// replaying a journal into a fresh exchange rebuilds the same books and order IDs
+TEST_F(ExchangeTest, TestJournalReplay) {
+    const std::string path = (std::filesystem::temp_directory_path() / "exchange_journal_test.bin").string();
+    std::filesystem::remove(path);
+
+    std::string ttfTicker = "TTF 24Q-ICN";
+    exchange->attachJournal(std::make_unique<Journal>(path, JournalOptions{JournalSyncPolicy::EveryN, 16, 1000, 4096}));
+    InstrumentId ttf = exchange->addInstrument(ttfTicker, TickScale(), MatchingPolicy{MatchingAlgorithm::ProRata, ProRataRounding::Nearest, 100, SelfTradePrevention::CancelResting});
+    InstrumentId removed = exchange->addInstrument("TTF 24Z-ICN");
+    exchange->removeInstrument(removed);
+    for (int i = 0; i < 200; ++i) {
+        exchange->addOrder(ttf, i % 2 ? Side::Buy : Side::Sell, 10 + i % 7, (i % 2 ? 40 + i % 5 : 44 + i % 5) * 100, OrderType::Limit);
+    }
+    exchange->addOrder(ttf, Side::Buy, 25, -1, OrderType::Market);
+    EXPECT_EQ(exchange->addOrder(ttf, Side::Buy, 500, 4600, OrderType::Limit, TimeInForce::ImmediateOrCancel).status,
+              OrderStatus::Expired);
+    exchange->addOrder(ttf, Side::Sell, 3, 4000, OrderType::Limit, TimeInForce::PostOnlyReprice);
+    exchange->addStopOrder(ttf, Side::Sell, 4, 4000);
+    exchange->addStopOrder(ttf, Side::Buy, 6, 4800, 4900);
+    std::vector<int64_t> resting;
+    for (const auto& [orderId, order] : exchange->getOrderBook(ttf)->getAllOrders()) {
+        resting.push_back(orderId);
+    }
+    ASSERT_GE(resting.size(), 3);
+    exchange->cancelOrder(ttf, resting[0]);
+    EXPECT_THROW(exchange->cancelOrder(ttf, 99999), std::invalid_argument);
+    exchange->modifyOrderSize(ttf, resting[1], 2);
+    exchange->modifyLimitPrice(ttf, resting[2], 4600);
+    EXPECT_THROW(exchange->addOrder(ttf, Side::Buy, 0, 4000, OrderType::Limit), std::invalid_argument);
+    const OrderResult kept = exchange->addOrder(ttf, Side::Sell, 1, 5000, OrderType::Limit);
+    EXPECT_EQ(exchange->modifyOrderSize(ttf, kept.handle, 0), OrderStatus::RejectedInvalidSize);
+    EXPECT_THROW(exchange->modifyOrderSize(ttf, kept.orderId, -3), std::invalid_argument);
+    for (int i = 0; i < 6; ++i) {
+        exchange->addOrder(ttf, Side::Buy, 5, 3800 + i, OrderType::Limit, TimeInForce::GoodTillCancel, i % 2 ? 7 : 8);
+    }
+    EXPECT_EQ(exchange->massCancel(ParticipantId{7}), 3);
+    EXPECT_EQ(exchange->massCancel(ttf, Side::Buy, 3804, 3805), 1);
+
+    const uint64_t records = exchange->getJournal()->getRecordCount();
+    EXPECT_GT(exchange->getJournal()->getCapacity(), size_t{4096});
+    exchange->attachJournal(nullptr);
+
+    // a virtual clock is moved to each recorded message time
+    Exchange replayed("ICE", ClockSource::Virtual);
+    EXPECT_EQ(Journal::replay(path, replayed), records);
+
+    Book* original = exchange->getOrderBook(ttf);
+    Book* rebuilt = replayed.getOrderBook(ttfTicker);
+    ASSERT_NE(rebuilt, nullptr);
+    EXPECT_EQ(rebuilt->getMatchingPolicy().algorithm, MatchingAlgorithm::ProRata);
+    EXPECT_EQ(rebuilt->getMatchingPolicy().selfTradePrevention, SelfTradePrevention::CancelResting);
+    EXPECT_EQ(replayed.getOrderBook(removed), nullptr);
+    EXPECT_EQ(replayed.getNBBO(ttf), exchange->getNBBO(ttf));
+    EXPECT_EQ(rebuilt->getBuySide().getTotalVolume(), original->getBuySide().getTotalVolume());
+    EXPECT_EQ(rebuilt->getSellSide().getTotalVolume(), original->getSellSide().getTotalVolume());
+    ASSERT_EQ(rebuilt->getAllOrders().size(), original->getAllOrders().size());
+    for (const auto& [orderId, order] : original->getAllOrders()) {
+        const Order* copy = rebuilt->getAllOrders().get(orderId);
+        ASSERT_NE(copy, nullptr);
+        EXPECT_EQ(copy->getShares(), order->getShares());
+        EXPECT_EQ(copy->getLimit(), order->getLimit());
+        EXPECT_EQ(copy->getEntryTime(), order->getEntryTime());
+        EXPECT_EQ(copy->getEventTime(), order->getEventTime());
+        EXPECT_EQ(copy->getParticipant(), order->getParticipant());
+    }
+    EXPECT_EQ(rebuilt->getParticipants().count(8), 2);
+
+    // the order ID sequence continues from the same place
+    exchange->addOrder(ttf, Side::Buy, 1, 100, OrderType::Limit);
+    replayed.addOrder(ttf, Side::Buy, 1, 100, OrderType::Limit);
+    EXPECT_EQ(rebuilt->getBuySide().getBestLimit()->getLimitPrice(), original->getBuySide().getBestLimit()->getLimitPrice());
+    EXPECT_EQ(rebuilt->getAllOrders().size(), original->getAllOrders().size());
+    for (const auto& [orderId, order] : original->getAllOrders()) {
+        EXPECT_NE(rebuilt->getAllOrders().get(orderId), nullptr);
+    }
+
+    // reopening appends after the existing records
+    {
+        Journal reopened(path);
+        EXPECT_EQ(reopened.getRecordCount(), records);
+    }
+    std::filesystem::remove(path);
+}
+
+// EveryMicros syncs by message time, and poll() syncs records left behind by a quiet period
+TEST_F(ExchangeTest, TestJournalSyncEveryMicros) {
+    const std::string path = (std::filesystem::temp_directory_path() / "exchange_journal_sync_test.bin").string();
+    std::filesystem::remove(path);
+
+    Exchange virtualExchange("ICE", ClockSource::Virtual);
+    InstrumentId ttf = virtualExchange.addInstrument("TTF 24Q-ICN");
+    virtualExchange.attachJournal(std::make_unique<Journal>(path, JournalOptions{JournalSyncPolicy::EveryMicros, 1024, 50, 4096}));
+    Journal* journal = virtualExchange.getJournal();
+    virtualExchange.getClock().setTime(1'000'000);
+    virtualExchange.addOrder(ttf, Side::Buy, 10, 4000, OrderType::Limit);
+    virtualExchange.getClock().setTime(1'030'000);
+    virtualExchange.addOrder(ttf, Side::Buy, 10, 4001, OrderType::Limit);
+    EXPECT_EQ(journal->getUnsyncedRecords(), 2);
+
+    virtualExchange.poll();
+    EXPECT_EQ(journal->getUnsyncedRecords(), 2);
+    virtualExchange.getClock().setTime(1'050'000);
+    virtualExchange.poll();
+    EXPECT_EQ(journal->getUnsyncedRecords(), 0);
+
+    // an append past the interval syncs without a poll
+    virtualExchange.addOrder(ttf, Side::Sell, 10, 4100, OrderType::Limit);
+    virtualExchange.getClock().setTime(1'120'000);
+    virtualExchange.addOrder(ttf, Side::Sell, 10, 4101, OrderType::Limit);
+    EXPECT_EQ(journal->getUnsyncedRecords(), 0);
+    EXPECT_EQ(journal->getRecordCount(), 4);
+
+    virtualExchange.attachJournal(nullptr);
+    std::filesystem::remove(path);
+}
+
+// a restored snapshot has the same levels, FIFO queues, instrument IDs and order ID sequence
+TEST_F(ExchangeTest, TestSnapshotRoundTrip) {
+    std::string ttfTicker = "TTF 24Q-ICN";
+    InstrumentId removed = exchange->addInstrument("TTF 24Z-ICN");
+    InstrumentId ttf = exchange->addInstrument(ttfTicker);
+    InstrumentId empty = exchange->addInstrument("TTF 25F-ICN", TickScale(4), MatchingPolicy{MatchingAlgorithm::TopOrderProRata, ProRataRounding::Up, 40, SelfTradePrevention::DecrementAndCancel});
+    exchange->removeInstrument(removed);
+    for (int i = 0; i < 300; ++i) {
+        exchange->addOrder(ttf, i % 2 ? Side::Buy : Side::Sell, 1 + i % 9, (i % 2 ? 40 + i % 4 : 45 + i % 4) * 100, OrderType::Limit,
+                           TimeInForce::GoodTillCancel, static_cast<ParticipantId>(i % 3));
+    }
+    exchange->addOrder(ttf, Side::Sell, 7, -1, OrderType::Market);
+    exchange->addStopOrder(ttf, Side::Buy, 10, 4500, 4600, 2);
+    exchange->addStopOrder(ttf, Side::Sell, 3, 4000);
+
+    Exchange restored("ICE");
+    restored.restoreSnapshot(exchange->snapshot());
+
+    EXPECT_EQ(restored.getOrderBook(removed), nullptr);
+    ASSERT_NE(restored.getOrderBook(empty), nullptr);
+    EXPECT_TRUE(restored.getOrderBook(empty)->getAllOrders().empty());
+    EXPECT_EQ(restored.getTickScale(empty).getTicksPerUnit(), 4);
+    EXPECT_EQ(restored.getOrderBook(empty)->getMatchingPolicy().algorithm, MatchingAlgorithm::TopOrderProRata);
+    EXPECT_EQ(restored.getOrderBook(empty)->getMatchingPolicy().rounding, ProRataRounding::Up);
+    EXPECT_EQ(restored.getOrderBook(empty)->getMatchingPolicy().topOrderPercent, 40);
+    EXPECT_EQ(restored.getOrderBook(empty)->getMatchingPolicy().selfTradePrevention, SelfTradePrevention::DecrementAndCancel);
+    EXPECT_EQ(restored.getTickScale(empty).toTicks(47.25), 189);
+    EXPECT_EQ(restored.findInstrument(ttfTicker), ttf);
+
+    Book* original = exchange->getOrderBook(ttf);
+    Book* rebuilt = restored.getOrderBook(ttf);
+    EXPECT_EQ(restored.getNBBO(ttf), exchange->getNBBO(ttf));
+    ASSERT_NE(rebuilt->getTriggerBook(), nullptr);
+    EXPECT_EQ(rebuilt->getTriggerBook()->size(), 2);
+    EXPECT_EQ(rebuilt->getLastTradePrice(), original->getLastTradePrice());
+    EXPECT_EQ(rebuilt->getBuySide().getTotalVolume(), original->getBuySide().getTotalVolume());
+    EXPECT_EQ(rebuilt->getSellSide().getTotalVolume(), original->getSellSide().getTotalVolume());
+    EXPECT_EQ(rebuilt->getAllOrders().size(), original->getAllOrders().size());
+    EXPECT_EQ(rebuilt->getParticipants().count(2), original->getParticipants().count(2));
+    for (int price = 4000; price <= 4900; price += 100) {
+        Limit* expected = original->getBuySide().getLimit(price);
+        if (!expected || expected->empty()) {
+            expected = original->getSellSide().getLimit(price);
+        }
+        Limit* actual = rebuilt->getBuySide().getLimit(price);
+        if (!actual || actual->empty()) {
+            actual = rebuilt->getSellSide().getLimit(price);
+        }
+        if (!expected || expected->empty()) {
+            EXPECT_TRUE(!actual || actual->empty());
+            continue;
+        }
+        ASSERT_NE(actual, nullptr);
+        EXPECT_EQ(actual->getTotalVolume(), expected->getTotalVolume());
+        const Order* a = actual->getHead();
+        for (const Order* e = expected->getHead(); e; e = e->getNextOrder(), a = a->getNextOrder()) {
+            ASSERT_NE(a, nullptr);
+            EXPECT_EQ(a->getOrderId(), e->getOrderId());
+            EXPECT_EQ(a->getShares(), e->getShares());
+            EXPECT_EQ(a->getEventTime(), e->getEventTime());
+            EXPECT_EQ(a->getParticipant(), e->getParticipant());
+        }
+        EXPECT_EQ(a, nullptr);
+    }
+
+    // matching, stop triggering and ID assignment carry on identically
+    exchange->addOrder(ttf, Side::Buy, 20, 4600, OrderType::Limit);
+    restored.addOrder(ttf, Side::Buy, 20, 4600, OrderType::Limit);
+    EXPECT_EQ(restored.getNBBO(ttf), exchange->getNBBO(ttf));
+    EXPECT_EQ(rebuilt->getTriggerBook()->size(), 1);
+    EXPECT_EQ(original->getTriggerBook()->size(), 1);
+    for (const auto& [orderId, order] : original->getAllOrders()) {
+        const Order* copy = rebuilt->getAllOrders().get(orderId);
+        ASSERT_NE(copy, nullptr);
+        EXPECT_EQ(copy->getShares(), order->getShares());
+    }
+
+    EXPECT_THROW(restored.restoreSnapshot(exchange->snapshot()), std::runtime_error);
+    std::vector<char> truncated = exchange->snapshot();
+    truncated.resize(truncated.size() - 5);
+    Exchange broken("ICE");
+    EXPECT_THROW(broken.restoreSnapshot(truncated), std::runtime_error);
+    EXPECT_TRUE(broken.getTickerList().empty());
+
+    // a next order ID at or below a restored order's ID, e.g. negative, would reissue that ID
+    int64_t maxOrderId = -1;
+    for (const auto& [orderId, order] : original->getAllOrders()) {
+        maxOrderId = std::max(maxOrderId, orderId);
+    }
+    for (int64_t nextOrderId : {int64_t{-1}, maxOrderId}) {
+        std::vector<char> reissuing = exchange->snapshot();
+        std::memcpy(reissuing.data() + 16, &nextOrderId, sizeof(nextOrderId));
+        Exchange rejected("ICE");
+        EXPECT_THROW(rejected.restoreSnapshot(reissuing), std::runtime_error);
+        EXPECT_TRUE(rejected.getTickerList().empty());
+    }
+}
+
+// log-linear buckets stay within 1/16 of the value, and per-book histograms merge on read
+TEST_F(ExchangeTest, TestLatencyHistograms) {
+    LatencyHistogram histogram;
+    for (int64_t nanos = 1; nanos <= 1000; ++nanos) {
+        histogram.record(nanos);
+    }
+    histogram.record(int64_t{1} << 40);
+    for (int64_t nanos : {int64_t{0}, int64_t{15}, int64_t{17}, int64_t{1000}, int64_t{123456789}}) {
+        const int64_t upper = LatencyHistogram::highestIn(LatencyHistogram::bucketOf(nanos));
+        EXPECT_GE(upper, nanos);
+        EXPECT_LE(upper - nanos, nanos / 16);
+    }
+
+    LatencyDistribution distribution;
+    distribution.merge(histogram);
+    EXPECT_EQ(distribution.getCount(), 1001);
+    EXPECT_EQ(distribution.getMax(), int64_t{1} << 40);
+    EXPECT_NEAR(distribution.percentile(50), 500, 500 / 16);
+    EXPECT_NEAR(distribution.percentile(99), 990, 990 / 16);
+    EXPECT_EQ(distribution.percentile(100), int64_t{1} << 40);
+    EXPECT_EQ(LatencyDistribution().percentile(99), 0);
+
+    InstrumentId first = exchange->addInstrument("TTF 24Q-ICN");
+    InstrumentId second = exchange->addInstrument("TTF 24Z-ICN");
+    for (InstrumentId instrument : {first, second}) {
+        exchange->addOrder(instrument, Side::Sell, 5, 4700, OrderType::Limit);
+        exchange->addOrder(instrument, Side::Buy, 2, 4700, OrderType::Limit);
+    }
+    exchange->cancelOrder(first, 0);
+    const uint64_t expectedAdds = LATENCY_STATS_ENABLED ? 4 : 0;
+    EXPECT_EQ(exchange->getLatency(LatencyOp::AddOrder).getCount(), expectedAdds);
+    EXPECT_EQ(exchange->getLatency(LatencyOp::MatchSweep).getCount(), expectedAdds / 2);
+    EXPECT_EQ(exchange->getLatency(LatencyOp::MatchLevel).getCount(), expectedAdds / 2);
+    EXPECT_EQ(exchange->getLatency(LatencyOp::CancelOrder).getCount(), expectedAdds / 4);
+}
@@ -1,6 +1,9 @@
 #include "../src/Book.h"
 #include <gtest/gtest.h>
 #include <chrono>
+#include <limits>
+#include <map>
+#include <set>
 
 using namespace std::chrono;
 
@@ -16,7 +19,7 @@ protected:
 
 // Test for adding the first buy order
 TEST_F(LimitOrderTest, AddingFirstBuyOrder) {
-    float orderPrice = 25.09;
+    Price orderPrice = 2509;
     int limitPrice = 2509;
     int volume = 3;
     OrderType orderType = OrderType::Limit;
@@ -36,12 +39,12 @@ TEST_F(LimitOrderTest, AddingFirstBuyOrder) {
 
 // Test for adding the first sell order
 TEST_F(LimitOrderTest, AddingFirstSellOrder) {
-    float floatPrice = 30.052;
+    Price tickPrice = TickScale().toTicks(30.052);
     int orderPrice = 3005;
     int insertedSize = 5;
     OrderType orderType = OrderType::Limit;
     
-    orderBook->addOrderToBook(Side::Sell, insertedSize, floatPrice, orderType, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, insertedSize, tickPrice, orderType, orderIdSequence);
 
     Limit* lowestSell = orderBook->getSellSide().getBestLimit();
     ASSERT_NE(lowestSell, nullptr);
@@ -56,8 +59,8 @@ TEST_F(LimitOrderTest, AddingFirstSellOrder) {
 // Test for adding worse buy and sell orders
 TEST_F(LimitOrderTest, AddingWorseBuyAndSellOrders) {
     
-    orderBook->addOrderToBook(Side::Buy, 2, 20.05, OrderType::Limit, orderIdSequence); // Lower buy price
-    orderBook->addOrderToBook(Side::Sell, 2, 35.00, OrderType::Limit, orderIdSequence); // Higher sell price
+    orderBook->addOrderToBook(Side::Buy, 2, 2005, OrderType::Limit, orderIdSequence); // Lower buy price
+    orderBook->addOrderToBook(Side::Sell, 2, 3500, OrderType::Limit, orderIdSequence); // Higher sell price
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getLimitPrice(), 2005);
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getLimitPrice(), 3500);
@@ -65,7 +68,7 @@ TEST_F(LimitOrderTest, AddingWorseBuyAndSellOrders) {
 
 // Test for adding order to existing limit
 TEST_F(LimitOrderTest, AddingOrderToExistingLimit) {
-    float price = 25.03;
+    Price price = 2503;
 
     orderBook->addOrderToBook(Side::Buy, 3, price, OrderType::Limit, orderIdSequence);
     orderBook->addOrderToBook(Side::Buy, 2, price, OrderType::Limit, orderIdSequence); // Same price
@@ -77,12 +80,12 @@ TEST_F(LimitOrderTest, AddingOrderToExistingLimit) {
 
 // Test for checking all orders in unordered map
 TEST_F(LimitOrderTest, CheckAllOrdersUnorderedMap) {
-    orderBook->addOrderToBook(Side::Buy, 3, 25.04, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 3, 30.00, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 2, 26.02, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 2, 29.14, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 2, 26.02, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 2, 29.14, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 3, 2504, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 3, 3000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 2, 2602, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 2, 2914, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 2, 2602, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 2, 2914, OrderType::Limit, orderIdSequence);
 
     // BIND REFERENCE, DO NOT COPY
     const auto& allOrders = orderBook->getAllOrders();
@@ -112,10 +115,10 @@ TEST_F(LimitOrderTest, CheckAllOrdersUnorderedMap) {
 // Test for adding best buy and sell orders
 TEST_F(LimitOrderTest, AddingBestBuyAndSellOrders) {
 
-    orderBook->addOrderToBook(Side::Buy, 3, 25.04, OrderType::Limit, orderIdSequence); // Initial best buy
-    orderBook->addOrderToBook(Side::Sell, 3, 30.00, OrderType::Limit, orderIdSequence); // Initial best sell
-    orderBook->addOrderToBook(Side::Buy, 2, 26.02, OrderType::Limit, orderIdSequence); // Better buy
-    orderBook->addOrderToBook(Side::Sell, 2, 29.14, OrderType::Limit, orderIdSequence); // Better sell
+    orderBook->addOrderToBook(Side::Buy, 3, 2504, OrderType::Limit, orderIdSequence); // Initial best buy
+    orderBook->addOrderToBook(Side::Sell, 3, 3000, OrderType::Limit, orderIdSequence); // Initial best sell
+    orderBook->addOrderToBook(Side::Buy, 2, 2602, OrderType::Limit, orderIdSequence); // Better buy
+    orderBook->addOrderToBook(Side::Sell, 2, 2914, OrderType::Limit, orderIdSequence); // Better sell
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getLimitPrice(), 2602);
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getLimitPrice(), 2914);
@@ -124,13 +127,13 @@ TEST_F(LimitOrderTest, AddingBestBuyAndSellOrders) {
 // Test for adding worst buy limits
 TEST_F(LimitOrderTest, Adding3WorstBuyLimits) {
 
-    orderBook->addOrderToBook(Side::Buy, 10, 10.04, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 2, 9, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 5, 9, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 1004, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 2, 900, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 5, 900, OrderType::Limit, orderIdSequence);
 
     int bestPrice = orderBook->getBuySide().getBestLimit()->getLimitPrice();
     
-    orderBook->addOrderToBook(Side::Buy, 10, 9, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 900, OrderType::Limit, orderIdSequence);
     int vol =orderBook->getBuySide().getTotalVolume();
     
     EXPECT_EQ(bestPrice, 1004);
@@ -140,13 +143,13 @@ TEST_F(LimitOrderTest, Adding3WorstBuyLimits) {
 // Test for adding worst sell limits
 TEST_F(LimitOrderTest, Adding3WorstSellLimits) {
 
-    orderBook->addOrderToBook(Side::Sell, 30, 30.15, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 40, 31.12, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 45, 31.12, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 30, 3015, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 40, 3112, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 45, 3112, OrderType::Limit, orderIdSequence);
 
     int bestPrice = orderBook->getSellSide().getBestLimit()->getLimitPrice();
     
-    orderBook->addOrderToBook(Side::Sell, 15, 31.12, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 15, 3112, OrderType::Limit, orderIdSequence);
     int vol =orderBook->getSellSide().getTotalVolume();
 
     EXPECT_EQ(bestPrice, 3015);
@@ -157,7 +160,7 @@ TEST_F(LimitOrderTest, Adding3WorstSellLimits) {
 TEST_F(LimitOrderTest, NegativeSizeTest) {
 
     EXPECT_THROW({
-        orderBook->addOrderToBook(Side::Buy, -30, 30.00, OrderType::Limit, orderIdSequence);
+        orderBook->addOrderToBook(Side::Buy, -30, 3000, OrderType::Limit, orderIdSequence);
     }, std::invalid_argument);
 }
 
@@ -165,14 +168,25 @@ TEST_F(LimitOrderTest, NegativeSizeTest) {
 TEST_F(LimitOrderTest, NegativeLimitPrice) {
 
     EXPECT_THROW({
-        orderBook->addOrderToBook(Side::Buy, 315, -100, OrderType::Limit, orderIdSequence);
+        orderBook->addOrderToBook(Side::Buy, 315, -10000, OrderType::Limit, orderIdSequence);
     }, std::invalid_argument);
 }
 
+// Test that decimal prices without a tick representation are rejected rather than narrowed
+TEST_F(LimitOrderTest, UnrepresentablePriceInTicks) {
+    TickScale cents;
+    EXPECT_EQ(cents.toTicks(-0.5), -50);
+    EXPECT_EQ(cents.toTicks(21474836.47), 2147483647);
+    EXPECT_THROW(cents.toTicks(21474836.48), std::invalid_argument);
+    EXPECT_THROW(cents.toTicks(-1e300), std::invalid_argument);
+    EXPECT_THROW(cents.toTicks(std::numeric_limits<double>::quiet_NaN()), std::invalid_argument);
+    EXPECT_THROW(cents.toTicks(std::numeric_limits<double>::infinity()), std::invalid_argument);
+}
+
 // Test for correct value in order
 TEST_F(LimitOrderTest, CorrectValueInOrder) {
 
-    orderBook->addOrderToBook(Side::Sell, 30, 30.15, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 30, 3015, OrderType::Limit, orderIdSequence);
 
     auto sellTree = orderBook->getSellSide().getBestLimit();
     auto order = sellTree->getHead();
@@ -181,7 +195,7 @@ TEST_F(LimitOrderTest, CorrectValueInOrder) {
     EXPECT_EQ(30, order->getShares());
     EXPECT_EQ(Side::Sell, order->getOrderSide());
 
-    orderBook->addOrderToBook(Side::Sell, 5, 30.15, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 3015, OrderType::Limit, orderIdSequence);
     sellTree = orderBook->getSellSide().getBestLimit();
     order = sellTree->getHead();
     auto nextOrder = order->getNextOrder();
@@ -194,8 +208,8 @@ TEST_F(LimitOrderTest, CorrectValueInOrder) {
 // Test for sell limit orders crossing the spread
 TEST_F(LimitOrderTest, TestSellLimitOrdersCrossingSpread) {
 
-    orderBook->addOrderToBook(Side::Buy, 50, 15, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 40, 7, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 50, 1500, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 40, 700, OrderType::Limit, orderIdSequence);
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getTotalVolume(), 10);
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getLimitPrice(), 1500);
@@ -204,8 +218,8 @@ TEST_F(LimitOrderTest, TestSellLimitOrdersCrossingSpread) {
 // Test for buy limit orders crossing the spread
 TEST_F(LimitOrderTest, TestBuyLimitOrdersCrossingSpread) {
 
-    orderBook->addOrderToBook(Side::Sell, 60, 24.00, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 70, 30.00, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 60, 2400, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 70, 3000, OrderType::Limit, orderIdSequence);
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getTotalVolume(), 10);
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getLimitPrice(), 3000);
@@ -214,9 +228,9 @@ TEST_F(LimitOrderTest, TestBuyLimitOrdersCrossingSpread) {
 // Test for limit order filling best sell limit
 TEST_F(LimitOrderTest, TestLimitOrderFillsBestSellLimit) {
 
-    orderBook->addOrderToBook(Side::Sell, 35, 24.90, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 100, 30, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 75, 35.00, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 35, 2490, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 100, 3000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 75, 3500, OrderType::Limit, orderIdSequence);
 
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getTotalVolume(), 60);
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getLimitPrice(), 3000);
@@ -225,9 +239,9 @@ TEST_F(LimitOrderTest, TestLimitOrderFillsBestSellLimit) {
 // Test for limit order filling best buy limit
 TEST_F(LimitOrderTest, TestLimitOrderFillsBestBuyLimit) {
 
-    orderBook->addOrderToBook(Side::Buy, 35, 24.90, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 100, 30, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 115, 20, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 35, 2490, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 100, 3000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 115, 2000, OrderType::Limit, orderIdSequence);
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getTotalVolume(), 20);
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getLimitPrice(), 2490);
@@ -236,9 +250,9 @@ TEST_F(LimitOrderTest, TestLimitOrderFillsBestBuyLimit) {
 // Test for limit order crossing the first level
 TEST_F(LimitOrderTest, TestLimitCrossFirstLevel) {
 
-    orderBook->addOrderToBook(Side::Sell, 10, 45, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 5, 40, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 7, 42.50, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 10, 4500, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 4000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 7, 4250, OrderType::Limit, orderIdSequence);
 
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getTotalVolume(), 10);
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getLimitPrice(), 4500);
@@ -248,9 +262,9 @@ TEST_F(LimitOrderTest, TestLimitCrossFirstLevel) {
 
 // Test for canceling the full book
 TEST_F(LimitOrderTest, LimitCancelFullBook) {
-    orderBook->addOrderToBook(Side::Sell, 10, 45, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 5, 40, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 15, 50, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 10, 4500, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 4000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 15, 5000, OrderType::Limit, orderIdSequence);
 
     // For Buy side: expect bestPrice to be -1 (no bids)
     EXPECT_EQ(orderBook->getBuySide().getBestPrice(), -1);
@@ -263,9 +277,9 @@ TEST_F(LimitOrderTest, LimitCancelFullBook) {
 
 // Test for canceling a book and placing an order
 TEST_F(LimitOrderTest, LimitCancelBookAndPlaceOrder) {
-    orderBook->addOrderToBook(Side::Sell, 10, 45, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 5, 40, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 20, 50, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 10, 4500, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 4000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 20, 5000, OrderType::Limit, orderIdSequence);
 
     // Buy side: expect best price to be 5000
     EXPECT_EQ(orderBook->getBuySide().getBestPrice(), 5000);
@@ -284,9 +298,9 @@ TEST_F(LimitOrderTest, LimitCancelBookAndPlaceOrder) {
 
 // Test for canceling a middle order in a limit
 TEST_F(LimitOrderTest, TestCancelMiddleOrderInLimit) {
-    orderBook->addOrderToBook(Side::Buy, 10, 47, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 20, 47, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 30, 47, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 4700, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 20, 4700, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 30, 4700, OrderType::Limit, orderIdSequence);
 
     orderBook->cancelOrder(1);
 
@@ -299,8 +313,8 @@ TEST_F(LimitOrderTest, TestCancelMiddleOrderInLimit) {
 
 // Test for canceling the head order
 TEST_F(LimitOrderTest, TestCancelHeadOrder) {
-    orderBook->addOrderToBook(Side::Buy, 10, 47, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 20, 47, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 4700, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 20, 4700, OrderType::Limit, orderIdSequence);
 
     orderBook->cancelOrder(0);
 
@@ -311,8 +325,8 @@ TEST_F(LimitOrderTest, TestCancelHeadOrder) {
 
 // Test for canceling the tail order
 TEST_F(LimitOrderTest, TestCancelTailOrder) {
-    orderBook->addOrderToBook(Side::Sell, 10, 47, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 20, 47, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 10, 4700, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 20, 4700, OrderType::Limit, orderIdSequence);
 
     orderBook->cancelOrder(1);
 
@@ -323,8 +337,8 @@ TEST_F(LimitOrderTest, TestCancelTailOrder) {
 
 // Test for canceling order that deletes a limit level
 TEST_F(LimitOrderTest, TestCancelOrderThatDeletsLimitLevel) {
-    orderBook->addOrderToBook(Side::Sell, 10, 47, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Sell, 20, 45, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 10, 4700, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 20, 4500, OrderType::Limit, orderIdSequence);
 
     orderBook->cancelOrder(1);
 
@@ -335,7 +349,7 @@ TEST_F(LimitOrderTest, TestCancelOrderThatDeletsLimitLevel) {
 
 // Test for canceling order that deletes the book
 TEST_F(LimitOrderTest, TestCancelOrderThatDeletsBook) {
-    orderBook->addOrderToBook(Side::Sell, 10, 47, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 10, 4700, OrderType::Limit, orderIdSequence);
 
     orderBook->cancelOrder(0);
 
@@ -352,9 +366,9 @@ TEST_F(LimitOrderTest, CancelOrderNotInBook) {
 
 // Test for modifying order limit
 TEST_F(LimitOrderTest, TestModifyingOrderLimit) {
-    orderBook->addOrderToBook(Side::Sell, 20, 50, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 20, 5000, OrderType::Limit, orderIdSequence);
 
-    orderBook->modifyOrderLimitPrice(0, 40, orderIdSequence);
+    orderBook->modifyOrderLimitPrice(0, 4000);
 
     EXPECT_EQ(orderBook->getSellSide().getLimit(4000)->getSize(), 1);
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getLimitPrice(), 4000);
@@ -362,10 +376,10 @@ TEST_F(LimitOrderTest, TestModifyingOrderLimit) {
 
 // Test for modifying order limit into an existing limit
 TEST_F(LimitOrderTest, TestModifyingOrderLimitIntoExistingLimit) {
-    orderBook->addOrderToBook(Side::Buy, 10, 47, OrderType::Limit, orderIdSequence);
-    orderBook->addOrderToBook(Side::Buy, 10, 45, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 4700, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 4500, OrderType::Limit, orderIdSequence);
 
-    orderBook->modifyOrderLimitPrice(0, 45, orderIdSequence);
+    orderBook->modifyOrderLimitPrice(0, 4500);
 
     EXPECT_EQ(orderBook->getBuySide().getLimit(4500)->getSize(), 2);
     EXPECT_EQ(orderBook->getBuySide().getLimit(4500)->getTotalVolume(), 20);
@@ -373,9 +387,658 @@ TEST_F(LimitOrderTest, TestModifyingOrderLimitIntoExistingLimit) {
 
 // Test for changing order size
 TEST_F(LimitOrderTest, TestChangingOrderSize) {
-    orderBook->addOrderToBook(Side::Buy, 10, 45, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 4500, OrderType::Limit, orderIdSequence);
     orderBook->modifyOrderSize(0, 20);
 
     EXPECT_EQ(orderBook->getBuySide().getLimit(4500)->getTotalVolume(), 20);
     EXPECT_EQ(orderBook->getBuySide().getLimit(4500)->getSize(), 1);
+    EXPECT_THROW(orderBook->modifyOrderSize(0, 0), std::invalid_argument);
+    EXPECT_THROW(orderBook->modifyOrderSize(0, -5), std::invalid_argument);
+
+    // a decrease keeps the order's place in the queue, an increase sends it to the back
+    orderBook->addOrderToBook(Side::Buy, 10, 4500, OrderType::Limit, orderIdSequence);
+    orderBook->modifyOrderSize(0, 15);
+    EXPECT_EQ(orderBook->getBuySide().getLimit(4500)->getHead()->getOrderId(), 0);
+    orderBook->modifyOrderSize(0, 16);
+    const Limit* level = orderBook->getBuySide().getLimit(4500);
+    EXPECT_EQ(level->getHead()->getOrderId(), 1);
+    EXPECT_EQ(level->getTail()->getOrderId(), 0);
+    EXPECT_EQ(level->getTotalVolume(), 26);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 26);
+}
+
+// Test that canceled orders hand their slots back to the pool
+TEST_F(LimitOrderTest, CanceledOrdersAreRecycledByPool) {
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            orderBook->addOrderToBook(Side::Buy, 5, 1000 + i, OrderType::Limit, orderIdSequence);
+        }
+        for (int i = 0; i < 100; ++i) {
+            orderBook->cancelOrder(round * 100 + i);
+        }
+    }
+
+    const OrderPool& pool = orderBook->getOrderPool();
+    EXPECT_EQ(pool.getLiveCount(), 0);
+    EXPECT_EQ(pool.getHighWaterMark(), 100);
+    EXPECT_EQ(pool.getChunkCount(), 1);
+}
+
+// Test that handles reach their order directly and go stale once it leaves the book
+TEST_F(LimitOrderTest, OrderHandlesGoStaleWhenOrdersLeave) {
+    OrderResult bid = orderBook->addOrderToBook(Side::Buy, 10, 4500, OrderType::Limit, orderIdSequence);
+    OrderResult ask = orderBook->addOrderToBook(Side::Sell, 10, 4600, OrderType::Limit, orderIdSequence);
+    ASSERT_EQ(orderBook->findOrder(bid.handle), orderBook->getAllOrders().find(bid.orderId)->second);
+
+    EXPECT_EQ(orderBook->modifyOrderSize(bid.handle, 25), OrderStatus::Resting);
+    EXPECT_EQ(orderBook->getBuySide().getLimit(4500)->getTotalVolume(), 25);
+    EXPECT_EQ(orderBook->modifyOrderSize(bid.handle, 0), OrderStatus::RejectedInvalidSize);
+    EXPECT_EQ(orderBook->cancelOrder(bid.handle), OrderStatus::Cancelled);
+    EXPECT_EQ(orderBook->cancelOrder(bid.handle), OrderStatus::RejectedUnknownOrder);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 0);
+
+    // the next order reuses the freed slot, but not under the old handle
+    OrderResult reuse = orderBook->addOrderToBook(Side::Buy, 5, 4400, OrderType::Limit, orderIdSequence);
+    EXPECT_EQ(reuse.handle.slot, bid.handle.slot);
+    EXPECT_EQ(orderBook->findOrder(bid.handle), nullptr);
+    EXPECT_EQ(orderBook->modifyOrderSize(bid.handle, 7), OrderStatus::RejectedUnknownOrder);
+
+    // repricing moves the order in place, under the same ID and handle
+    OrderResult moved = orderBook->modifyOrderLimitPrice(ask.handle, 4650);
+    EXPECT_EQ(moved.status, OrderStatus::Resting);
+    EXPECT_EQ(moved.orderId, ask.orderId);
+    EXPECT_EQ(moved.handle, ask.handle);
+    EXPECT_EQ(orderBook->findOrder(ask.handle)->getLimit(), 4650);
+    EXPECT_EQ(orderBook->modifyOrderLimitPrice(moved.handle, 0).status, OrderStatus::RejectedInvalidPrice);
+
+    // a fill makes the handle stale too, and a default handle never resolves
+    orderBook->placeMarketOrder(5, Side::Sell);
+    EXPECT_EQ(orderBook->cancelOrder(reuse.handle), OrderStatus::RejectedUnknownOrder);
+    EXPECT_EQ(orderBook->cancelOrder(OrderHandle{}), OrderStatus::RejectedUnknownOrder);
+    EXPECT_EQ(orderBook->cancelOrder(moved.handle), OrderStatus::Cancelled);
+}
+
+// Test that an in-place reprice joins the back of its new level, crosses when it has to and only
+// releases the order once it has filled
+TEST_F(LimitOrderTest, RepriceInPlaceMatchesAndRequeues) {
+    OrderResult a = orderBook->addOrderToBook(Side::Buy, 10, 4500, OrderType::Limit, orderIdSequence);
+    OrderResult b = orderBook->addOrderToBook(Side::Buy, 5, 4500, OrderType::Limit, orderIdSequence);
+    OrderResult d = orderBook->addOrderToBook(Side::Buy, 3, 4400, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 4, 4600, OrderType::Limit, orderIdSequence);
+    const int64_t nextId = orderIdSequence.peekNextId();
+
+    // crossing: trades 4 against the ask and rests the last share at 4600
+    OrderResult crossed = orderBook->modifyOrderLimitPrice(b.handle, 4600);
+    EXPECT_EQ(crossed.status, OrderStatus::PartiallyFilled);
+    EXPECT_EQ(crossed.filledShares, 4);
+    EXPECT_EQ(crossed.handle, b.handle);
+    EXPECT_EQ(orderBook->getBuySide().getBestPrice(), 4600);
+    EXPECT_EQ(orderBook->getBuySide().getLimit(4600)->getTotalVolume(), 1);
+    EXPECT_EQ(orderBook->getSellSide().getTotalVolume(), 0);
+
+    // the same price changes nothing; a new one queues behind the orders already there
+    EXPECT_EQ(orderBook->modifyOrderLimitPrice(a.handle, 4500).status, OrderStatus::Resting);
+    EXPECT_EQ(orderBook->modifyOrderLimitPrice(a.handle, 4400).status, OrderStatus::Resting);
+    EXPECT_EQ(orderBook->getBuySide().getLimit(4400)->getHead()->getOrderId(), d.orderId);
+    EXPECT_EQ(orderBook->getBuySide().getLimit(4400)->getTotalVolume(), 13);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 14);
+    EXPECT_EQ(orderIdSequence.peekNextId(), nextId);
+
+    // an ask repriced through the whole bid side fills and is released
+    OrderResult ask = orderBook->addOrderToBook(Side::Sell, 4, 4700, OrderType::Limit, orderIdSequence);
+    OrderResult filled = orderBook->modifyOrderLimitPrice(ask.handle, 4400);
+    EXPECT_EQ(filled.status, OrderStatus::Filled);
+    EXPECT_EQ(filled.filledShares, 4);
+    EXPECT_EQ(orderBook->findOrder(ask.handle), nullptr);
+    EXPECT_EQ(orderBook->getAllOrders().get(ask.orderId), nullptr);
+    EXPECT_EQ(orderBook->findOrder(b.handle), nullptr);
+    EXPECT_EQ(orderBook->findOrder(d.handle), nullptr);
+    EXPECT_EQ(orderBook->findOrder(a.handle)->getShares(), 10);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 10);
+}
+
+// Test that mass cancels remove whole participants, sides and price ranges in one call
+TEST_F(LimitOrderTest, MassCancelByParticipantSideAndRange) {
+    const TimeInForce gtc = TimeInForce::GoodTillCancel;
+    for (int i = 0; i < 10; ++i) {
+        const ParticipantId owner = i % 2 ? 1 : 2;
+        orderBook->addOrderToBook(Side::Buy, 10, 1000 + i, OrderType::Limit, orderIdSequence, gtc, owner);
+        orderBook->addOrderToBook(Side::Sell, 10, 2000 + i, OrderType::Limit, orderIdSequence, gtc, owner);
+    }
+    orderBook->addOrderToBook(Side::Buy, 10, 1009, OrderType::Limit, orderIdSequence);
+    orderBook->addStopOrder(Side::Buy, 5, 3000, NO_PRICE, orderIdSequence, 1);
+    EXPECT_EQ(orderBook->getParticipants().count(1), 11);
+
+    // participant 1 owns the odd levels of both sides, including both best levels, and the stop
+    EXPECT_EQ(orderBook->massCancel(ParticipantId{1}), 11);
+    EXPECT_EQ(orderBook->getParticipants().count(1), 0);
+    EXPECT_EQ(orderBook->getTriggerBook()->size(), 0);
+    EXPECT_EQ(orderBook->getBuySide().getBestPrice(), 1009);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 60);
+    EXPECT_EQ(orderBook->getSellSide().getBestPrice(), 2000);
+    EXPECT_EQ(orderBook->getSellSide().getTotalVolume(), 50);
+
+    EXPECT_EQ(orderBook->massCancel(Side::Sell, 2000, 2004), 3);
+    EXPECT_EQ(orderBook->massCancel(Side::Sell, 2009, 2005), 0);
+    EXPECT_EQ(orderBook->getSellSide().getBestPrice(), 2006);
+    EXPECT_EQ(orderBook->getSellSide().getTotalVolume(), 20);
+    EXPECT_EQ(orderBook->getParticipants().count(2), 7);
+
+    EXPECT_EQ(orderBook->massCancel(Side::Buy), 6);
+    EXPECT_EQ(orderBook->getBuySide().getBestPrice(), -1);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 0);
+    EXPECT_EQ(orderBook->getAllOrders().size(), 2);
+
+    // fills unlink orders too, and the emptied side takes new orders as usual
+    orderBook->placeMarketOrder(10, Side::Buy);
+    EXPECT_EQ(orderBook->getParticipants().count(2), 1);
+    orderBook->addOrderToBook(Side::Buy, 10, 1005, OrderType::Limit, orderIdSequence);
+    EXPECT_EQ(orderBook->getBuySide().getBestPrice(), 1005);
+    EXPECT_EQ(orderBook->getOrderPool().getLiveCount(), 2);
+}
+
+// Test that price level pages are only materialized while they hold orders
+TEST_F(LimitOrderTest, PriceLevelPagesFollowLiveLevels) {
+    EXPECT_EQ(orderBook->getBuySide().getLadder().getPageCount(), 0);
+    EXPECT_EQ(orderBook->getBuySide().getLimit(4700), nullptr);
+
+    orderBook->addOrderToBook(Side::Buy, 10, 4700, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 150000, OrderType::Limit, orderIdSequence);
+    EXPECT_EQ(orderBook->getBuySide().getLadder().getPageCount(), 2);
+
+    orderBook->cancelOrder(1);
+    EXPECT_EQ(orderBook->getBuySide().getLadder().getPageCount(), 1);
+    EXPECT_EQ(orderBook->getBuySide().getLadder().getSparePageCount(), 1);
+    EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getLimitPrice(), 4700);
+
+    orderBook->placeMarketOrder(10, Side::Sell);
+    EXPECT_EQ(orderBook->getBuySide().getLadder().getPageCount(), 0);
+    EXPECT_EQ(orderBook->getBuySide().getBestLimit(), nullptr);
+}
+
+// each inbound message publishes one update per level it changed, with the level's final state
+TEST_F(LimitOrderTest, DepthUpdatesCoalescePerMessage) {
+    std::vector<DepthUpdate> updates;
+    auto collect = [&]() {
+        updates.clear();
+        orderBook->getDepthUpdates().drain([&](std::span<const DepthUpdate> batch) {
+            updates.insert(updates.end(), batch.begin(), batch.end());
+        });
+    };
+
+    orderBook->addOrderToBook(Side::Sell, 5, 1000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 1000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 1001, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 4, 999, OrderType::Limit, orderIdSequence);
+    collect();
+    ASSERT_EQ(updates.size(), 4);
+    EXPECT_EQ(updates[1].sequence, 1);
+    EXPECT_EQ(updates[1].volume, 10);
+    EXPECT_EQ(updates[1].orderCount, 2);
+
+    // a buy sweeping both orders at 10.00 and three shares at 10.01
+    orderBook->addOrderToBook(Side::Buy, 13, 1001, OrderType::Limit, orderIdSequence);
+    collect();
+    ASSERT_EQ(updates.size(), 2);
+    EXPECT_EQ(updates[0].side, Side::Sell);
+    EXPECT_EQ(updates[0].price, 1000);
+    EXPECT_EQ(updates[0].volume, 0);
+    EXPECT_EQ(updates[0].orderCount, 0);
+    EXPECT_EQ(updates[1].price, 1001);
+    EXPECT_EQ(updates[1].volume, 2);
+    EXPECT_EQ(updates[1].sequence, updates[0].sequence);
+
+    orderBook->modifyOrderSize(3, 6);
+    orderBook->modifyOrderLimitPrice(3, 998);
+    collect();
+    ASSERT_EQ(updates.size(), 3);
+    EXPECT_EQ(updates[0].price, 999);
+    EXPECT_EQ(updates[0].volume, 6);
+    EXPECT_EQ(updates[1].price, 998);
+    EXPECT_EQ(updates[1].volume, 6);
+    EXPECT_EQ(updates[2].price, 999);
+    EXPECT_EQ(updates[2].volume, 0);
+    EXPECT_NE(updates[0].sequence, updates[1].sequence);
+    EXPECT_EQ(updates[1].sequence, updates[2].sequence);
+
+    EXPECT_THROW(orderBook->cancelOrder(12345), std::invalid_argument);
+    collect();
+    EXPECT_TRUE(updates.empty());
+
+    orderBook->addOrderToBook(Side::Buy, 1, 100, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 1, 500, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 2, 190000, OrderType::Limit, orderIdSequence);
+    DepthLevel bids[2];
+    ASSERT_EQ(orderBook->getBuySide().getDepth(bids), 2);
+    EXPECT_EQ(bids[0].price, 998);
+    EXPECT_EQ(bids[1].price, 500);
+    DepthLevel asks[4];
+    ASSERT_EQ(orderBook->getSellSide().getDepth(asks), 2);
+    EXPECT_EQ(asks[0].price, 1001);
+    EXPECT_EQ(asks[0].volume, 2);
+    EXPECT_EQ(asks[0].orderCount, 1);
+    EXPECT_EQ(asks[1].price, 190000);
+}
+
+// a sweep touching more levels than the pending buffer holds still publishes every level under one sequence
+TEST_F(LimitOrderTest, DepthUpdatesSweepBeyondPendingCapacity) {
+    const int levels = static_cast<int>(DepthUpdateBuffer::PENDING_CAPACITY) + 36;
+    for (int i = 0; i < levels; ++i) {
+        orderBook->addOrderToBook(Side::Sell, 1, 1000 + i, OrderType::Limit, orderIdSequence);
+    }
+    orderBook->getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+
+    orderBook->addOrderToBook(Side::Buy, levels, 1000 + levels, OrderType::Limit, orderIdSequence);
+    std::map<int32_t, DepthUpdate> last;
+    std::set<uint64_t> sequences;
+    orderBook->getDepthUpdates().drain([&](std::span<const DepthUpdate> batch) {
+        for (const DepthUpdate& update : batch) {
+            last[update.price] = update;
+            sequences.insert(update.sequence);
+        }
+    });
+
+    ASSERT_EQ(last.size(), static_cast<size_t>(levels));
+    for (const auto& [price, update] : last) {
+        EXPECT_EQ(update.side, Side::Sell);
+        EXPECT_EQ(update.volume, 0);
+    }
+    EXPECT_EQ(sequences.size(), 1);
+    EXPECT_EQ(orderBook->getDepthUpdates().getDroppedCount(), 0);
+    TopOfBook top;
+    ASSERT_TRUE(orderBook->getTopOfBook().tryRead(top));
+    EXPECT_EQ(top.askPrice, NO_PRICE);
+}
+
+// a full depth ring never grows: it spills to the overflow handler, or else drops the oldest update
+TEST_F(LimitOrderTest, DepthUpdatesOverflowPolicy) {
+    DepthUpdateBuffer buffer(4);
+    auto publishLevels = [&](int32_t firstPrice) {
+        DepthUpdateBuffer::Message message(buffer);
+        for (int32_t i = 0; i < 6; ++i)
+            buffer.record(Side::Buy, firstPrice + i, 1, 1);
+    };
+
+    std::vector<int32_t> prices;
+    auto collect = [&](std::span<const DepthUpdate> batch) {
+        for (const DepthUpdate& update : batch)
+            prices.push_back(update.price);
+    };
+    publishLevels(100);
+    buffer.drain(collect);
+    EXPECT_EQ(prices, (std::vector<int32_t>{102, 103, 104, 105}));
+    EXPECT_EQ(buffer.getDroppedCount(), 2);
+
+    prices.clear();
+    buffer.setOverflowHandler(collect);
+    publishLevels(200);
+    buffer.drain(collect);
+    EXPECT_EQ(prices, (std::vector<int32_t>{200, 201, 202, 203, 204, 205}));
+    EXPECT_EQ(buffer.getDroppedCount(), 2);
+    EXPECT_EQ(buffer.capacity(), 4);
+}
+
+// a batch produces the same fills, resting orders and IDs as submitting the orders one by one
+TEST_F(LimitOrderTest, SubmitBatchMatchesSequentialEntry) {
+    std::vector<OrderRequest> requests;
+    for (int i = 0; i < 500; ++i) {
+        const Side side = (i * 7) % 3 == 0 ? Side::Sell : Side::Buy;
+        if (i % 50 == 49) {
+            requests.push_back({side, OrderType::Market, 1 + i % 40, -1});
+        } else {
+            requests.push_back({side, OrderType::Limit, 1 + i % 13, (100 + (i * 31) % 17) * 10});
+        }
+    }
+    requests.push_back({Side::Buy, OrderType::Limit, 0, 1000});
+    requests.push_back({Side::Buy, OrderType::Limit, 5, -300});
+    requests.push_back({Side::Buy, OrderType::Market, 1000000, -1});
+    requests.push_back({Side::Sell, OrderType::Limit, 5, 1050});
+
+    Book sequential;
+    OrderIdSequence sequentialIds;
+    std::vector<OrderResult> expected;
+    for (const OrderRequest& request : requests) {
+        try {
+            expected.push_back(sequential.addOrderToBook(request.side, request.shares, request.limit, request.type, sequentialIds));
+        } catch (const std::invalid_argument&) {
+            expected.push_back({-1, 0, OrderStatus::RejectedInvalidSize});
+        } catch (const std::runtime_error&) {
+            expected.push_back({sequentialIds.peekNextId() - 1, 0, OrderStatus::RejectedNoLiquidity});
+        }
+    }
+
+    std::vector<OrderResult> results(requests.size());
+    EXPECT_EQ(orderBook->submitBatch(requests, results, orderIdSequence), requests.size());
+
+    for (size_t i = 0; i < requests.size() - 4; ++i) {
+        EXPECT_EQ(results[i].orderId, expected[i].orderId);
+        EXPECT_EQ(results[i].filledShares, expected[i].filledShares);
+        EXPECT_EQ(results[i].status, expected[i].status);
+    }
+    const size_t tail = requests.size() - 4;
+    EXPECT_EQ(results[tail].status, OrderStatus::RejectedInvalidSize);
+    EXPECT_EQ(results[tail].orderId, -1);
+    EXPECT_EQ(results[tail + 1].status, OrderStatus::RejectedInvalidPrice);
+    EXPECT_EQ(results[tail + 2].status, OrderStatus::RejectedNoLiquidity);
+    EXPECT_EQ(results[tail + 3].orderId, expected[tail + 3].orderId);
+
+    ExecutionReport a[4096];
+    ExecutionReport b[4096];
+    const size_t fills = sequential.getExecutions().drain(std::span<ExecutionReport>(a));
+    ASSERT_EQ(orderBook->getExecutions().drain(std::span<ExecutionReport>(b)), fills);
+    EXPECT_GT(fills, 0);
+    for (size_t i = 0; i < fills; ++i) {
+        EXPECT_EQ(b[i].aggressorId, a[i].aggressorId);
+        EXPECT_EQ(b[i].restingId, a[i].restingId);
+        EXPECT_EQ(b[i].quantity, a[i].quantity);
+    }
+    ASSERT_EQ(orderBook->getAllOrders().size(), sequential.getAllOrders().size());
+    for (const auto& [orderId, order] : sequential.getAllOrders()) {
+        const Order* copy = orderBook->getAllOrders().get(orderId);
+        ASSERT_NE(copy, nullptr);
+        EXPECT_EQ(copy->getShares(), order->getShares());
+    }
+    EXPECT_EQ(orderIdSequence.peekNextId(), sequentialIds.peekNextId());
+}
+
+// Test that orders and executions carry the message time and fills and resizes move the event time
+TEST_F(LimitOrderTest, TimestampsFollowTheBookClock) {
+    Clock clock(ClockSource::Virtual);
+    orderBook->setClock(clock);
+
+    clock.setTime(1000);
+    orderBook->addOrderToBook(Side::Sell, 10, 5000, OrderType::Limit, orderIdSequence);
+    const Order* resting = orderBook->getAllOrders().get(0);
+    ASSERT_NE(resting, nullptr);
+    EXPECT_EQ(resting->getEntryTime(), 1000);
+    EXPECT_EQ(resting->getEventTime(), 1000);
+
+    clock.setTime(2500);
+    orderBook->addOrderToBook(Side::Buy, 4, 5000, OrderType::Limit, orderIdSequence);
+    EXPECT_EQ(resting->getEntryTime(), 1000);
+    EXPECT_EQ(resting->getEventTime(), 2500);
+    std::vector<Timestamp> executionTimes;
+    orderBook->getExecutions().drain([&](std::span<const ExecutionReport> batch) {
+        for (const ExecutionReport& report : batch) executionTimes.push_back(report.timestamp);
+    });
+    EXPECT_EQ(executionTimes, std::vector<Timestamp>{2500});
+
+    clock.setTime(4000);
+    orderBook->modifyOrderSize(0, 3);
+    EXPECT_EQ(resting->getEventTime(), 4000);
+    EXPECT_THROW(Clock().setTime(1), std::runtime_error);
+}
+
+// Pro-rata levels split the incoming quantity by resting size, with the odd lots placed by the rounding rule
+TEST_F(LimitOrderTest, ProRataAllocationFollowsRounding) {
+    auto allocate = [](MatchingPolicy policy, std::initializer_list<int> resting, int incoming) {
+        Book book(policy);
+        OrderIdSequence ids;
+        for (int shares : resting) {
+            book.addOrderToBook(Side::Sell, shares, 5000, OrderType::Limit, ids);
+        }
+        book.addOrderToBook(Side::Buy, incoming, 5000, OrderType::Limit, ids);
+        std::vector<int> filled(resting.size(), 0);
+        book.getExecutions().drain([&](std::span<const ExecutionReport> batch) {
+            for (const ExecutionReport& report : batch) filled[report.restingId] += report.quantity;
+        });
+        return filled;
+    };
+
+    using V = std::vector<int>;
+    EXPECT_EQ(allocate({MatchingAlgorithm::Fifo}, {1, 2, 4}, 3), (V{1, 2, 0}));
+    EXPECT_EQ(allocate({MatchingAlgorithm::ProRata, ProRataRounding::Down}, {1, 2, 4}, 3), (V{0, 1, 2}));
+    EXPECT_EQ(allocate({MatchingAlgorithm::ProRata, ProRataRounding::Up}, {1, 2, 4}, 3), (V{1, 1, 1}));
+    EXPECT_EQ(allocate({MatchingAlgorithm::ProRata, ProRataRounding::Nearest}, {1, 2, 4}, 3), (V{0, 1, 2}));
+    EXPECT_EQ(allocate({MatchingAlgorithm::ProRata}, {10, 30, 60}, 50), (V{5, 15, 30}));
+    EXPECT_EQ(allocate({MatchingAlgorithm::ProRata}, {10, 30, 60}, 100), (V{10, 30, 60}));
+    // the head takes its share first, then the rest is pro-rata over what is left
+    EXPECT_EQ(allocate({MatchingAlgorithm::TopOrderProRata, ProRataRounding::Down, 100}, {5, 10, 10}, 12), (V{5, 3, 4}));
+    EXPECT_EQ(allocate({MatchingAlgorithm::TopOrderProRata, ProRataRounding::Down, 40}, {20, 10, 10}, 20), (V{12, 4, 4}));
+    EXPECT_THROW(Book(MatchingPolicy{MatchingAlgorithm::TopOrderProRata, ProRataRounding::Down, 101}), std::invalid_argument);
+}
+
+// A pro-rata sweep through several levels fills the better levels in full and keeps the book consistent
+TEST_F(LimitOrderTest, ProRataSweepKeepsBookConsistent) {
+    Book book(MatchingPolicy{MatchingAlgorithm::ProRata});
+    OrderIdSequence ids;
+    for (int i = 0; i < 30; ++i) {
+        book.addOrderToBook(Side::Buy, 1 + i % 7, 4000 + (i % 3) * 10, OrderType::Limit, ids);
+    }
+    const int before = book.getBuySide().getTotalVolume();
+    const int topLevel = book.getBuySide().getLimit(4020)->getTotalVolume();
+    book.placeMarketOrder(topLevel + 5, Side::Sell);
+
+    EXPECT_EQ(book.getBuySide().getTotalVolume(), before - topLevel - 5);
+    EXPECT_EQ(book.getBuySide().getBestPrice(), 4010);
+    int resting = 0;
+    for (const auto& [orderId, order] : book.getAllOrders()) {
+        EXPECT_GT(order->getShares(), 0);
+        resting += order->getShares();
+    }
+    EXPECT_EQ(resting, book.getBuySide().getTotalVolume());
+}
+
+// Self-trade prevention acts on the queue the incoming order reaches, per mode
+TEST_F(LimitOrderTest, SelfTradePreventionModes) {
+    struct Outcome {
+        OrderStatus status;
+        int filled;
+        std::vector<int> resting; // shares left of the three asks, 0 once gone
+        int askVolume;
+        int bidVolume;
+    };
+    auto run = [](MatchingPolicy policy, int incoming) {
+        Book book(policy);
+        OrderIdSequence ids;
+        const OrderHandle asks[] = {
+            book.addOrderToBook(Side::Sell, 4, 5000, OrderType::Limit, ids, TimeInForce::GoodTillCancel, 1).handle,
+            book.addOrderToBook(Side::Sell, 5, 5000, OrderType::Limit, ids, TimeInForce::GoodTillCancel, 2).handle,
+            book.addOrderToBook(Side::Sell, 6, 5000, OrderType::Limit, ids, TimeInForce::GoodTillCancel, 1).handle};
+        const OrderResult result = book.addOrderToBook(Side::Buy, incoming, 5000, OrderType::Limit, ids,
+                                                       TimeInForce::GoodTillCancel, 2);
+        Outcome outcome{result.status, result.filledShares, {}, book.getSellSide().getTotalVolume(),
+                        book.getBuySide().getTotalVolume()};
+        for (OrderHandle handle : asks) {
+            const Order* order = book.findOrder(handle);
+            outcome.resting.push_back(order ? order->getShares() : 0);
+        }
+        return outcome;
+    };
+    auto fifo = [](SelfTradePrevention mode) {
+        return MatchingPolicy{MatchingAlgorithm::Fifo, ProRataRounding::Down, 100, mode};
+    };
+    using V = std::vector<int>;
+
+    Outcome none = run(fifo(SelfTradePrevention::None), 8);
+    EXPECT_EQ(none.status, OrderStatus::Filled);
+    EXPECT_EQ(none.resting, (V{0, 1, 6}));
+
+    Outcome cancelResting = run(fifo(SelfTradePrevention::CancelResting), 8);
+    EXPECT_EQ(cancelResting.status, OrderStatus::Filled);
+    EXPECT_EQ(cancelResting.resting, (V{0, 0, 2}));
+    EXPECT_EQ(cancelResting.askVolume, 2);
+
+    // the incoming order still trades with the order ahead of its own
+    Outcome cancelAggressor = run(fifo(SelfTradePrevention::CancelAggressor), 8);
+    EXPECT_EQ(cancelAggressor.status, OrderStatus::CancelledSelfTrade);
+    EXPECT_EQ(cancelAggressor.filled, 4);
+    EXPECT_EQ(cancelAggressor.resting, (V{0, 5, 6}));
+
+    Outcome cancelBoth = run(fifo(SelfTradePrevention::CancelBoth), 8);
+    EXPECT_EQ(cancelBoth.status, OrderStatus::CancelledSelfTrade);
+    EXPECT_EQ(cancelBoth.filled, 4);
+    EXPECT_EQ(cancelBoth.resting, (V{0, 0, 6}));
+    EXPECT_EQ(cancelBoth.askVolume, 6);
+    EXPECT_EQ(cancelBoth.bidVolume, 0);
+
+    Outcome decrementSmall = run(fifo(SelfTradePrevention::DecrementAndCancel), 8);
+    EXPECT_EQ(decrementSmall.status, OrderStatus::CancelledSelfTrade);
+    EXPECT_EQ(decrementSmall.filled, 4);
+    EXPECT_EQ(decrementSmall.resting, (V{0, 1, 6}));
+    EXPECT_EQ(decrementSmall.askVolume, 7);
+
+    Outcome decrementLarge = run(fifo(SelfTradePrevention::DecrementAndCancel), 20);
+    EXPECT_EQ(decrementLarge.status, OrderStatus::PartiallyFilled);
+    EXPECT_EQ(decrementLarge.filled, 10);
+    EXPECT_EQ(decrementLarge.resting, (V{0, 0, 0}));
+    EXPECT_EQ(decrementLarge.bidVolume, 5); // 10 traded, 5 decremented against its own ask
+
+    // under pro-rata the owner's order is taken out before the level is shared
+    Outcome proRata = run(MatchingPolicy{MatchingAlgorithm::ProRata, ProRataRounding::Down, 100,
+                                         SelfTradePrevention::CancelResting}, 5);
+    EXPECT_EQ(proRata.status, OrderStatus::Filled);
+    EXPECT_EQ(proRata.resting, (V{2, 0, 3}));
+
+    EXPECT_THROW(Book(MatchingPolicy{MatchingAlgorithm::Fifo, ProRataRounding::Down, 100, static_cast<SelfTradePrevention>(9)}),
+                 std::invalid_argument);
+}
+
+// An IOC remainder expires without an order ever being drawn from the pool
+TEST_F(LimitOrderTest, ImmediateOrCancelNeverRests) {
+    orderBook->addOrderToBook(Side::Sell, 5, 1000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 1010, OrderType::Limit, orderIdSequence);
+
+    OrderResult result = orderBook->addOrderToBook(Side::Buy, 8, 1005, OrderType::Limit, orderIdSequence,
+                                                   TimeInForce::ImmediateOrCancel);
+    EXPECT_EQ(result.status, OrderStatus::Expired);
+    EXPECT_EQ(result.filledShares, 5);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 0);
+    EXPECT_EQ(orderBook->getAllOrders().size(), 1);
+    EXPECT_EQ(orderBook->getOrderPool().getHighWaterMark(), 2);
+
+    result = orderBook->addOrderToBook(Side::Buy, 3, 1010, OrderType::Limit, orderIdSequence,
+                                       TimeInForce::ImmediateOrCancel);
+    EXPECT_EQ(result.status, OrderStatus::Filled);
+    result = orderBook->addOrderToBook(Side::Buy, 10, 0, OrderType::Market, orderIdSequence,
+                                       TimeInForce::ImmediateOrCancel);
+    EXPECT_EQ(result.status, OrderStatus::Expired);
+    EXPECT_EQ(result.filledShares, 2);
+    EXPECT_EQ(orderBook->getOrderPool().getLiveCount(), 0);
+}
+
+// A FOK order that cannot fill in full leaves the book exactly as it was
+TEST_F(LimitOrderTest, FillOrKillIsAllOrNothing) {
+    orderBook->addOrderToBook(Side::Buy, 4, 1000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 4, 990, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 4, 980, OrderType::Limit, orderIdSequence);
+
+    OrderResult result = orderBook->addOrderToBook(Side::Sell, 9, 990, OrderType::Limit, orderIdSequence,
+                                                   TimeInForce::FillOrKill);
+    EXPECT_EQ(result.status, OrderStatus::Expired);
+    EXPECT_EQ(result.filledShares, 0);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 12);
+    EXPECT_EQ(orderBook->getExecutions().size(), 0);
+
+    result = orderBook->addOrderToBook(Side::Sell, 9, 980, OrderType::Limit, orderIdSequence, TimeInForce::FillOrKill);
+    EXPECT_EQ(result.status, OrderStatus::Filled);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 3);
+    EXPECT_EQ(orderBook->getSellSide().getTotalVolume(), 0);
+}
+
+// Post-only orders are rejected, or moved one tick behind the opposite best price, instead of trading
+TEST_F(LimitOrderTest, PostOnlyNeverTakes) {
+    orderBook->addOrderToBook(Side::Sell, 5, 1000, OrderType::Limit, orderIdSequence);
+
+    OrderResult result = orderBook->addOrderToBook(Side::Buy, 5, 1000, OrderType::Limit, orderIdSequence,
+                                                   TimeInForce::PostOnly);
+    EXPECT_EQ(result.status, OrderStatus::RejectedWouldCross);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 0);
+
+    result = orderBook->addOrderToBook(Side::Buy, 5, 999, OrderType::Limit, orderIdSequence, TimeInForce::PostOnly);
+    EXPECT_EQ(result.status, OrderStatus::Resting);
+
+    result = orderBook->addOrderToBook(Side::Buy, 5, 1020, OrderType::Limit, orderIdSequence,
+                                       TimeInForce::PostOnlyReprice);
+    EXPECT_EQ(result.status, OrderStatus::Resting);
+    EXPECT_EQ(orderBook->getAllOrders().get(result.orderId)->getLimit(), 999);
+    EXPECT_EQ(orderBook->getSellSide().getTotalVolume(), 5);
+
+    EXPECT_THROW(orderBook->addOrderToBook(Side::Buy, 5, 0, OrderType::Market, orderIdSequence, TimeInForce::PostOnly),
+                 std::invalid_argument);
+}
+
+// A limit order sweeping many levels across bitmap words stops at its limit and leaves the next level as best
+TEST_F(LimitOrderTest, SweepThroughManyLevels) {
+    for (int i = 0; i < 200; ++i) {
+        orderBook->addOrderToBook(Side::Sell, 1 + i % 3, 1000 + i * 3, OrderType::Limit, orderIdSequence);
+        orderBook->addOrderToBook(Side::Sell, 2, 1000 + i * 3, OrderType::Limit, orderIdSequence);
+    }
+    const int before = orderBook->getSellSide().getTotalVolume();
+    int throughLimit = 0;
+    for (int i = 0; 1000 + i * 3 <= 1400; ++i) {
+        throughLimit += 3 + i % 3;
+    }
+
+    OrderResult result = orderBook->addOrderToBook(Side::Buy, throughLimit + 50, 1400, OrderType::Limit, orderIdSequence);
+    EXPECT_EQ(result.filledShares, throughLimit);
+    EXPECT_EQ(result.status, OrderStatus::PartiallyFilled);
+    EXPECT_EQ(orderBook->getSellSide().getBestPrice(), 1402);
+    EXPECT_EQ(orderBook->getSellSide().getTotalVolume(), before - throughLimit);
+    EXPECT_EQ(orderBook->getBuySide().getBestPrice(), 1400);
+
+    // a partial fill of the last level leaves its remaining orders queued
+    result = orderBook->addOrderToBook(Side::Buy, 4, 1405, OrderType::Limit, orderIdSequence);
+    EXPECT_EQ(result.status, OrderStatus::Filled);
+    EXPECT_EQ(orderBook->getSellSide().getBestPrice(), 1402);
+    EXPECT_EQ(orderBook->getSellSide().getLimit(1402)->getTotalVolume(), 1);
+    EXPECT_EQ(orderBook->getSellSide().getLimit(1402)->getSize(), 1);
+
+    orderBook->placeMarketOrder(orderBook->getSellSide().getTotalVolume(), Side::Buy);
+    EXPECT_EQ(orderBook->getSellSide().getBestLimit(), nullptr);
+    EXPECT_EQ(orderBook->getSellSide().getLadder().getPageCount(), 0);
+    EXPECT_EQ(orderBook->getAllOrders().size(), 1);
+}
+
+// Stops triggered by a stop's own trades cascade in trigger order without recursion
+TEST_F(LimitOrderTest, StopOrdersCascadeInTriggerOrder) {
+    for (int price = 1000; price <= 1003; ++price) {
+        orderBook->addOrderToBook(Side::Sell, 5, price, OrderType::Limit, orderIdSequence);
+    }
+    orderBook->addOrderToBook(Side::Buy, 5, 1000, OrderType::Limit, orderIdSequence);
+    EXPECT_EQ(orderBook->getLastTradePrice(), 1000);
+
+    const int64_t c = orderBook->addStopOrder(Side::Buy, 10, 1003, 1003, orderIdSequence).orderId;
+    const int64_t b = orderBook->addStopOrder(Side::Buy, 5, 1002, NO_PRICE, orderIdSequence).orderId;
+    const OrderResult a = orderBook->addStopOrder(Side::Buy, 5, 1001, NO_PRICE, orderIdSequence);
+    EXPECT_EQ(a.status, OrderStatus::StopPending);
+    EXPECT_EQ(orderBook->getTriggerBook()->size(), 3);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 0);
+    orderBook->getExecutions().drain([](std::span<const ExecutionReport>) {});
+
+    orderBook->addOrderToBook(Side::Buy, 1, 1001, OrderType::Limit, orderIdSequence);
+    std::vector<int64_t> aggressors;
+    orderBook->getExecutions().drain([&](std::span<const ExecutionReport> batch) {
+        for (const ExecutionReport& report : batch) aggressors.push_back(report.aggressorId);
+    });
+    const int64_t first = a.orderId + 1;
+    EXPECT_EQ(aggressors, (std::vector<int64_t>{first, a.orderId, a.orderId, b, b, c}));
+    EXPECT_EQ(orderBook->getTriggerBook()->size(), 0);
+    EXPECT_EQ(orderBook->getSellSide().getTotalVolume(), 0);
+    EXPECT_EQ(orderBook->getLastTradePrice(), 1003);
+    ASSERT_NE(orderBook->getAllOrders().get(c), nullptr);
+    EXPECT_EQ(orderBook->getAllOrders().get(c)->getShares(), 6);
+    EXPECT_EQ(orderBook->getBuySide().getBestPrice(), 1003);
+}
+
+// Parked stops can be resized and canceled; a stop the last trade already reached enters at once
+TEST_F(LimitOrderTest, StopOrderLifecycle) {
+    orderBook->addOrderToBook(Side::Buy, 10, 900, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 2, 900, OrderType::Limit, orderIdSequence);
+
+    const int64_t stop = orderBook->addStopOrder(Side::Sell, 4, 850, 840, orderIdSequence).orderId;
+    orderBook->modifyOrderSize(stop, 3);
+    EXPECT_EQ(orderBook->getAllOrders().get(stop)->getShares(), 3);
+    EXPECT_THROW(orderBook->modifyOrderLimitPrice(stop, 830), std::invalid_argument);
+    orderBook->cancelOrder(stop);
+    EXPECT_EQ(orderBook->getTriggerBook()->size(), 0);
+    EXPECT_EQ(orderBook->getAllOrders().get(stop), nullptr);
+
+    OrderResult result = orderBook->addStopOrder(Side::Sell, 3, 950, NO_PRICE, orderIdSequence);
+    EXPECT_EQ(result.status, OrderStatus::Filled);
+    EXPECT_EQ(orderBook->getBuySide().getTotalVolume(), 5);
+
+    EXPECT_THROW(orderBook->addStopOrder(Side::Sell, 3, 0, NO_PRICE, orderIdSequence), std::invalid_argument);
+    EXPECT_THROW(orderBook->addOrderToBook(Side::Sell, 3, 900, OrderType::Stop, orderIdSequence), std::invalid_argument);
+    EXPECT_EQ(orderBook->getOrderPool().getLiveCount(), 1);
 }
@@ -17,8 +17,8 @@ protected:
 // test for single market sell order
 TEST_F(MarketOrderTest, SingleMarketOrderSell) {
 
-    orderBook->addOrderToBook(Side::Sell, 3, 30, OrderType::Limit, orderIdSequence); // Initial best sell
-    orderBook->addOrderToBook(Side::Sell, 2, 29.14, OrderType::Limit, orderIdSequence); // Better sell
+    orderBook->addOrderToBook(Side::Sell, 3, 3000, OrderType::Limit, orderIdSequence); // Initial best sell
+    orderBook->addOrderToBook(Side::Sell, 2, 2914, OrderType::Limit, orderIdSequence); // Better sell
 
     int bestPriceSell = orderBook->getSellSide().getBestPrice();
     EXPECT_EQ(orderBook->getSellSide().getLimit(bestPriceSell)->getTotalVolume(), 2);
@@ -30,8 +30,8 @@ TEST_F(MarketOrderTest, SingleMarketOrderSell) {
 // test for single market buy order
 TEST_F(MarketOrderTest, SingleMarketOrderBuy) {
 
-    orderBook->addOrderToBook(Side::Buy, 3, 50.14, OrderType::Limit, orderIdSequence); // Initial best buy
-    orderBook->addOrderToBook(Side::Buy, 10, 55, OrderType::Limit, orderIdSequence); // Better buy
+    orderBook->addOrderToBook(Side::Buy, 3, 5014, OrderType::Limit, orderIdSequence); // Initial best buy
+    orderBook->addOrderToBook(Side::Buy, 10, 5500, OrderType::Limit, orderIdSequence); // Better buy
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getTotalVolume(), 10);
     orderBook->placeMarketOrder(5, Side::Sell);
@@ -41,10 +41,10 @@ TEST_F(MarketOrderTest, SingleMarketOrderBuy) {
 // test for market orders that cancel first level
 TEST_F(MarketOrderTest, MarketOrdersThatCancelFirstLevel) {
 
-    orderBook->addOrderToBook(Side::Buy, 3, 30, OrderType::Limit, orderIdSequence); // Initial best buy
-    orderBook->addOrderToBook(Side::Buy, 10, 35, OrderType::Limit, orderIdSequence); // Better buy
-    orderBook->addOrderToBook(Side::Sell, 7, 55, OrderType::Limit, orderIdSequence); // Initial best sell
-    orderBook->addOrderToBook(Side::Sell, 14, 50, OrderType::Limit, orderIdSequence); // Better sell
+    orderBook->addOrderToBook(Side::Buy, 3, 3000, OrderType::Limit, orderIdSequence); // Initial best buy
+    orderBook->addOrderToBook(Side::Buy, 10, 3500, OrderType::Limit, orderIdSequence); // Better buy
+    orderBook->addOrderToBook(Side::Sell, 7, 5500, OrderType::Limit, orderIdSequence); // Initial best sell
+    orderBook->addOrderToBook(Side::Sell, 14, 5000, OrderType::Limit, orderIdSequence); // Better sell
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getTotalVolume(), 10);
     EXPECT_EQ(orderBook->getSellSide().getBestLimit()->getTotalVolume(), 14);
@@ -59,9 +59,9 @@ TEST_F(MarketOrderTest, MarketOrdersThatCancelFirstLevel) {
 // test for market orders that cancel multiple orders at first level
 TEST_F(MarketOrderTest, MarketOrdersThatCancelMultipleOrderFirstLevel) {
 
-    orderBook->addOrderToBook(Side::Buy, 3, 30, OrderType::Limit, orderIdSequence); // initial best buy
-    orderBook->addOrderToBook(Side::Buy, 10, 35, OrderType::Limit, orderIdSequence); // better buy
-    orderBook->addOrderToBook(Side::Buy, 15, 35, OrderType::Limit, orderIdSequence); // same level as best buy
+    orderBook->addOrderToBook(Side::Buy, 3, 3000, OrderType::Limit, orderIdSequence); // initial best buy
+    orderBook->addOrderToBook(Side::Buy, 10, 3500, OrderType::Limit, orderIdSequence); // better buy
+    orderBook->addOrderToBook(Side::Buy, 15, 3500, OrderType::Limit, orderIdSequence); // same level as best buy
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getTotalVolume(), 25);
 
@@ -72,14 +72,14 @@ TEST_F(MarketOrderTest, MarketOrdersThatCancelMultipleOrderFirstLevel) {
 // test for market order that empties the order book
 TEST_F(MarketOrderTest, MarketOrderThatEmptiesOrderBook) {
     
-    orderBook->addOrderToBook(Side::Buy, 3, 30, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 3, 3000, OrderType::Limit, orderIdSequence);
 
     orderBook->placeMarketOrder(3, Side::Sell);
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit(), nullptr);
     EXPECT_EQ(orderBook->getSellSide().getBestLimit(), nullptr);
 
-    orderBook->addOrderToBook(Side::Buy, 10, 10, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Buy, 10, 1000, OrderType::Limit, orderIdSequence);
 
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getTotalVolume(), 10);
     EXPECT_EQ(orderBook->getBuySide().getBestLimit()->getLimitPrice(), 1000);
@@ -96,9 +96,100 @@ TEST_F(MarketOrderTest, MarketOrderWithNoBook) {
 
 // test for market order size greater than book
 TEST_F(MarketOrderTest, MarketOrderSizeGreaterThenBook) {
-    orderBook->addOrderToBook(Side::Sell, 3.15, 1, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 3.15, 100, OrderType::Limit, orderIdSequence);
     
     EXPECT_THROW({
         orderBook->placeMarketOrder(15, Side::Buy); // Market Order with size greater than order book
     }, std::runtime_error);
 }
+
+// test that fully filled resting orders leave the book's order map
+TEST_F(MarketOrderTest, FilledOrdersAreReleased) {
+    orderBook->addOrderToBook(Side::Sell, 3, 3000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 4, 3100, OrderType::Limit, orderIdSequence);
+
+    orderBook->placeMarketOrder(5, Side::Buy);
+
+    EXPECT_EQ(orderBook->getAllOrders().size(), 1);
+    EXPECT_EQ(orderBook->getAllOrders().find(0), orderBook->getAllOrders().end());
+    EXPECT_EQ(orderBook->getOrderPool().getLiveCount(), 1);
+    EXPECT_THROW(orderBook->cancelOrder(0), std::invalid_argument);
+}
+
+// test that a market sweep reports every fill in match order
+TEST_F(MarketOrderTest, MarketOrderExecutionReports) {
+    orderBook->addOrderToBook(Side::Sell, 3, 3000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 4, 3000, OrderType::Limit, orderIdSequence);
+    orderBook->addOrderToBook(Side::Sell, 5, 3100, OrderType::Limit, orderIdSequence);
+
+    orderBook->addOrderToBook(Side::Buy, 9, -1, OrderType::Market, orderIdSequence);
+
+    ExecutionReport reports[8];
+    size_t count = orderBook->getExecutions().drain(std::span<ExecutionReport>(reports));
+    ASSERT_EQ(count, 3);
+
+    const int64_t restingIds[] = {0, 1, 2};
+    const int32_t prices[] = {3000, 3000, 3100};
+    const int32_t quantities[] = {3, 4, 2};
+    const int32_t restingLeaves[] = {0, 0, 3};
+    const int32_t aggressorLeaves[] = {6, 2, 0};
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(reports[i].sequence, i);
+        EXPECT_EQ(reports[i].aggressorId, 3);
+        EXPECT_EQ(reports[i].aggressorSide, Side::Buy);
+        EXPECT_EQ(reports[i].restingId, restingIds[i]);
+        EXPECT_EQ(reports[i].price, prices[i]);
+        EXPECT_EQ(reports[i].quantity, quantities[i]);
+        EXPECT_EQ(reports[i].restingLeaves, restingLeaves[i]);
+        EXPECT_EQ(reports[i].aggressorLeaves, aggressorLeaves[i]);
+    }
+    EXPECT_TRUE(orderBook->getExecutions().empty());
+}
+
+// test that the execution ring keeps every report when drained in wrapped batches
+TEST_F(MarketOrderTest, ExecutionReportsDrainAcrossWrap) {
+    ExecutionReportBuffer buffer(4);
+    for (int i = 0; i < 3; ++i)
+        buffer.record({0, 0, 100, i, 1000, 1, 0, 0, Side::Buy});
+    buffer.drain([](std::span<const ExecutionReport>) {});
+
+    for (int i = 0; i < 4; ++i)
+        buffer.record({0, 0, 100, 10 + i, 1000, 1, 0, 0, Side::Buy});
+
+    std::vector<int64_t> drained;
+    buffer.drain([&](std::span<const ExecutionReport> batch) {
+        for (const auto& report : batch)
+            drained.push_back(report.restingId);
+    });
+
+    EXPECT_EQ(drained, (std::vector<int64_t>{10, 11, 12, 13}));
+    EXPECT_EQ(buffer.getNextSequence(), 7);
+    EXPECT_EQ(buffer.getDroppedCount(), 0);
+}
+
+// test that a full ring never grows: it spills to the overflow handler, or else drops the oldest report
+TEST_F(MarketOrderTest, ExecutionReportsOverflowPolicy) {
+    ExecutionReportBuffer buffer(4);
+    for (int i = 0; i < 6; ++i)
+        buffer.record({0, 0, 100, i, 1000, 1, 0, 0, Side::Buy});
+
+    std::vector<int64_t> drained;
+    auto collect = [&](std::span<const ExecutionReport> batch) {
+        for (const auto& report : batch)
+            drained.push_back(report.restingId);
+    };
+    buffer.drain(collect);
+    EXPECT_EQ(buffer.capacity(), 4);
+    EXPECT_EQ(buffer.getDroppedCount(), 2);
+    EXPECT_EQ(drained, (std::vector<int64_t>{2, 3, 4, 5}));
+
+    drained.clear();
+    buffer.setOverflowHandler(collect);
+    for (int i = 0; i < 6; ++i)
+        buffer.record({0, 0, 100, 10 + i, 1000, 1, 0, 0, Side::Buy});
+    EXPECT_EQ(drained, (std::vector<int64_t>{10, 11, 12, 13}));
+    buffer.drain(collect);
+    EXPECT_EQ(drained, (std::vector<int64_t>{10, 11, 12, 13, 14, 15}));
+    EXPECT_EQ(buffer.getDroppedCount(), 2);
+    EXPECT_EQ(buffer.capacity(), 4);
+}
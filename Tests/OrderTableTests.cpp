@@ -0,0 +1,85 @@
+#include "../src/Book.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+class OrderTableTest : public ::testing::Test {
+protected:
+    OrderTable table;
+    // the table only stores pointers, any distinct addresses will do
+    Order* fake(int64_t i) { return reinterpret_cast<Order*>(static_cast<uintptr_t>(64 * (i + 1))); }
+};
+
+// Test insert, lookup and erase by ID
+TEST_F(OrderTableTest, InsertGetErase) {
+    table.insert(7, fake(7));
+    table.insert(5000, fake(5000));
+
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(table.get(7), fake(7));
+    EXPECT_EQ(table.get(5000), fake(5000));
+    EXPECT_EQ(table.get(8), nullptr);
+    EXPECT_EQ(table.get(-1), nullptr);
+    EXPECT_EQ(table.find(9), table.end());
+
+    EXPECT_TRUE(table.erase(7));
+    EXPECT_FALSE(table.erase(7));
+    EXPECT_EQ(table.get(7), nullptr);
+    EXPECT_EQ(table.size(), 1);
+}
+
+// Test that iteration visits every live order exactly once
+TEST_F(OrderTableTest, IteratesEveryLiveOrder) {
+    const int64_t ids[] = {3, 4095, 4096, 20000};
+    for (int64_t id : ids)
+        table.insert(id, fake(id));
+    table.insert(77, fake(77));
+    table.erase(77);
+
+    std::vector<int64_t> visited;
+    for (const auto& [orderId, orderPtr] : table) {
+        EXPECT_EQ(orderPtr, fake(orderId));
+        visited.push_back(orderId);
+    }
+    std::sort(visited.begin(), visited.end());
+    EXPECT_EQ(visited, std::vector<int64_t>(std::begin(ids), std::end(ids)));
+}
+
+// Test that entries probed past an erased one stay reachable across growth and shrinking
+TEST_F(OrderTableTest, EraseKeepsProbeChains) {
+    for (int64_t id = 0; id < 5000; ++id)
+        table.insert(id * 7, fake(id));
+    for (int64_t id = 0; id < 5000; id += 2)
+        EXPECT_TRUE(table.erase(id * 7));
+
+    EXPECT_EQ(table.size(), 2500);
+    for (int64_t id = 0; id < 5000; ++id)
+        EXPECT_EQ(table.get(id * 7), id % 2 == 0 ? nullptr : fake(id));
+}
+
+// Test that memory follows the number of live orders, not the span of their IDs
+TEST_F(OrderTableTest, CapacityTracksLiveOrders) {
+    // a long-lived order, then IDs spread thin as if shared with a thousand other books
+    table.insert(0, fake(0));
+    for (int64_t id = 1000; id < 20'000'000; id += 1000) {
+        table.insert(id, fake(id));
+        EXPECT_TRUE(table.erase(id));
+    }
+    EXPECT_EQ(table.capacity(), OrderTable::MIN_CAPACITY);
+
+    // capacity follows the peak, and is kept for the next burst
+    for (int64_t id = 1; id <= 1000; ++id)
+        table.insert(id, fake(id));
+    EXPECT_EQ(table.capacity(), 2048);
+    for (int64_t id = 1; id <= 1000; ++id)
+        table.erase(id);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.get(0), fake(0));
+    EXPECT_EQ(table.capacity(), 2048);
+    table.reserve(3000);
+    EXPECT_EQ(table.capacity(), 8192);
+
+    table.erase(0);
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.begin(), table.end());
+}
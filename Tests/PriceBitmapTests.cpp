@@ -0,0 +1,88 @@
+#include "../src/PriceBitmap.hpp"
+#include "../src/Book.h"
+#include <gtest/gtest.h>
+
+using Bitmap = PriceBitmap<LOBSide<Side::Buy>::RANGE>;
+
+class PriceBitmapTest : public ::testing::Test {
+protected:
+    std::unique_ptr<Bitmap> bitmap;
+
+    void SetUp() override {
+        bitmap = std::make_unique<Bitmap>();
+    }
+};
+
+// Test that an empty bitmap reports no prices
+TEST_F(PriceBitmapTest, EmptyBitmap) {
+    EXPECT_TRUE(bitmap->empty());
+    EXPECT_EQ(bitmap->findFirst(), -1);
+    EXPECT_EQ(bitmap->findLast(), -1);
+    EXPECT_EQ(bitmap->findNext(-1), -1);
+    EXPECT_EQ(bitmap->findPrev(LOBSide<Side::Buy>::RANGE), -1);
+}
+
+// Test first and last lookups at both ends of the range
+TEST_F(PriceBitmapTest, FirstAndLastAtRangeEnds) {
+    bitmap->set(0);
+    bitmap->set(200000);
+
+    EXPECT_EQ(bitmap->findFirst(), 0);
+    EXPECT_EQ(bitmap->findLast(), 200000);
+
+    bitmap->clear(0);
+    EXPECT_EQ(bitmap->findFirst(), 200000);
+
+    bitmap->clear(200000);
+    EXPECT_TRUE(bitmap->empty());
+}
+
+// Test next/prev lookups across word and summary boundaries
+TEST_F(PriceBitmapTest, NextAndPrevAcrossWords) {
+    const int32_t prices[] = {5, 63, 64, 4095, 4096, 150000, 199999};
+    for (int32_t p : prices)
+        bitmap->set(p);
+
+    int32_t p = -1;
+    for (int32_t expected : prices) {
+        p = bitmap->findNext(p);
+        EXPECT_EQ(p, expected);
+    }
+    EXPECT_EQ(bitmap->findNext(p), -1);
+
+    p = LOBSide<Side::Buy>::RANGE;
+    for (int i = std::size(prices) - 1; i >= 0; --i) {
+        p = bitmap->findPrev(p);
+        EXPECT_EQ(p, prices[i]);
+    }
+    EXPECT_EQ(bitmap->findPrev(p), -1);
+}
+
+// Test that clearing one of several bits in a word keeps the summary bits
+TEST_F(PriceBitmapTest, ClearKeepsSiblingBits) {
+    bitmap->set(128);
+    bitmap->set(130);
+    bitmap->clear(128);
+
+    EXPECT_TRUE(bitmap->test(130));
+    EXPECT_FALSE(bitmap->test(128));
+    EXPECT_EQ(bitmap->findFirst(), 130);
+    EXPECT_EQ(bitmap->findLast(), 130);
+}
+
+// Test best price recovery when the book sits at the far end of the range
+TEST_F(PriceBitmapTest, BestPriceRecoveryAtFarEnd) {
+    Book book;
+    OrderIdSequence seq;
+
+    book.addOrderToBook(Side::Sell, 5, 199995, OrderType::Limit, seq);
+    book.addOrderToBook(Side::Sell, 5, 199990, OrderType::Limit, seq);
+    book.addOrderToBook(Side::Buy, 5, 2, OrderType::Limit, seq);
+    book.addOrderToBook(Side::Buy, 5, 5, OrderType::Limit, seq);
+
+    book.cancelOrder(1);
+    book.cancelOrder(3);
+
+    EXPECT_EQ(book.getSellSide().getBestPrice(), 199995);
+    EXPECT_EQ(book.getBuySide().getBestPrice(), 2);
+}
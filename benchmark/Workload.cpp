@@ -0,0 +1,162 @@
+#include "Workload.h"
+#include "../src/Book.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+/// splitmix64: a fixed, portable generator, so a seed yields the same stream with any standard library.
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    double exponential(double mean) {
+        return -std::log1p(-uniform()) * mean;
+    }
+
+    size_t below(size_t bound) {
+        return static_cast<size_t>(uniform() * static_cast<double>(bound));
+    }
+
+private:
+    uint64_t state;
+};
+
+/// Order sizes with their weights: mostly odd lots and round lots, with a tail of large orders.
+struct SizeBucket {
+    int32_t low;
+    int32_t high;
+    double weight;
+};
+constexpr std::array<SizeBucket, 5> SIZE_BUCKETS{{
+    {1, 9, 0.35},
+    {100, 100, 0.40},
+    {10, 99, 0.10},
+    {200, 500, 0.10},
+    {1'000, 5'000, 0.05},
+}};
+
+int32_t drawSize(Random& random) {
+    double pick = random.uniform();
+    for (const SizeBucket& bucket : SIZE_BUCKETS) {
+        if (pick < bucket.weight) {
+            return bucket.low + static_cast<int32_t>(random.below(static_cast<size_t>(bucket.high - bucket.low + 1)));
+        }
+        pick -= bucket.weight;
+    }
+    return SIZE_BUCKETS.back().low;
+}
+
+} // namespace
+
+/**
+ * @brief Generates a reproducible stream of inbound messages for one instrument.
+ *
+ * Arrivals form a Poisson process. Each message adds a passive order, cancels a resting one or
+ * takes liquidity, in the proportions set by the options. Passive prices sit an exponentially
+ * distributed number of ticks behind the touch, so resting volume clusters around the mid.
+ * Trades are immediate-or-cancel market orders of a mixed size; a few are sized to sweep
+ * several levels and move the market.
+ *
+ * The stream is generated against a private Book, so cancels only target orders that are still
+ * resting and every message carries the order ID an Exchange listing only this instrument will
+ * assign, when the stream is replayed into it from the start.
+ *
+ * @param options Shape of the stream.
+ * @return The messages, in arrival order.
+ */
+std::vector<WorkloadMessage> generateWorkload(const WorkloadOptions& options) {
+    Random random(options.seed);
+    Book book;
+    OrderIdSequence ids;
+    std::vector<int64_t> resting;
+    std::vector<WorkloadMessage> stream;
+    stream.reserve(options.messages);
+    std::array<DepthLevel, 8> depth;
+    double time = 0;
+
+    while (stream.size() < options.messages) {
+        time += random.exponential(1e9 / options.messagesPerSecond);
+        WorkloadMessage message{static_cast<Timestamp>(time), -1, WorkloadAction::Add, Side::Buy, 0, NO_PRICE};
+        message.side = random.uniform() < 0.5 ? Side::Buy : Side::Sell;
+
+        const double pick = random.uniform();
+        if (pick < options.tradeFraction) {
+            message.action = WorkloadAction::Trade;
+        } else if ((pick < options.tradeFraction + options.cancelFraction || resting.size() >= options.maxRestingOrders)
+                   && !resting.empty()) {
+            message.action = WorkloadAction::Cancel;
+        }
+
+        switch (message.action) {
+            case WorkloadAction::Trade: {
+                message.shares = drawSize(random);
+                if (random.uniform() < options.sweepFraction) {
+                    const size_t levels = message.side == Side::Buy ? book.getSellSide().getDepth(depth)
+                                                                    : book.getBuySide().getDepth(depth);
+                    const size_t take = std::min(levels, size_t{3} + random.below(depth.size() - 2));
+                    for (size_t i = 0; i < take; ++i) {
+                        message.shares += depth[i].volume;
+                    }
+                }
+                message.orderId = ids.peekNextId();
+                book.addOrderToBook(message.side, message.shares, NO_PRICE, OrderType::Market, ids,
+                                    TimeInForce::ImmediateOrCancel);
+                break;
+            }
+            case WorkloadAction::Cancel: {
+                // orders filled by trades are dropped from the candidates as they are drawn
+                for (;;) {
+                    const size_t index = random.below(resting.size());
+                    const int64_t candidate = resting[index];
+                    resting[index] = resting.back();
+                    resting.pop_back();
+                    if (book.getAllOrders().get(candidate)) {
+                        message.orderId = candidate;
+                        break;
+                    }
+                    if (resting.empty()) {
+                        break;
+                    }
+                }
+                if (message.orderId >= 0) {
+                    book.cancelOrder(message.orderId);
+                    break;
+                }
+                message.action = WorkloadAction::Add;
+                [[fallthrough]];
+            }
+            case WorkloadAction::Add: {
+                const Price behind = 1 + static_cast<Price>(random.exponential(options.meanTicksBehindTouch));
+                if (message.side == Side::Buy) {
+                    const Price ask = book.getSellSide().getBestLimit() ? book.getSellSide().getBestPrice() : options.initialMid;
+                    message.limit = std::max(ask - behind, 1);
+                } else {
+                    const Price bid = book.getBuySide().getBestLimit() ? book.getBuySide().getBestPrice() : options.initialMid;
+                    message.limit = std::min(bid + behind, LOBSide<Side::Sell>::MAX_PRICE);
+                }
+                message.shares = drawSize(random);
+                message.orderId = ids.peekNextId();
+                book.addOrderToBook(message.side, message.shares, message.limit, OrderType::Limit, ids);
+                resting.push_back(message.orderId);
+                break;
+            }
+        }
+        stream.push_back(message);
+        book.getExecutions().drain([](std::span<const ExecutionReport>) {});
+        book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+    }
+    return stream;
+}
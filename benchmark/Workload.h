@@ -0,0 +1,72 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../src/Clock.h"
+#include "../src/Price.h"
+#include "../src/Side.hpp"
+
+/**
+ * @struct WorkloadOptions
+ * @brief Shape of a generated message stream. The defaults resemble a busy, liquid instrument.
+ */
+struct WorkloadOptions {
+    uint64_t seed = 1;
+    size_t messages = 1'000'000;
+    double messagesPerSecond = 1'000'000; // mean rate of the Poisson arrival process
+    double tradeFraction = 0.025;         // messages that take liquidity
+    double cancelFraction = 0.475;        // messages that cancel a resting order: 95% of exits are cancels
+    double sweepFraction = 0.05;          // trades sized to clear several levels
+    Price initialMid = 10'000;            // in ticks
+    double meanTicksBehindTouch = 3.0;    // passive orders sit an exponential distance behind the touch
+    size_t maxRestingOrders = 20'000;     // adds turn into cancels beyond this
+};
+
+/**
+ * @enum WorkloadAction
+ * @brief What one message of a stream does.
+ */
+enum class WorkloadAction : uint8_t {
+    Add,    ///< passive limit order
+    Cancel, ///< cancel of a resting order
+    Trade   ///< immediate-or-cancel market order
+};
+
+/**
+ * @struct WorkloadMessage
+ * @brief One inbound message of a generated stream.
+ */
+struct WorkloadMessage {
+    Timestamp arrival; // ns since the start of the stream
+    int64_t orderId;   // the order a cancel targets, or the ID an add or trade will be assigned
+    WorkloadAction action;
+    Side side;
+    int32_t shares;
+    Price limit;       // NO_PRICE for trades
+};
+
+std::vector<WorkloadMessage> generateWorkload(const WorkloadOptions& options);
@@ -1,20 +1,44 @@
+#include "../src/BboConsolidator.h"
 #include "../src/Book.h"
+#include "../src/Exchange.hpp"
+#include "../src/ShardedExchange.hpp"
+#include "Workload.h"
 #include <benchmark/benchmark.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+// Resident set size of this process in bytes (Linux only, 0 elsewhere)
+static size_t currentRssBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident))
+        return 0;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
 
 // 1️⃣ Adding N limit orders
 static void BM_AddLimitOrders(benchmark::State& state) {
     int num_orders = state.range(0);
 
     for (auto _ : state) {
-        Book book;
+        state.PauseTiming();
+        auto book = std::make_unique<Book>();
         OrderIdSequence seq;
+        state.ResumeTiming();
 
         for (int i = 0; i < num_orders; ++i) {
-            float price = 10.0f + (i % 500) * 0.01f;
+            Price price = 1000 + static_cast<Price>(i % 500);
             Side side = (i % 2 == 0) ? Side::Buy : Side::Sell;
             int size = 10 + (i % 20);
-            book.addOrderToBook(side, size, price, OrderType::Limit, seq);
+            book->addOrderToBook(side, size, price, OrderType::Limit, seq);
         }
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
     }
 
     state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num_orders);
@@ -28,22 +52,27 @@ BENCHMARK(BM_AddLimitOrders)
 static void BM_AddAndCancelOrders(benchmark::State& state) {
     int num_orders = state.range(0);
 
-    for (auto _ : state) {
-        Book book;
-        OrderIdSequence seq;
+    // The book is reused so that, after the first round, every add is served from the warm order pool
+    Book book;
+    OrderIdSequence seq;
+    int64_t firstId = 0;
 
+    for (auto _ : state) {
         // Insert orders
         for (int i = 0; i < num_orders; ++i) {
-            book.addOrderToBook(Side::Buy, 5, 15.0f + i * 0.01f, OrderType::Limit, seq);
+            book.addOrderToBook(Side::Buy, 5, 1500 + i, OrderType::Limit, seq);
         }
 
         // Cancel them
         for (int i = 0; i < num_orders; ++i) {
-            book.cancelOrder(i);
+            book.cancelOrder(firstId + i);
         }
+        firstId += num_orders;
     }
 
     state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num_orders * 2);
+    state.counters["pool_chunks"] = static_cast<double>(book.getOrderPool().getChunkCount());
+    state.counters["pool_high_water"] = static_cast<double>(book.getOrderPool().getHighWaterMark());
 }
 BENCHMARK(BM_AddAndCancelOrders)
     ->Arg(1'000)
@@ -54,19 +83,25 @@ static void BM_AddAndModifyOrders(benchmark::State& state) {
     int num_orders = state.range(0);
 
     for (auto _ : state) {
-        Book book;
+        state.PauseTiming();
+        auto book = std::make_unique<Book>();
         OrderIdSequence seq;
+        state.ResumeTiming();
 
         // Insert orders
         for (int i = 0; i < num_orders; ++i) {
-            book.addOrderToBook(Side::Sell, 7, 20.0f + i * 0.02f, OrderType::Limit, seq);
+            book->addOrderToBook(Side::Sell, 7, 2000 + i * 2, OrderType::Limit, seq);
         }
 
         // Modify their prices
         for (int i = 0; i < num_orders; ++i) {
-            float new_price = 21.0f + i * 0.02f;
-            book.modifyOrderLimitPrice(i, new_price, seq);
+            Price new_price = 2100 + i * 2;
+            book->modifyOrderLimitPrice(i, new_price);
         }
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
     }
 
     state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num_orders * 2);
@@ -75,22 +110,28 @@ BENCHMARK(BM_AddAndModifyOrders)
     ->Arg(1'000)
     ->Arg(10'000);
 
-// 4️⃣ Placing market orders against pre-populated book
+// 4️⃣ Placing market orders against pre-populated book (construction and population not timed)
 static void BM_PlaceMarketOrders(benchmark::State& state) {
     int num_orders = state.range(0);
     int market_order_size = state.range(1);
 
     for (auto _ : state) {
-        Book book;
+        state.PauseTiming();
+        auto book = std::make_unique<Book>();
         OrderIdSequence seq;
 
         // Populate book
         for (int i = 0; i < num_orders; ++i) {
-            book.addOrderToBook(Side::Buy, 5, 25.0f + i * 0.01f, OrderType::Limit, seq);
+            book->addOrderToBook(Side::Buy, 5, 2500 + i, OrderType::Limit, seq);
         }
+        state.ResumeTiming();
 
         // Place market order
-        book.placeMarketOrder(market_order_size, Side::Sell);
+        book->placeMarketOrder(market_order_size, Side::Sell);
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
     }
 
     state.SetItemsProcessed(state.iterations());
@@ -100,5 +141,866 @@ BENCHMARK(BM_PlaceMarketOrders)
     ->Args({10'000, 1'000})
     ->Args({100'000, 10'000});
 
+// 5️⃣ Best price recovery with the book at the far end of the price range
+static void BM_BestPriceRecoveryFarEnd(benchmark::State& state) {
+    Book book;
+    OrderIdSequence seq;
+
+    // Asks parked near MAX_PRICE, bids near MIN_PRICE: the worst case for a flat scan
+    book.addOrderToBook(Side::Sell, 5, 199995, OrderType::Limit, seq);
+    book.addOrderToBook(Side::Buy, 5, 5, OrderType::Limit, seq);
+
+    for (auto _ : state) {
+        book.addOrderToBook(Side::Sell, 5, 199990, OrderType::Limit, seq);
+        book.cancelOrder(seq.getNextId() - 1);
+        book.addOrderToBook(Side::Buy, 5, 10, OrderType::Limit, seq);
+        book.cancelOrder(seq.getNextId() - 1);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 4);
+}
+BENCHMARK(BM_BestPriceRecoveryFarEnd);
+
+// Reference: the flat word scan LOBSide used before the hierarchical bitmap
+static int32_t flatScanFirst(const uint64_t* words, int32_t count) {
+    for (int32_t i = 0; i < count; ++i) {
+        if (words[i])
+            return i * 64 + __builtin_ctzll(words[i]);
+    }
+    return -1;
+}
+
+static int32_t flatScanLast(const uint64_t* words, int32_t count) {
+    for (int32_t i = count - 1; i >= 0; --i) {
+        if (words[i])
+            return i * 64 + 63 - __builtin_clzll(words[i]);
+    }
+    return -1;
+}
+
+// 6️⃣ Lowest ask near MAX_PRICE and highest bid near MIN_PRICE: flat scan vs hierarchical bitmap
+static void BM_FlatScanFarEnd(benchmark::State& state) {
+    constexpr int32_t words = LOBSide<Side::Sell>::BITMAP_SIZE;
+    std::vector<uint64_t> asks(words, 0), bids(words, 0);
+    asks[199990 / 64] |= 1ULL << (199990 % 64);
+    bids[10 / 64] |= 1ULL << (10 % 64);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(flatScanFirst(asks.data(), words));
+        benchmark::DoNotOptimize(flatScanLast(bids.data(), words));
+    }
+}
+BENCHMARK(BM_FlatScanFarEnd);
+
+static void BM_PriceBitmapFarEnd(benchmark::State& state) {
+    auto asks = std::make_unique<PriceBitmap<LOBSide<Side::Sell>::RANGE>>();
+    auto bids = std::make_unique<PriceBitmap<LOBSide<Side::Buy>::RANGE>>();
+    asks->set(199990);
+    bids->set(10);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(asks->findFirst());
+        benchmark::DoNotOptimize(bids->findLast());
+    }
+}
+BENCHMARK(BM_PriceBitmapFarEnd);
+
+// 7️⃣ Constructing an empty Book
+static void BM_BookConstruction(benchmark::State& state) {
+    for (auto _ : state) {
+        Book book;
+        benchmark::DoNotOptimize(&book);
+    }
+}
+BENCHMARK(BM_BookConstruction);
+
+// 8️⃣ Listing many instruments, reporting resident memory per Book
+static void BM_AddInstruments(benchmark::State& state) {
+    int num_instruments = state.range(0);
+    double rssPerInstrument = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto exchange = std::make_unique<Exchange>("BENCH");
+        std::vector<std::string> tickers;
+        for (int i = 0; i < num_instruments; ++i)
+            tickers.push_back("SYM" + std::to_string(i));
+        size_t rssBefore = currentRssBytes();
+        state.ResumeTiming();
+
+        for (const auto& ticker : tickers)
+            exchange->addInstrument(ticker);
+
+        state.PauseTiming();
+        rssPerInstrument = static_cast<double>(currentRssBytes() - rssBefore) / num_instruments;
+        exchange.reset();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num_instruments);
+    state.counters["rss_bytes_per_instrument"] = rssPerInstrument;
+}
+BENCHMARK(BM_AddInstruments)
+    ->Arg(1'000)
+    ->Arg(20'000)
+    ->Unit(benchmark::kMillisecond);
+
+// 9️⃣ Sharded exchange throughput from 1 to 16 matching threads
+static void BM_ShardedThroughput(benchmark::State& state) {
+    const size_t num_shards = static_cast<size_t>(state.range(0));
+    constexpr int num_instruments = 64;
+    constexpr int orders_per_iteration = 100'000;
+
+    ShardedExchange exchange("BENCH", num_shards);
+    std::vector<InstrumentId> instruments;
+    for (int i = 0; i < num_instruments; ++i) {
+        instruments.push_back(exchange.addInstrument("SYM" + std::to_string(i)));
+    }
+    exchange.flush();
+
+    for (auto _ : state) {
+        for (int i = 0; i < orders_per_iteration; ++i) {
+            const InstrumentId instrument = instruments[i % num_instruments];
+            Side side = (i / num_instruments) % 2 == 0 ? Side::Buy : Side::Sell;
+            Price price = (side == Side::Buy ? 1000 : 1045) + static_cast<Price>(i % 50);
+            exchange.addOrder(instrument, side, 10 + (i % 20), price, OrderType::Limit);
+        }
+        exchange.flush();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * orders_per_iteration);
+}
+BENCHMARK(BM_ShardedThroughput)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// 🔟 Order entry through the ticker API vs the InstrumentId API
+static void BM_ExchangeAddCancelByTicker(benchmark::State& state) {
+    Exchange exchange("BENCH");
+    const std::string ticker = "TTF 24Q-ICN";
+    exchange.addInstrument(ticker);
+    Book* book = exchange.getOrderBook(ticker);
+    int64_t nextId = 0;
+
+    for (auto _ : state) {
+        exchange.addOrder(ticker, Side::Buy, 5, 4700, OrderType::Limit);
+        exchange.modifyOrderSize(ticker, nextId, 6);
+        book->cancelOrder(nextId++);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 2);
+}
+BENCHMARK(BM_ExchangeAddCancelByTicker);
+
+static void BM_ExchangeAddCancelById(benchmark::State& state) {
+    Exchange exchange("BENCH");
+    const InstrumentId instrument = exchange.addInstrument("TTF 24Q-ICN");
+    Book* book = exchange.getOrderBook(instrument);
+    int64_t nextId = 0;
+
+    for (auto _ : state) {
+        exchange.addOrder(instrument, Side::Buy, 5, 4700, OrderType::Limit);
+        exchange.modifyOrderSize(instrument, nextId, 6);
+        book->cancelOrder(nextId++);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 2);
+}
+BENCHMARK(BM_ExchangeAddCancelById);
+
+// 1️⃣1️⃣ Journaling overhead per add + cancel: arg 0 = no journal, 1 = no msync, 2 = msync every 1024 messages, 3 = msync every 1000 us
+static void BM_JournalOverhead(benchmark::State& state) {
+    const std::string path = (std::filesystem::temp_directory_path() / "exchange_journal_bench.bin").string();
+    std::filesystem::remove(path);
+
+    Exchange exchange("BENCH");
+    if (state.range(0) > 0) {
+        JournalOptions options;
+        options.policy = static_cast<JournalSyncPolicy>(state.range(0) - 1);
+        exchange.attachJournal(std::make_unique<Journal>(path, options));
+    }
+    const InstrumentId instrument = exchange.addInstrument("TTF 24Q-ICN");
+    int64_t nextId = 0;
+
+    for (auto _ : state) {
+        exchange.addOrder(instrument, Side::Buy, 5, 4700, OrderType::Limit);
+        exchange.cancelOrder(instrument, nextId++);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 2);
+    exchange.attachJournal(nullptr);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_JournalOverhead)->DenseRange(0, 3);
+
+// 1️⃣2️⃣ Startup with N resting orders: snapshot capture, bulk restore, and rebuilding through addOrder
+static void populateForSnapshot(Exchange& exchange, InstrumentId instrument, int64_t orders) {
+    for (int64_t i = 0; i < orders; ++i) {
+        const bool buy = i % 2 == 0;
+        const Price price = static_cast<Price>(buy ? 900 - i % 500 : 1100 + i % 500);
+        exchange.addOrder(instrument, buy ? Side::Buy : Side::Sell, 1 + static_cast<int>(i % 50), price, OrderType::Limit);
+    }
+}
+
+static void BM_SnapshotCapture(benchmark::State& state) {
+    Exchange exchange("BENCH");
+    const InstrumentId instrument = exchange.addInstrument("TTF 24Q-ICN");
+    populateForSnapshot(exchange, instrument, state.range(0));
+
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::vector<char> data = exchange.snapshot();
+        bytes = data.size();
+        benchmark::DoNotOptimize(data.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_SnapshotCapture)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_SnapshotRestore(benchmark::State& state) {
+    Exchange source("BENCH");
+    const InstrumentId instrument = source.addInstrument("TTF 24Q-ICN");
+    populateForSnapshot(source, instrument, state.range(0));
+    const std::vector<char> data = source.snapshot();
+
+    for (auto _ : state) {
+        Exchange restored("BENCH");
+        restored.restoreSnapshot(data);
+        benchmark::DoNotOptimize(restored.getOrderBook(instrument));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_SnapshotRestore)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_RebuildByAddOrder(benchmark::State& state) {
+    for (auto _ : state) {
+        Exchange rebuilt("BENCH");
+        const InstrumentId instrument = rebuilt.addInstrument("TTF 24Q-ICN");
+        populateForSnapshot(rebuilt, instrument, state.range(0));
+        benchmark::DoNotOptimize(rebuilt.getOrderBook(instrument));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_RebuildByAddOrder)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// 1️⃣3️⃣ L2 publishing: add + cancel with its depth updates drained, and a top-10 depth read, vs number of levels
+static void BM_DepthUpdatesPerMessage(benchmark::State& state) {
+    Book book;
+    OrderIdSequence idSeq;
+    for (int64_t level = 0; level < state.range(0); ++level) {
+        book.addOrderToBook(Side::Buy, 10, 100000 - level, OrderType::Limit, idSeq);
+    }
+    book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+
+    size_t published = 0;
+    for (auto _ : state) {
+        const int64_t orderId = idSeq.getNextId();
+        book.addOrderToBook(Side::Buy, 5, 99995, OrderType::Limit, orderId);
+        book.cancelOrder(orderId);
+        published += book.getDepthUpdates().drain([](std::span<const DepthUpdate> batch) {
+            benchmark::DoNotOptimize(batch.data());
+        });
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 2);
+    state.counters["updates/iter"] = static_cast<double>(published) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_DepthUpdatesPerMessage)->Arg(10)->Arg(1000)->Arg(90000);
+
+static void BM_TopOfBookDepth(benchmark::State& state) {
+    Book book;
+    OrderIdSequence idSeq;
+    for (int64_t level = 0; level < state.range(0); ++level) {
+        book.addOrderToBook(Side::Sell, 10, 1000 + level * 2, OrderType::Limit, idSeq);
+    }
+
+    DepthLevel depth[10];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.getSellSide().getDepth(depth));
+    }
+}
+BENCHMARK(BM_TopOfBookDepth)->Arg(10)->Arg(1000)->Arg(90000);
+
+// 1️⃣4️⃣ Order entry in bursts of N: one addOrderToBook call per order vs one submitBatch call (each burst is then canceled)
+static std::vector<OrderRequest> makeBurst(int64_t size) {
+    std::vector<OrderRequest> burst;
+    uint32_t seed = 12345;
+    for (int64_t i = 0; i < size; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const bool buy = (seed >> 16) & 1;
+        const int32_t offset = static_cast<int32_t>((seed >> 8) % 20000);
+        const Price price = buy ? 50000 - offset : 50001 + offset;
+        burst.push_back({buy ? Side::Buy : Side::Sell, OrderType::Limit, 1 + static_cast<int32_t>(seed % 100), price});
+    }
+    return burst;
+}
+
+static void populateBackground(Book& book, OrderIdSequence& idSeq) {
+    for (const OrderRequest& request : makeBurst(100000)) {
+        book.addOrderToBook(request.side, request.shares, request.limit, request.type, idSeq);
+    }
+}
+
+static void BM_SequentialEntry(benchmark::State& state) {
+    Book book;
+    OrderIdSequence idSeq;
+    populateBackground(book, idSeq);
+    const std::vector<OrderRequest> burst = makeBurst(state.range(0));
+
+    for (auto _ : state) {
+        const int64_t firstId = idSeq.peekNextId();
+        for (const OrderRequest& request : burst) {
+            book.addOrderToBook(request.side, request.shares, request.limit, request.type, idSeq);
+        }
+        for (int64_t id = firstId; id < idSeq.peekNextId(); ++id) {
+            book.cancelOrder(id);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_SequentialEntry)->Arg(1)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_BatchEntry(benchmark::State& state) {
+    Book book;
+    OrderIdSequence idSeq;
+    populateBackground(book, idSeq);
+    const std::vector<OrderRequest> burst = makeBurst(state.range(0));
+    std::vector<OrderResult> results(burst.size());
+
+    for (auto _ : state) {
+        const int64_t firstId = idSeq.peekNextId();
+        book.submitBatch(burst, results, idSeq);
+        for (int64_t id = firstId; id < idSeq.peekNextId(); ++id) {
+            book.cancelOrder(id);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_BatchEntry)->Arg(1)->Arg(16)->Arg(256)->Arg(4096);
+
+// 1️⃣5️⃣ Timestamping: one read of each clock source, and order entry on a book stamped by it (0 = monotonic, 1 = TSC, 2 = virtual)
+static void BM_ClockRead(benchmark::State& state) {
+    const Clock clock(static_cast<ClockSource>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(clock.now());
+    }
+}
+BENCHMARK(BM_ClockRead)->Arg(0)->Arg(1)->Arg(2);
+
+static void BM_EntryByClock(benchmark::State& state) {
+    Clock clock(static_cast<ClockSource>(state.range(0)));
+    Book book;
+    book.setClock(clock);
+    OrderIdSequence idSeq;
+    populateBackground(book, idSeq);
+    const std::vector<OrderRequest> burst = makeBurst(256);
+
+    for (auto _ : state) {
+        const int64_t firstId = idSeq.peekNextId();
+        for (const OrderRequest& request : burst) {
+            book.addOrderToBook(request.side, request.shares, request.limit, request.type, idSeq);
+        }
+        for (int64_t id = firstId; id < idSeq.peekNextId(); ++id) {
+            book.cancelOrder(id);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 256);
+}
+BENCHMARK(BM_EntryByClock)->Arg(0)->Arg(1)->Arg(2);
+
+// 1️⃣6️⃣ Latency profile: add + cancel bursts, reporting the book's own p50/p99/p99.9 (ns) when built with EXCHANGE_ENABLE_LATENCY_STATS
+static void BM_LatencyProfile(benchmark::State& state) {
+    Book book;
+    OrderIdSequence idSeq;
+    populateBackground(book, idSeq);
+    const std::vector<OrderRequest> burst = makeBurst(256);
+
+    for (auto _ : state) {
+        const int64_t firstId = idSeq.peekNextId();
+        for (const OrderRequest& request : burst) {
+            book.addOrderToBook(request.side, request.shares, request.limit, request.type, idSeq);
+        }
+        for (int64_t id = firstId; id < idSeq.peekNextId(); ++id) {
+            book.cancelOrder(id);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 256);
+    for (auto [op, name] : {std::pair{LatencyOp::AddOrder, "add"}, std::pair{LatencyOp::CancelOrder, "cancel"}}) {
+        LatencyDistribution distribution;
+        book.getLatencyStats().mergeInto(op, distribution);
+        state.counters[std::string(name) + "_p50"] = static_cast<double>(distribution.percentile(50));
+        state.counters[std::string(name) + "_p99"] = static_cast<double>(distribution.percentile(99));
+        state.counters[std::string(name) + "_p99.9"] = static_cast<double>(distribution.percentile(99.9));
+    }
+}
+BENCHMARK(BM_LatencyProfile);
+
+// 1️⃣7️⃣ Matching policies: fill a 64-order level, send a market order for half of it, cancel the rest (0 = FIFO, 1 = pro-rata, 2 = top order + pro-rata)
+static void BM_MatchingPolicy(benchmark::State& state) {
+    Book book(MatchingPolicy{static_cast<MatchingAlgorithm>(state.range(0)), ProRataRounding::Down, 50});
+    OrderIdSequence idSeq;
+    int32_t levelVolume = 0;
+    for (int i = 0; i < 64; ++i) {
+        levelVolume += 10 + i % 7;
+    }
+    size_t fills = 0;
+
+    for (auto _ : state) {
+        const int64_t firstId = idSeq.peekNextId();
+        for (int i = 0; i < 64; ++i) {
+            book.addOrderToBook(Side::Sell, 10 + i % 7, 5000, OrderType::Limit, idSeq);
+        }
+        book.placeMarketOrder(levelVolume / 2, Side::Buy);
+        fills += book.getExecutions().drain([](std::span<const ExecutionReport>) {});
+        for (int64_t id = firstId; id < idSeq.peekNextId(); ++id) {
+            if (book.getAllOrders().get(id)) {
+                book.cancelOrder(id);
+            }
+        }
+    }
+
+    state.counters["fills/iter"] = static_cast<double>(fills) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_MatchingPolicy)->Arg(0)->Arg(1)->Arg(2);
+
+// 1️⃣8️⃣ Time in force: a passive bid one tick below a ten-level ask side, canceled again if it rests (0 = GTC, 1 = IOC, 2 = FOK, 3 = post-only, 4 = post-only reprice)
+static void BM_TimeInForce(benchmark::State& state) {
+    const auto timeInForce = static_cast<TimeInForce>(state.range(0));
+    Book book;
+    OrderIdSequence idSeq;
+    for (int i = 0; i < 10; ++i) {
+        book.addOrderToBook(Side::Sell, 100, 5001 + i, OrderType::Limit, idSeq);
+    }
+    size_t rested = 0;
+
+    for (auto _ : state) {
+        const OrderResult result = book.addOrderToBook(Side::Buy, 10, 5000, OrderType::Limit, idSeq, timeInForce);
+        if (result.status == OrderStatus::Resting) {
+            book.cancelOrder(result.orderId);
+            ++rested;
+        }
+    }
+
+    state.counters["rested/iter"] = static_cast<double>(rested) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_TimeInForce)->DenseRange(0, 4);
+
+// 1️⃣9️⃣ Aggressive sweep: one limit order taking N consecutive ask levels of two orders each (refill not timed)
+static void BM_SweepLevels(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    Book book;
+    OrderIdSequence idSeq;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < levels; ++i) {
+            book.addOrderToBook(Side::Sell, 3, 5000 + i, OrderType::Limit, idSeq);
+            book.addOrderToBook(Side::Sell, 2, 5000 + i, OrderType::Limit, idSeq);
+        }
+        book.getExecutions().drain([](std::span<const ExecutionReport>) {});
+        book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+        state.ResumeTiming();
+
+        book.addOrderToBook(Side::Buy, levels * 5, 5000 + levels - 1, OrderType::Limit, idSeq);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * levels);
+}
+BENCHMARK(BM_SweepLevels)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+// 2️⃣0️⃣ Stop triggering: a trade fires one stop while N other stops stay parked far from the market
+static void BM_StopTrigger(benchmark::State& state) {
+    const int parked = static_cast<int>(state.range(0));
+    Book book;
+    OrderIdSequence idSeq;
+    book.addOrderToBook(Side::Buy, 1 << 30, 4000, OrderType::Limit, idSeq);
+    for (int i = 0; i < parked; ++i) {
+        book.addStopOrder(Side::Sell, 1, 1000 + i % 2000, NO_PRICE, idSeq);
+    }
+
+    for (auto _ : state) {
+        // trade back down at 4000 so that the next buy stop parks instead of entering at once
+        book.addOrderToBook(Side::Sell, 1, 4000, OrderType::Limit, idSeq);
+        book.addOrderToBook(Side::Sell, 2, 5000, OrderType::Limit, idSeq);
+        book.addStopOrder(Side::Buy, 1, 5000, NO_PRICE, idSeq);
+        book.addOrderToBook(Side::Buy, 1, 5000, OrderType::Limit, idSeq);
+        book.getExecutions().drain([](std::span<const ExecutionReport>) {});
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 4);
+    state.counters["parked"] = static_cast<double>(book.getTriggerBook()->size());
+}
+BENCHMARK(BM_StopTrigger)->Arg(0)->Arg(1'000)->Arg(100'000);
+
+// 2️⃣1️⃣ Replaying a generated venue-like stream (Poisson arrivals, 95% cancels vs trades, prices around the mid,
+//       mixed sizes, occasional sweeps) of N messages through an Exchange, with per-message latency percentiles (ns).
+//       Each message is timed with the TSC, so the reported throughput includes two clock reads per message.
+static void BM_ReplayWorkload(benchmark::State& state) {
+    WorkloadOptions options;
+    options.messages = static_cast<size_t>(state.range(0));
+    const std::vector<WorkloadMessage> stream = generateWorkload(options);
+    Clock timer(ClockSource::Tsc);
+    auto latencies = std::make_unique<LatencyHistogram>();
+    size_t fills = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto exchange = std::make_unique<Exchange>("BENCH", ClockSource::Virtual);
+        const InstrumentId instrument = exchange->addInstrument("SYM");
+        exchange->setExecutionHandler([&fills](InstrumentId, std::span<const ExecutionReport> batch) {
+            fills += batch.size();
+        });
+        state.ResumeTiming();
+
+        for (const WorkloadMessage& message : stream) {
+            exchange->getClock().setTime(message.arrival);
+            const Timestamp start = timer.now();
+            switch (message.action) {
+                case WorkloadAction::Add:
+                    exchange->addOrder(instrument, message.side, message.shares, message.limit, OrderType::Limit);
+                    break;
+                case WorkloadAction::Cancel:
+                    exchange->cancelOrder(instrument, message.orderId);
+                    break;
+                case WorkloadAction::Trade:
+                    exchange->addOrder(instrument, message.side, message.shares, NO_PRICE, OrderType::Market,
+                                       TimeInForce::ImmediateOrCancel);
+                    break;
+            }
+            latencies->record(timer.now() - start);
+        }
+
+        state.PauseTiming();
+        exchange.reset();
+        state.ResumeTiming();
+    }
+
+    LatencyDistribution distribution;
+    distribution.merge(*latencies);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+    state.counters["fills/msg"] = static_cast<double>(fills) / static_cast<double>(state.iterations() * stream.size());
+    state.counters["p50_ns"] = static_cast<double>(distribution.percentile(50));
+    state.counters["p99_ns"] = static_cast<double>(distribution.percentile(99));
+    state.counters["p99.9_ns"] = static_cast<double>(distribution.percentile(99.9));
+    state.counters["max_ns"] = static_cast<double>(distribution.getMax());
+}
+BENCHMARK(BM_ReplayWorkload)
+    ->Arg(100'000)
+    ->Arg(1'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+// 2️⃣2️⃣ Cancel + re-add of a random resting order among N: arg 0 = cancel by order ID, 1 = cancel by OrderHandle
+static void BM_CancelByHandle(benchmark::State& state) {
+    const bool byHandle = state.range(0) == 1;
+    const size_t resting = static_cast<size_t>(state.range(1));
+    Book book;
+    OrderIdSequence idSeq;
+    std::vector<OrderResult> orders(resting);
+    for (size_t i = 0; i < resting; ++i) {
+        orders[i] = book.addOrderToBook(Side::Buy, 10, 1000 + static_cast<Price>(i % 1000), OrderType::Limit, idSeq);
+    }
+
+    uint64_t lcg = 12345;
+    size_t sinceDrain = 0;
+    for (auto _ : state) {
+        lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t i = static_cast<size_t>((lcg >> 33) % resting);
+        if (byHandle) {
+            book.cancelOrder(orders[i].handle);
+        } else {
+            book.cancelOrder(orders[i].orderId);
+        }
+        orders[i] = book.addOrderToBook(Side::Buy, 10, 1000 + static_cast<Price>(i % 1000), OrderType::Limit, idSeq);
+        if (++sinceDrain == 1024) {
+            book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+            sinceDrain = 0;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_CancelByHandle)->ArgsProduct({{0, 1}, {1'000, 1'000'000}});
+
+// 2️⃣3️⃣ Pulling N orders of one participant, spread over 1000 bid levels among as many orders of others (refill not timed):
+//       arg 0 = one cancelOrder(id) per order, 1 = massCancel(participant), 2 = massCancel(side) on a side holding only theirs
+static void BM_MassCancel(benchmark::State& state) {
+    const int mode = static_cast<int>(state.range(0));
+    const int count = static_cast<int>(state.range(1));
+    const ParticipantId owner = 1;
+    Book book;
+    OrderIdSequence idSeq;
+    std::vector<int64_t> ids(count);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < count; ++i) {
+            const Price price = 1000 + i % 1000;
+            ids[i] = book.addOrderToBook(Side::Buy, 10, price, OrderType::Limit, idSeq, TimeInForce::GoodTillCancel, owner).orderId;
+            if (mode != 2) {
+                book.addOrderToBook(Side::Buy, 10, price, OrderType::Limit, idSeq, TimeInForce::GoodTillCancel, 2);
+            }
+        }
+        book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+        state.ResumeTiming();
+
+        if (mode == 0) {
+            for (int64_t id : ids) {
+                book.cancelOrder(id);
+            }
+        } else if (mode == 1) {
+            book.massCancel(owner);
+        } else {
+            book.massCancel(Side::Buy);
+        }
+
+        state.PauseTiming();
+        book.massCancel(Side::Buy);
+        book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_MassCancel)->ArgsProduct({{0, 1, 2}, {1'000, 100'000}})->Unit(benchmark::kMicrosecond);
+
+// 2️⃣4️⃣ Self-trade prevention on a sweep through N ask levels of two orders each (refill not timed):
+//       arg 0 = prevention off, 1 = cancel resting with no self-match, 2 = cancel resting with one own order per level
+static void BM_SelfTradePrevention(benchmark::State& state) {
+    const int mode = static_cast<int>(state.range(0));
+    const int levels = static_cast<int>(state.range(1));
+    const ParticipantId taker = 2;
+    Book book(MatchingPolicy{MatchingAlgorithm::Fifo, ProRataRounding::Down, 100,
+                             mode == 0 ? SelfTradePrevention::None : SelfTradePrevention::CancelResting});
+    OrderIdSequence idSeq;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < levels; ++i) {
+            book.addOrderToBook(Side::Sell, 3, 5000 + i, OrderType::Limit, idSeq, TimeInForce::GoodTillCancel, 1);
+            book.addOrderToBook(Side::Sell, 2, 5000 + i, OrderType::Limit, idSeq, TimeInForce::GoodTillCancel,
+                                mode == 2 ? taker : 1);
+        }
+        book.getExecutions().drain([](std::span<const ExecutionReport>) {});
+        book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+        state.ResumeTiming();
+
+        book.addOrderToBook(Side::Buy, levels * (mode == 2 ? 3 : 5), 5000 + levels - 1, OrderType::Limit, idSeq,
+                            TimeInForce::ImmediateOrCancel, taker);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * levels);
+}
+BENCHMARK(BM_SelfTradePrevention)->ArgsProduct({{0, 1, 2}, {10, 100}});
+
+// 2️⃣5️⃣ Quoting: one-tick reprices of random orders among 1000 resting bids over 50 levels
+//       (0 = cancel + re-add, what a reprice used to do, 1 = in-place reprice, 2 = in-place size-down and
+//       back up, which requeues the order)
+static void BM_Reprice(benchmark::State& state) {
+    const int mode = static_cast<int>(state.range(0));
+    Book book;
+    OrderIdSequence idSeq;
+    std::vector<OrderHandle> handles;
+    for (int i = 0; i < 1000; ++i) {
+        handles.push_back(book.addOrderToBook(Side::Buy, 10, 4000 + i % 50, OrderType::Limit, idSeq).handle);
+    }
+    uint64_t lcg = 12345;
+    size_t sinceDrain = 0;
+    for (auto _ : state) {
+        lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+        OrderHandle& handle = handles[static_cast<size_t>((lcg >> 33) % handles.size())];
+        const Order* order = book.findOrder(handle);
+        const Price price = order->getLimit() == 4000 ? 4001 : order->getLimit() - 1;
+        if (mode == 0) {
+            book.cancelOrder(handle);
+            handle = book.addOrderToBook(Side::Buy, 10, price, OrderType::Limit, idSeq).handle;
+        } else if (mode == 1) {
+            book.modifyOrderLimitPrice(handle, price);
+        } else {
+            book.modifyOrderSize(handle, order->getShares() == 10 ? 9 : 10);
+        }
+        if (++sinceDrain == 1024) {
+            book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+            sinceDrain = 0;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Reprice)->DenseRange(0, 2);
+
+// 2️⃣6️⃣ Top of book under contention: every message moves the best bid, so every message publishes,
+//       while 0-4 reader threads poll the book's seqlock slot; the matcher's time per message
+//       should not depend on the number of readers (given a core per thread)
+static void BM_TopOfBookContention(benchmark::State& state) {
+    const int readerCount = static_cast<int>(state.range(0));
+    Book book;
+    OrderIdSequence idSeq;
+    for (int i = 0; i < 100; ++i) {
+        book.addOrderToBook(Side::Buy, 10, 3900 + i, OrderType::Limit, idSeq);
+        book.addOrderToBook(Side::Sell, 10, 4100 + i, OrderType::Limit, idSeq);
+    }
+    const OrderHandle quote = book.addOrderToBook(Side::Buy, 10, 4001, OrderType::Limit, idSeq).handle;
+
+    const TopOfBookSlot& slot = book.getTopOfBook();
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> retries{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < readerCount; ++r) {
+        readers.emplace_back([&] {
+            uint64_t localReads = 0, localRetries = 0;
+            TopOfBook top;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (slot.tryRead(top)) {
+                    benchmark::DoNotOptimize(top);
+                    ++localReads;
+                } else {
+                    ++localRetries;
+                }
+            }
+            reads.fetch_add(localReads, std::memory_order_relaxed);
+            retries.fetch_add(localRetries, std::memory_order_relaxed);
+        });
+    }
+
+    Price price = 4001;
+    size_t sinceDrain = 0;
+    for (auto _ : state) {
+        price = price == 4001 ? 4002 : 4001;
+        book.modifyOrderLimitPrice(quote, price);
+        if (++sinceDrain == 1024) {
+            book.getDepthUpdates().drain([](std::span<const DepthUpdate>) {});
+            sinceDrain = 0;
+        }
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    const double attempts = static_cast<double>(reads.load() + retries.load());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["reads"] = benchmark::Counter(static_cast<double>(reads.load()), benchmark::Counter::kIsRate);
+    state.counters["retry_pct"] = attempts > 0 ? 100.0 * static_cast<double>(retries.load()) / attempts : 0.0;
+}
+BENCHMARK(BM_TopOfBookContention)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// 2️⃣7️⃣ Consolidated BBO: one venue's new top of book for a random one of 64 (cache-resident) or
+//       20000 instruments, then the instrument's best bid and offer across 4, 16 or 64 venues
+//       (0 = indexed heaps per instrument, 1 = rescan of every venue's quote)
+static void BM_ConsolidatedBbo(benchmark::State& state) {
+    const int mode = static_cast<int>(state.range(0));
+    const size_t venueCount = static_cast<size_t>(state.range(1));
+    const uint32_t instrumentCount = static_cast<uint32_t>(state.range(2));
+
+    BboConsolidator consolidator(venueCount);
+    std::vector<std::unique_ptr<Exchange>> venues; // empty venues; quotes are pushed through update()
+    for (size_t v = 0; v < venueCount; ++v) {
+        venues.push_back(std::make_unique<Exchange>("VENUE" + std::to_string(v)));
+        consolidator.addVenue(*venues.back());
+    }
+    std::vector<TopOfBook> quotes(instrumentCount * venueCount); // the rescan's copy
+    for (uint32_t i = 0; i < instrumentCount; ++i) {
+        consolidator.track("INST" + std::to_string(i));
+    }
+    uint64_t lcg = 12345;
+    auto nextQuote = [&lcg]() {
+        lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+        const int32_t offset = static_cast<int32_t>((lcg >> 40) % 8);
+        return TopOfBook{4000 - offset, 1 + offset, 1, 4001 + offset, 1 + offset, 1};
+    };
+    for (uint32_t i = 0; i < instrumentCount; ++i) {
+        for (VenueId venue = 0; venue < venueCount; ++venue) {
+            quotes[i * venueCount + venue] = nextQuote();
+            consolidator.update(InstrumentId{i}, venue, quotes[i * venueCount + venue]);
+        }
+    }
+
+    for (auto _ : state) {
+        const TopOfBook top = nextQuote();
+        const uint32_t instrument = static_cast<uint32_t>((lcg >> 33) % instrumentCount);
+        const VenueId venue = static_cast<VenueId>((lcg >> 20) % venueCount);
+        if (mode == 0) {
+            consolidator.update(InstrumentId{instrument}, venue, top);
+            benchmark::DoNotOptimize(consolidator.getBest(InstrumentId{instrument}));
+        } else {
+            const TopOfBook* row = &quotes[instrument * venueCount];
+            quotes[instrument * venueCount + venue] = top;
+            ConsolidatedQuote best;
+            for (VenueId v = 0; v < venueCount; ++v) {
+                if (best.bidVenue == NO_VENUE || row[v].bidPrice > best.bidPrice
+                    || (row[v].bidPrice == best.bidPrice && row[v].bidVolume > best.bidVolume)) {
+                    best.bidPrice = row[v].bidPrice;
+                    best.bidVolume = row[v].bidVolume;
+                    best.bidVenue = v;
+                }
+                if (best.askVenue == NO_VENUE || row[v].askPrice < best.askPrice
+                    || (row[v].askPrice == best.askPrice && row[v].askVolume > best.askVolume)) {
+                    best.askPrice = row[v].askPrice;
+                    best.askVolume = row[v].askVolume;
+                    best.askVenue = v;
+                }
+            }
+            benchmark::DoNotOptimize(best);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ConsolidatedBbo)->ArgsProduct({{0, 1}, {4, 16, 64}, {64, 20000}});
+
+// 2️⃣8️⃣ Sparse order IDs: N instruments share one ID sequence while adds and cancels churn round-robin
+//       through them, leaving 20 long-lived orders per instrument; reports order table bytes per resting order
+static void BM_SparseOrderIds(benchmark::State& state) {
+    const int numInstruments = static_cast<int>(state.range(0));
+    constexpr int ROUNDS = 200;
+    double tableBytesPerOrder = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto exchange = std::make_unique<Exchange>("BENCH", ClockSource::Virtual);
+        std::vector<InstrumentId> instruments;
+        for (int i = 0; i < numInstruments; ++i)
+            instruments.push_back(exchange->addInstrument("SYM" + std::to_string(i)));
+        state.ResumeTiming();
+
+        size_t resting = 0;
+        for (int round = 0; round < ROUNDS; ++round) {
+            for (InstrumentId instrument : instruments) {
+                const OrderResult result = exchange->addOrder(instrument, Side::Buy, 1, 1000 + round % 50, OrderType::Limit);
+                if (round % 10 == 0)
+                    ++resting;
+                else
+                    exchange->cancelOrder(instrument, result.handle);
+            }
+        }
+
+        state.PauseTiming();
+        size_t tableBytes = 0;
+        for (InstrumentId instrument : instruments)
+            tableBytes += exchange->getOrderBook(instrument)->getAllOrders().capacity() * sizeof(OrderTable::value_type);
+        tableBytesPerOrder = static_cast<double>(tableBytes) / static_cast<double>(resting);
+        exchange.reset();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * ROUNDS * numInstruments);
+    state.counters["table_bytes_per_order"] = tableBytesPerOrder;
+}
+BENCHMARK(BM_SparseOrderIds)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
 // ENTRY POINT
 BENCHMARK_MAIN();
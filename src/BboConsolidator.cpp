@@ -0,0 +1,323 @@
+#include "BboConsolidator.h"
+#include <stdexcept>
+
+namespace {
+
+/// Heap key of one side of a top of book: the price, flipped for offers so that a larger key is
+/// always better, above the resting shares at that price.
+template<Side S>
+uint64_t keyOf(const TopOfBook& top) {
+    const int32_t rank = S == Side::Buy ? top.bidPrice : INT32_MAX - top.askPrice;
+    const int32_t volume = S == Side::Buy ? top.bidVolume : top.askVolume;
+    return uint64_t{static_cast<uint32_t>(rank)} << 32 | static_cast<uint32_t>(volume);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty consolidator.
+ * @param maxVenues Number of venues each instrument row has room for.
+ * @throws std::invalid_argument if maxVenues is zero or not below NO_VENUE.
+ */
+BboConsolidator::BboConsolidator(size_t maxVenues)
+    : maxVenues(maxVenues)
+{
+    if (maxVenues == 0 || maxVenues >= NO_VENUE) {
+        throw std::invalid_argument("A consolidator needs between 1 and 65534 venues.");
+    }
+    venues.reserve(maxVenues);
+}
+
+/**
+ * @brief Adds a venue and binds it to every instrument already tracked that it lists.
+ *        The venue must outlive the consolidator and keep tracked instruments listed.
+ * @return The venue's ID, used to attribute quotes.
+ * @throws std::runtime_error if maxVenues venues were already added.
+ * @throws std::invalid_argument if the venue quotes a tracked instrument in different ticks.
+ */
+VenueId BboConsolidator::addVenue(const Exchange& venue) {
+    if (venues.size() == maxVenues) {
+        throw std::runtime_error("Consolidator has no room for another venue.");
+    }
+    const VenueId id = static_cast<VenueId>(venues.size());
+    venues.push_back(&venue);
+    for (uint32_t instrument = 0; instrument < tickers.size(); ++instrument) {
+        bind(instrument, id);
+    }
+    return id;
+}
+
+/**
+ * @brief Starts consolidating an instrument on every venue that lists it. Tracking a ticker again
+ *        returns the existing ID and binds the venues that have listed it since.
+ * @return The consolidator's own ID for the instrument.
+ * @throws std::invalid_argument if two venues quote the instrument in different ticks.
+ */
+InstrumentId BboConsolidator::track(const std::string& ticker) {
+    auto [it, inserted] = tickerIds.emplace(ticker, InstrumentId{static_cast<uint32_t>(tickers.size())});
+    if (inserted) {
+        tickers.push_back(ticker);
+        ticksPerUnit.push_back(0);
+        const size_t rows = tickers.size() * maxVenues;
+        quotes.resize(rows);
+        slots.resize(rows, nullptr);
+        versions.resize(rows, 0);
+        heaps.resize(2 * rows, HeapEntry{0, NO_VENUE});
+        positions.resize(2 * rows, NOT_QUEUED);
+        heapSizes.resize(2 * tickers.size(), 0);
+    }
+    for (VenueId venue = 0; venue < venues.size(); ++venue) {
+        bind(it->second.value, venue);
+    }
+    return it->second;
+}
+
+/**
+ * @brief Looks up the consolidator's ID for a ticker.
+ */
+std::optional<InstrumentId> BboConsolidator::findInstrument(const std::string& ticker) const {
+    auto it = tickerIds.find(ticker);
+    if (it != tickerIds.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Folds a venue's new top of book into the instrument's consolidated quote in O(log venues).
+ *        A side quoted at NO_PRICE takes the venue out of that side's heap.
+ * @throws std::invalid_argument if the instrument or venue is unknown.
+ */
+void BboConsolidator::update(InstrumentId instrument, VenueId venue, const TopOfBook& top) {
+    checkIds(instrument, venue);
+    prefetchRow(instrument.value, venue);
+    reposition<Side::Buy>(instrument.value, venue, top);
+    reposition<Side::Sell>(instrument.value, venue, top);
+    quotes[size_t{instrument.value} * maxVenues + venue] = top;
+}
+
+/**
+ * @brief Reads every bound venue slot whose version moved since it was last read, and folds in
+ *        the quotes that changed. A slot caught mid-publish is picked up by the next poll.
+ * @return Number of quotes that changed.
+ */
+size_t BboConsolidator::poll() {
+    size_t changed = 0;
+    const size_t venueCount = venues.size();
+    for (uint32_t instrument = 0; instrument < tickers.size(); ++instrument) {
+        const size_t row = size_t{instrument} * maxVenues;
+        for (VenueId venue = 0; venue < venueCount; ++venue) {
+            const TopOfBookSlot* slot = slots[row + venue];
+            if (!slot) {
+                continue;
+            }
+            const uint64_t version = slot->getVersion();
+            TopOfBook top;
+            if (version == versions[row + venue] || !slot->tryRead(top)) {
+                continue;
+            }
+            versions[row + venue] = version;
+            if (top != quotes[row + venue]) {
+                prefetchRow(instrument, venue);
+                reposition<Side::Buy>(instrument, venue, top);
+                reposition<Side::Sell>(instrument, venue, top);
+                quotes[row + venue] = top;
+                ++changed;
+            }
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Returns the best bid and offer of an instrument across all venues.
+ * @throws std::invalid_argument if the instrument is unknown.
+ */
+ConsolidatedQuote BboConsolidator::getBest(InstrumentId instrument) const {
+    checkInstrument(instrument);
+    const size_t block = size_t{instrument.value} * 2 * maxVenues;
+    ConsolidatedQuote best;
+    if (heapSizes[size_t{instrument.value} * 2] > 0) {
+        const HeapEntry& bid = heaps[block];
+        best.bidPrice = static_cast<Price>(bid.key >> 32);
+        best.bidVolume = static_cast<int32_t>(bid.key & UINT32_MAX);
+        best.bidVenue = bid.venue;
+    }
+    if (heapSizes[size_t{instrument.value} * 2 + 1] > 0) {
+        const HeapEntry& ask = heaps[block + maxVenues];
+        best.askPrice = INT32_MAX - static_cast<Price>(ask.key >> 32);
+        best.askVolume = static_cast<int32_t>(ask.key & UINT32_MAX);
+        best.askVenue = ask.venue;
+    }
+    return best;
+}
+
+/**
+ * @brief Returns the last top of book the consolidator holds for an instrument on one venue.
+ * @throws std::invalid_argument if the instrument or venue is unknown.
+ */
+const TopOfBook& BboConsolidator::getQuote(InstrumentId instrument, VenueId venue) const {
+    checkIds(instrument, venue);
+    return quotes[size_t{instrument.value} * maxVenues + venue];
+}
+
+/**
+ * @brief Returns the number of venues added.
+ */
+size_t BboConsolidator::getVenueCount() const {
+    return venues.size();
+}
+
+/**
+ * @brief Returns the number of instruments tracked.
+ */
+size_t BboConsolidator::getInstrumentCount() const {
+    return tickers.size();
+}
+
+/**
+ * @brief Points an (instrument, venue) entry at the venue's top of book slot, if the venue lists
+ *        the instrument and the entry is not bound yet.
+ * @throws std::invalid_argument if the venue's tick size differs from the other venues'.
+ */
+void BboConsolidator::bind(uint32_t instrument, VenueId venue) {
+    const size_t entry = size_t{instrument} * maxVenues + venue;
+    if (slots[entry]) {
+        return;
+    }
+    const Exchange& exchange = *venues[venue];
+    const std::optional<InstrumentId> listed = exchange.findInstrument(tickers[instrument]);
+    if (!listed || !exchange.getOrderBook(*listed)) {
+        return;
+    }
+    const int32_t ticks = exchange.getTickScale(*listed).getTicksPerUnit();
+    if (ticksPerUnit[instrument] == 0) {
+        ticksPerUnit[instrument] = ticks;
+    } else if (ticksPerUnit[instrument] != ticks) {
+        throw std::invalid_argument("Venues quote " + tickers[instrument] + " in different ticks.");
+    }
+    slots[entry] = &exchange.getTopOfBook(*listed);
+}
+
+/**
+ * @brief Validates an instrument ID on the public API.
+ * @throws std::invalid_argument if the instrument is not tracked.
+ */
+void BboConsolidator::checkInstrument(InstrumentId instrument) const {
+    if (instrument.value >= tickers.size()) {
+        throw std::invalid_argument("Instrument is not covered by the consolidator.");
+    }
+}
+
+/**
+ * @brief Validates an instrument and venue ID on the public API.
+ * @throws std::invalid_argument if the instrument is not tracked or the venue was never added.
+ */
+void BboConsolidator::checkIds(InstrumentId instrument, VenueId venue) const {
+    checkInstrument(instrument);
+    if (venue >= venues.size()) {
+        throw std::invalid_argument("Venue is not covered by the consolidator.");
+    }
+}
+
+/**
+ * @brief Starts loading the lines an update of one venue's quote touches: the venue's heap
+ *        positions, the roots of both heaps and the heap sizes. A sift then waits for these
+ *        misses together rather than one after another.
+ */
+void BboConsolidator::prefetchRow(uint32_t instrument, VenueId venue) const {
+    const size_t block = size_t{instrument} * 2 * maxVenues;
+    __builtin_prefetch(&positions[block + venue], 1);
+    __builtin_prefetch(&positions[block + maxVenues + venue], 1);
+    __builtin_prefetch(&heaps[block], 1);
+    __builtin_prefetch(&heaps[block + maxVenues], 1);
+    __builtin_prefetch(&heapSizes[size_t{instrument} * 2], 1);
+    __builtin_prefetch(&quotes[size_t{instrument} * maxVenues + venue], 1);
+}
+
+/**
+ * @brief Restores one side's heap after a venue's quote changed: inserts, removes or re-keys and
+ *        sifts the venue, depending on whether it quotes the side now and did before.
+ */
+template<Side S>
+void BboConsolidator::reposition(uint32_t instrument, VenueId venue, const TopOfBook& top) {
+    const size_t base = (size_t{instrument} * 2 + static_cast<size_t>(S)) * maxVenues;
+    HeapEntry* heap = &heaps[base];
+    uint16_t* position = &positions[base];
+    uint16_t& size = heapSizes[size_t{instrument} * 2 + static_cast<size_t>(S)];
+    const bool quoted = (S == Side::Buy ? top.bidPrice : top.askPrice) != NO_PRICE;
+    const uint16_t at = position[venue];
+
+    if (at == NOT_QUEUED) {
+        if (quoted) {
+            heap[size] = HeapEntry{keyOf<S>(top), venue};
+            siftUp(heap, position, size++);
+        }
+        return;
+    }
+    if (!quoted) {
+        position[venue] = NOT_QUEUED;
+        if (at == --size) {
+            return;
+        }
+        heap[at] = heap[size];
+    } else {
+        const uint64_t key = keyOf<S>(top);
+        if (key == heap[at].key) {
+            return;
+        }
+        heap[at].key = key;
+    }
+    siftDown(heap, position, siftUp(heap, position, at), size);
+}
+
+/**
+ * @brief Orders two heap entries: better price first, then larger size, then lower venue ID.
+ */
+bool BboConsolidator::better(const HeapEntry& a, const HeapEntry& b) {
+    return a.key != b.key ? a.key > b.key : a.venue < b.venue;
+}
+
+/**
+ * @brief Moves the entry at a heap position towards the root while it beats its parent.
+ * @return The entry's final position.
+ */
+uint16_t BboConsolidator::siftUp(HeapEntry* heap, uint16_t* position, uint16_t at) {
+    const HeapEntry entry = heap[at];
+    while (at > 0) {
+        const uint16_t parent = static_cast<uint16_t>((at - 1) / 2);
+        if (!better(entry, heap[parent])) {
+            break;
+        }
+        heap[at] = heap[parent];
+        position[heap[at].venue] = at;
+        at = parent;
+    }
+    heap[at] = entry;
+    position[entry.venue] = at;
+    return at;
+}
+
+/**
+ * @brief Moves the entry at a heap position towards the leaves while a child beats it.
+ */
+void BboConsolidator::siftDown(HeapEntry* heap, uint16_t* position, uint16_t at, uint16_t size) {
+    const HeapEntry entry = heap[at];
+    for (;;) {
+        uint32_t child = 2u * at + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && better(heap[child + 1], heap[child])) {
+            ++child;
+        }
+        if (!better(heap[child], entry)) {
+            break;
+        }
+        heap[at] = heap[child];
+        position[heap[at].venue] = at;
+        at = static_cast<uint16_t>(child);
+    }
+    heap[at] = entry;
+    position[entry.venue] = at;
+}
@@ -0,0 +1,129 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Exchange.hpp"
+#include "InstrumentId.h"
+#include "Price.h"
+#include "Side.hpp"
+#include "TopOfBook.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Index of a venue in a BboConsolidator, in the order the venues were added.
+using VenueId = uint16_t;
+constexpr VenueId NO_VENUE = UINT16_MAX;
+
+/**
+ * @struct ConsolidatedQuote
+ * @brief Best bid and offer of one instrument across all venues, each attributed to the venue quoting it.
+ */
+struct ConsolidatedQuote {
+    Price bidPrice = NO_PRICE;  ///< highest bid on any venue, or NO_PRICE if none
+    int32_t bidVolume = 0;      ///< resting shares at that price on the attributed venue
+    VenueId bidVenue = NO_VENUE;
+    Price askPrice = NO_PRICE;  ///< lowest offer on any venue, or NO_PRICE if none
+    int32_t askVolume = 0;      ///< resting shares at that price on the attributed venue
+    VenueId askVenue = NO_VENUE;
+};
+
+/**
+ * @class BboConsolidator
+ * @brief Maintains the best bid and offer of each instrument across several Exchange instances.
+ *
+ * Every instrument keeps one quote per venue and, per side, an indexed binary heap of the
+ * venues currently quoting that side, so a venue's new top of book is folded in with
+ * O(log venues) sifts instead of a rescan. Ties on price go to the larger size, then to the
+ * venue added first. All per-instrument state lives in flat rows of maxVenues entries,
+ * which keeps tens of thousands of instruments in a few contiguous arrays.
+ *
+ * Quotes arrive either through update(), or through poll(), which reads the TopOfBookSlot of
+ * every tracked (instrument, venue) pair whose version moved. The consolidator is used from one
+ * thread; the venues may keep matching on their own threads while it polls, but addVenue() and
+ * track() read the venues' instrument tables, so no venue may list or remove instruments meanwhile.
+ */
+class BboConsolidator {
+public:
+    explicit BboConsolidator(size_t maxVenues);
+
+    VenueId addVenue(const Exchange& venue);
+    InstrumentId track(const std::string& ticker);
+    std::optional<InstrumentId> findInstrument(const std::string& ticker) const;
+
+    void update(InstrumentId instrument, VenueId venue, const TopOfBook& top);
+    size_t poll();
+
+    ConsolidatedQuote getBest(InstrumentId instrument) const;
+    const TopOfBook& getQuote(InstrumentId instrument, VenueId venue) const;
+    size_t getVenueCount() const;
+    size_t getInstrumentCount() const;
+
+    // disable copying
+    BboConsolidator(const BboConsolidator&) = delete;
+    BboConsolidator& operator=(const BboConsolidator&) = delete;
+
+private:
+    static constexpr uint16_t NOT_QUEUED = UINT16_MAX;
+
+    /// A venue quoting one side, ordered by a key that packs the price (made larger-is-better on
+    /// both sides) above the size, so sifting never has to look up the venues' quotes.
+    struct HeapEntry {
+        uint64_t key;
+        VenueId venue;
+    };
+
+    size_t maxVenues;
+    /// the venues, indexed by VenueId
+    std::vector<const Exchange*> venues;
+    /// consolidated IDs by ticker, and the tick size every venue must quote each instrument in
+    std::unordered_map<std::string, InstrumentId> tickerIds;
+    std::vector<std::string> tickers;
+    std::vector<int32_t> ticksPerUnit;
+
+    // rows of maxVenues entries per instrument, indexed by instrument * maxVenues + venue
+    std::vector<TopOfBook> quotes;
+    std::vector<const TopOfBookSlot*> slots;    // nullptr where the venue does not list the instrument
+    std::vector<uint64_t> versions;             // slot version the quote was last read at
+
+    // rows of 2 * maxVenues entries per instrument, bids then asks, so one update stays within
+    // a block; heaps are indexed by heap position, best first, and positions by venue
+    std::vector<HeapEntry> heaps;
+    std::vector<uint16_t> positions;            // heap position of each venue, or NOT_QUEUED
+    std::vector<uint16_t> heapSizes;            // indexed by instrument * 2 + side
+
+    void bind(uint32_t instrument, VenueId venue);
+    void checkInstrument(InstrumentId instrument) const;
+    void checkIds(InstrumentId instrument, VenueId venue) const;
+    void prefetchRow(uint32_t instrument, VenueId venue) const;
+    template<Side S>
+    void reposition(uint32_t instrument, VenueId venue, const TopOfBook& top);
+    static bool better(const HeapEntry& a, const HeapEntry& b);
+    uint16_t siftUp(HeapEntry* heap, uint16_t* position, uint16_t at);
+    void siftDown(HeapEntry* heap, uint16_t* position, uint16_t at, uint16_t size);
+};
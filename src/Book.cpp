@@ -1,80 +1,552 @@
 #include "Book.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/// On-disk form of a resting order; its side and price come from the enclosing level.
+struct SnapshotOrder {
+    int64_t orderId;
+    Timestamp entryTime;
+    Timestamp eventTime;
+    int32_t shares;
+    ParticipantId participant;
+    uint16_t reserved;
+};
+static_assert(sizeof(SnapshotOrder) == 32, "Snapshot orders are packed into 32 bytes");
+
+/// On-disk form of a parked stop order.
+struct SnapshotStop {
+    int64_t orderId;
+    Timestamp entryTime;
+    Timestamp eventTime;
+    int32_t shares;
+    Price stopPrice;
+    Price limit; // NO_PRICE for a stop market order
+    Side side;
+    OrderType type;
+    ParticipantId participant;
+};
+static_assert(sizeof(SnapshotStop) == 40, "Snapshot stops are packed into 40 bytes");
+
+/// Levels whose queues are walked side by side while capturing, so their cache misses overlap.
+constexpr size_t SNAPSHOT_WALK_WIDTH = 8;
+/// How many records ahead of the one being restored to prefetch the order table slot for.
+constexpr uint32_t SNAPSHOT_PREFETCH_DISTANCE = 16;
+
+} // namespace
+
+/**
+ * @brief Constructs an empty order book whose sides publish level changes to its depth update buffer.
+ *
+ * @param matchingPolicy How each price level shares incoming quantity among its orders; FIFO by default.
+ *
+ * @throws std::invalid_argument if the top order percentage is outside [0, 100].
+ */
+Book::Book(MatchingPolicy matchingPolicy)
+    : clock(&defaultClock),
+      matchingPolicy(matchingPolicy),
+      proRata{matchingPolicy.rounding,
+              matchingPolicy.algorithm == MatchingAlgorithm::TopOrderProRata ? matchingPolicy.topOrderPercent : 0},
+      lastTradePrice(NO_PRICE),
+      tradeHigh(-1),
+      tradeLow(TriggerBook::MAX_PRICE + 1),
+      releasingStops(false),
+      openMessages(0)
+{
+    if (matchingPolicy.topOrderPercent < 0 || matchingPolicy.topOrderPercent > 100) {
+        throw std::invalid_argument("Top order percentage must be between 0 and 100.");
+    }
+    if (matchingPolicy.selfTradePrevention > SelfTradePrevention::DecrementAndCancel) {
+        throw std::invalid_argument("Unknown self-trade prevention mode.");
+    }
+    sellSide.setDepthUpdates(&depthUpdates);
+    buySide.setDepthUpdates(&depthUpdates);
+    sellSide.setLatencyStats(&latencyStats);
+    buySide.setLatencyStats(&latencyStats);
+}
 
 /**
- * @brief Default constructor for Book.
- *        Initializes an empty order book.
+ * @brief Adds an order to the book, drawing its ID from a sequence.
+ *
+ * The ID is only consumed once the order has passed validation.
+ *
+ * @param side Side of the order (Buy or Sell).
+ * @param shares Number of shares.
+ * @param limit Limit price in ticks (ignored for market orders).
+ * @param type Order type (Limit or Market).
+ * @param idSeq Reference to order ID sequence generator.
+ * @param timeInForce What happens to the part of the order that does not trade on arrival.
+ * @param participant Owner of the order, for mass cancels; NO_PARTICIPANT by default.
+ * @return The assigned ID, the shares traded on entry and whether the order filled, rests or expired.
+ *
+ * @throws std::invalid_argument if shares <= 0, the limit price is outside the book's range or
+ *         the time in force does not apply to the order type.
+ * @throws std::runtime_error if a good-till-cancel market order exceeds the available liquidity.
  */
-Book::Book() = default;
+OrderResult Book::addOrderToBook(Side side, int shares, Price limit, OrderType type, OrderIdSequence& idSeq,
+                                 TimeInForce timeInForce, ParticipantId participant) {
+    validateOrder(shares, limit, type, timeInForce);
+    return addOrderToBook(side, shares, limit, type, idSeq.getNextId(), timeInForce, participant);
+}
 
 /**
- * @brief Adds an order to the book, potentially executing against opposite orders.
+ * @brief Adds an order with a caller-assigned ID to the book, potentially executing against opposite orders.
  *
  * If the order is a market order, it is executed immediately against the opposite side.
  * If it's a limit order, any crossing volume is matched first, then any unfilled remainder is added as a limit order.
+ * The order ID is assigned on entry so that every execution can name its aggressor.
  *
  * @param side Side of the order (Buy or Sell).
  * @param shares Number of shares.
- * @param limit Limit price (ignored for market orders).
+ * @param limit Limit price in ticks (ignored for market orders).
  * @param type Order type (Limit or Market).
- * @param idSeq Reference to order ID sequence generator.
+ * @param orderId Unique order ID for this order.
+ * @param timeInForce What happens to the part of the order that does not trade on arrival.
+ * @param participant Owner of the order, for mass cancels; NO_PARTICIPANT by default.
+ * @return The shares traded on entry and whether the order filled, rests or expired.
  *
- * @throws std::invalid_argument if shares <= 0.
+ * @throws std::invalid_argument if shares <= 0, the limit price is outside the book's range or
+ *         the time in force does not apply to the order type.
+ * @throws std::runtime_error if a good-till-cancel market order exceeds the available liquidity.
  */
-void Book::addOrderToBook(Side side, int shares, float limit, OrderType type, OrderIdSequence& idSeq) {
-    if (shares <= 0) {
-        throw std::invalid_argument("Order size must be positive.");
+OrderResult Book::addOrderToBook(Side side, int shares, Price limit, OrderType type, int64_t orderId,
+                                 TimeInForce timeInForce, ParticipantId participant) {
+    LatencyTimer timer(latencyStats, LatencyOp::AddOrder);
+    validateOrder(shares, limit, type, timeInForce);
+    Clock::Message stamp(*clock);
+    Message message(*this);
+    const OrderResult result = enterOrder(side, shares, limit, type, orderId, stamp.time(), timeInForce, participant);
+    if (result.status == OrderStatus::RejectedNoLiquidity) {
+        throw std::runtime_error("Market order volume exceeds available liquidity.");
     }
-    const int price = (type == OrderType::Limit) ? static_cast<int>(std::round(limit * 100)) : -1;
+    return result;
+}
 
-    if (type == OrderType::Market) {
-        // Market order: execute immediately
-        if (side == Side::Buy) {
-            sellSide.executeMarket(shares);
-        } else {
-            buySide.executeMarket(shares);
+/**
+ * @brief Adds a burst of new orders, with the same matching outcome as submitting them one by one.
+ *
+ * Every request is validated up front in one pass, and the whole batch is one message to the
+ * clock, so every order in it shares one entry timestamp.
+ * While an order is being matched, the cache lines later orders will touch if they rest are
+ * prefetched in two stages: first the Limit level, then (once that has arrived) the order at the
+ * tail of its queue and the order table slot for its ID. Nothing throws for a bad order: each one
+ * gets its own result, and rejected orders do not consume an ID.
+ *
+ * @param requests The orders, in arrival order.
+ * @param results One result per request, written in the same order.
+ * @param idSeq Order ID generator.
+ * @return Number of requests processed.
+ *
+ * @throws std::invalid_argument if results is shorter than requests.
+ */
+size_t Book::submitBatch(std::span<const OrderRequest> requests, std::span<OrderResult> results, OrderIdSequence& idSeq) {
+    if (results.size() < requests.size()) {
+        throw std::invalid_argument("Result span is smaller than the batch.");
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const OrderRequest& request = requests[i];
+        OrderStatus rejection;
+        results[i] = {-1, 0, OrderStatus::Resting};
+        if (!checkOrder(request.shares, request.limit, request.type, request.timeInForce, rejection)) {
+            results[i].status = rejection;
         }
-        return;
     }
 
-    // Limit order: try to cross first
-    while (shares > 0) {
-        Limit* bestOpposite = (side == Side::Buy) ? sellSide.getBestLimit() : buySide.getBestLimit();
+    Clock::Message stamp(*clock);
+    const Timestamp entryTime = stamp.time();
+    // only accepted requests draw an ID, so the predicted ID skips the rejected ones
+    int64_t prefetchId = idSeq.peekNextId();
+    auto prefetchAhead = [&](size_t j) {
+        prefetchEntry(requests[j], results[j].status, prefetchId);
+        if (results[j].status == OrderStatus::Resting) {
+            ++prefetchId;
+        }
+    };
+    for (size_t i = 0; i < std::min(2 * BATCH_PREFETCH_DISTANCE, requests.size()); ++i) {
+        prefetchLevel(requests[i], results[i].status);
+    }
+    for (size_t i = 0; i < std::min(BATCH_PREFETCH_DISTANCE, requests.size()); ++i) {
+        prefetchAhead(i);
+    }
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (i + 2 * BATCH_PREFETCH_DISTANCE < requests.size()) {
+            const size_t j = i + 2 * BATCH_PREFETCH_DISTANCE;
+            prefetchLevel(requests[j], results[j].status);
+        }
+        if (i + BATCH_PREFETCH_DISTANCE < requests.size()) {
+            prefetchAhead(i + BATCH_PREFETCH_DISTANCE);
+        }
+        if (results[i].status != OrderStatus::Resting) {
+            continue;
+        }
+        const OrderRequest& request = requests[i];
+        LatencyTimer timer(latencyStats, LatencyOp::AddOrder);
+        Message message(*this);
+        results[i] = enterOrder(request.side, request.shares, request.limit, request.type, idSeq.getNextId(), entryTime,
+                                request.timeInForce, request.participant);
+    }
+    return requests.size();
+}
 
-        if (!bestOpposite)
-            break;
+/**
+ * @brief Adds a stop or stop-limit order, drawing its ID from a sequence.
+ *
+ * @param side Side of the order (Buy or Sell).
+ * @param shares Number of shares.
+ * @param stopPrice Trigger price in ticks.
+ * @param limit Limit price in ticks once triggered, or NO_PRICE for a stop market order.
+ * @param idSeq Reference to order ID sequence generator.
+ * @param participant Owner of the order, for mass cancels; NO_PARTICIPANT by default.
+ * @return The assigned ID and whether the order was parked or, already triggered, traded.
+ *
+ * @throws std::invalid_argument if shares <= 0 or a price is outside the book's range.
+ */
+OrderResult Book::addStopOrder(Side side, int shares, Price stopPrice, Price limit, OrderIdSequence& idSeq,
+                               ParticipantId participant) {
+    validateStopOrder(shares, stopPrice, limit);
+    return addStopOrder(side, shares, stopPrice, limit, idSeq.getNextId(), participant);
+}
 
-        int bestOppositePrice = bestOpposite->getLimitPrice();
+/**
+ * @brief Adds a stop or stop-limit order with a caller-assigned ID.
+ *
+ * A buy stop triggers when a trade prints at or above its stop price, a sell stop at or below
+ * it. Until then the order is parked in the book's TriggerBook, invisible to matching and depth.
+ * Once triggered, a stop market order is entered as immediate-or-cancel and a stop-limit order
+ * as a good-till-cancel limit order, under the same ID. An order whose stop price the last
+ * trade has already reached is entered straight away.
+ *
+ * @param side Side of the order (Buy or Sell).
+ * @param shares Number of shares.
+ * @param stopPrice Trigger price in ticks.
+ * @param limit Limit price in ticks once triggered, or NO_PRICE for a stop market order.
+ * @param orderId Unique order ID for this order.
+ * @param participant Owner of the order, for mass cancels; NO_PARTICIPANT by default.
+ * @return StopPending if the order was parked, otherwise the result of entering it. The handle of a
+ *         parked stop stops resolving once the stop triggers; the triggered order keeps the ID.
+ *
+ * @throws std::invalid_argument if shares <= 0 or a price is outside the book's range.
+ */
+OrderResult Book::addStopOrder(Side side, int shares, Price stopPrice, Price limit, int64_t orderId,
+                               ParticipantId participant) {
+    LatencyTimer timer(latencyStats, LatencyOp::AddOrder);
+    validateStopOrder(shares, stopPrice, limit);
+    Clock::Message stamp(*clock);
+    Message message(*this);
+
+    const bool triggered = lastTradePrice != NO_PRICE
+                        && (side == Side::Buy ? stopPrice <= lastTradePrice : stopPrice >= lastTradePrice);
+    if (triggered) {
+        return limit == NO_PRICE
+            ? enterOrder(side, shares, NO_PRICE, OrderType::Market, orderId, stamp.time(), TimeInForce::ImmediateOrCancel,
+                         participant)
+            : enterOrder(side, shares, limit, OrderType::Limit, orderId, stamp.time(), TimeInForce::GoodTillCancel,
+                         participant);
+    }
+
+    if (!stops) {
+        stops = std::make_unique<TriggerBook>();
+    }
+    const OrderType type = limit == NO_PRICE ? OrderType::Stop : OrderType::StopLimit;
+    Order* order = orderPool.create(side, shares, limit, type, nullptr, orderId, stamp.time(), participant);
+    stops->add(order, stopPrice);
+    allOrders.insert(orderId, order);
+    if (participant != NO_PARTICIPANT) {
+        participants.add(order);
+    }
+    return {orderId, 0, OrderStatus::StopPending, orderPool.handleOf(order)};
+}
 
-        bool crosses =
-            (side == Side::Buy && price >= bestOppositePrice) ||
-            (side == Side::Sell && price <= bestOppositePrice);
+/**
+ * @brief Matches a validated order and rests any limit remainder, in one pass for every time in force.
+ *
+ * Post-only orders cost one compare against the opposite best price before anything else. A
+ * fill-or-kill order sums the crossing level volumes from the bitmap before touching any order,
+ * so a killed order leaves the book exactly as it was. An immediate-or-cancel remainder is
+ * dropped before an Order is ever drawn from the pool. Never throws; every outcome is a status.
+ *
+ * Self-trade prevention acts while the order sweeps, so a fill-or-kill order counts its owner's
+ * resting volume as available and may still end CancelledSelfTrade with part of it traded.
+ *
+ * @param side Side of the order (Buy or Sell).
+ * @param shares Number of shares.
+ * @param price Limit price in ticks (ignored for market orders).
+ * @param type Order type (Limit or Market).
+ * @param orderId Unique order ID for this order.
+ * @param entryTime Entry time (ns) given to the order if it rests.
+ * @param timeInForce What happens to the part of the order that does not trade on arrival.
+ * @param participant Owner of the order.
+ * @return The order's result.
+ */
+OrderResult Book::enterOrder(Side side, int shares, Price price, OrderType type, int64_t orderId, Timestamp entryTime,
+                             TimeInForce timeInForce, ParticipantId participant) {
+    if (type == OrderType::Market) {
+        return enterMarketOrder(side, shares, orderId, timeInForce, participant);
+    }
 
-        if (!crosses)
+    switch (timeInForce) {
+        case TimeInForce::PostOnly:
+        case TimeInForce::PostOnlyReprice: {
+            const Price bestOppositePrice = (side == Side::Buy) ? sellSide.getBestPrice() : buySide.getBestPrice();
+            const bool crosses = (side == Side::Buy) ? price >= bestOppositePrice : price <= bestOppositePrice;
+            if (!crosses)
+                break;
+            if (timeInForce == TimeInForce::PostOnly)
+                return {orderId, 0, OrderStatus::RejectedWouldCross};
+            price = (side == Side::Buy) ? bestOppositePrice - 1 : bestOppositePrice + 1;
+            if (price <= 0 || price > LOBSide<Side::Buy>::MAX_PRICE)
+                return {orderId, 0, OrderStatus::RejectedWouldCross};
             break;
+        }
+        case TimeInForce::FillOrKill: {
+            const int32_t available = (side == Side::Buy) ? sellSide.getVolumeThrough(price, shares)
+                                                          : buySide.getVolumeThrough(price, shares);
+            if (available < shares)
+                return {orderId, 0, OrderStatus::Expired};
+            break;
+        }
+        default:
+            break;
+    }
 
-        int volToExec = std::min(shares, bestOpposite->getTotalVolume());
-        shares -= volToExec;
+    // Limit order: try to cross first
+    SelfTradeCheck selfTrade{participant, matchingPolicy.selfTradePrevention};
+    const int filled = crossOrder(side, shares, price, orderId, selfTrade);
+
+    // Place remainder as limit order, unless it expires
+    OrderHandle handle;
+    if (shares > 0 && timeInForce != TimeInForce::ImmediateOrCancel) {
+        Order* order = orderPool.create(side, shares, price, type, nullptr, orderId, entryTime, participant);
 
         if (side == Side::Buy) {
-            sellSide.executeMatching(volToExec);
+            buySide.addOrder(price, order);
         } else {
-            buySide.executeMatching(volToExec);
+            sellSide.addOrder(price, order);
         }
+
+        allOrders.insert(order->getOrderId(), order);
+        if (participant != NO_PARTICIPANT) {
+            participants.add(order);
+        }
+        handle = orderPool.handleOf(order);
     }
 
-    // Place remainder as limit order
-    if (shares > 0) {
-        auto order = std::make_unique<Order>(side, shares, limit, type, nullptr, idSeq);
-        Order* orderPtr = order.get();
+    releaseStops();
+    return {orderId, filled, entryStatus(shares, filled, timeInForce, selfTrade), handle};
+}
 
+/**
+ * @brief Matches an incoming limit order against the opposite side, through every level it crosses.
+ *
+ * @param side Side of the incoming order.
+ * @param shares The order's open shares; reduced by every fill and by self-trade decrements.
+ * @param price Limit price in ticks.
+ * @param orderId ID reported as the aggressor in executions.
+ * @param selfTrade The order's self-trade check; records what prevention did to the order.
+ * @return Shares traded.
+ */
+int Book::crossOrder(Side side, int& shares, Price price, int64_t orderId, SelfTradeCheck& selfTrade) {
+    const bool crosses = (side == Side::Buy) ? price >= sellSide.getBestPrice() : price <= buySide.getBestPrice();
+    if (!crosses) {
+        return 0;
+    }
+
+    LatencyTimer timer(latencyStats, LatencyOp::MatchSweep);
+    int aggressorLeaves = shares;
+    auto onFill = [&](Order* resting, int32_t quantity) {
+        aggressorLeaves -= quantity;
+        recordFill(orderId, side, resting, quantity, aggressorLeaves - selfTrade.decremented);
+    };
+    auto onSelfTrade = [&](Order* resting) { releaseOrder(resting); };
+    const int originalShares = shares;
+    withMatching(selfTrade, [&](const auto& policy, auto& check) {
         if (side == Side::Buy) {
-            buySide.addOrder(price, orderPtr);
+            sellSide.sweep(shares, price, policy, check, onFill, onSelfTrade);
         } else {
-            sellSide.addOrder(price, orderPtr);
+            buySide.sweep(shares, price, policy, check, onFill, onSelfTrade);
+        }
+    });
+    return originalShares - aggressorLeaves;
+}
+
+/**
+ * @brief Derives the status of an order that has been matched on entry.
+ *
+ * @param remaining Shares left open after matching.
+ * @param filled Shares traded.
+ * @param timeInForce The order's time in force.
+ * @param selfTrade What self-trade prevention did to the order.
+ * @return The order's status.
+ */
+OrderStatus Book::entryStatus(int remaining, int filled, TimeInForce timeInForce, const SelfTradeCheck& selfTrade) {
+    if (selfTrade.aggressorCancelled || (remaining == 0 && selfTrade.decremented > 0)) {
+        return OrderStatus::CancelledSelfTrade;
+    }
+    if (remaining == 0) {
+        return OrderStatus::Filled;
+    }
+    if (timeInForce == TimeInForce::ImmediateOrCancel) {
+        return OrderStatus::Expired;
+    }
+    return filled > 0 ? OrderStatus::PartiallyFilled : OrderStatus::Resting;
+}
+
+/**
+ * @brief Executes a validated market order against the opposite side.
+ *
+ * A good-till-cancel market order larger than the opposite side is rejected without touching
+ * the book. An immediate-or-cancel one takes whatever is there and expires; a fill-or-kill one
+ * expires untouched.
+ *
+ * @param side Side of the order (Buy or Sell).
+ * @param shares Number of shares.
+ * @param orderId Unique order ID for this order.
+ * @param timeInForce GoodTillCancel, ImmediateOrCancel or FillOrKill.
+ * @param participant Owner of the order, for self-trade prevention.
+ * @return The order's result; CancelledSelfTrade if self-trade prevention kept it from filling.
+ */
+OrderResult Book::enterMarketOrder(Side side, int shares, int64_t orderId, TimeInForce timeInForce,
+                                   ParticipantId participant) {
+    const int32_t available = (side == Side::Buy) ? sellSide.getTotalVolume() : buySide.getTotalVolume();
+    if (shares <= available) {
+        const int filled = placeMarketOrder(shares, side, orderId, participant);
+        return {orderId, filled, filled == shares ? OrderStatus::Filled : OrderStatus::CancelledSelfTrade};
+    }
+    if (timeInForce == TimeInForce::GoodTillCancel) {
+        return {orderId, 0, OrderStatus::RejectedNoLiquidity};
+    }
+    if (timeInForce == TimeInForce::ImmediateOrCancel && available > 0) {
+        const int filled = placeMarketOrder(available, side, orderId, participant);
+        return {orderId, filled, filled == available ? OrderStatus::Expired : OrderStatus::CancelledSelfTrade};
+    }
+    return {orderId, 0, OrderStatus::Expired};
+}
+
+/**
+ * @brief First prefetch stage for an upcoming batch entry: the level it would rest at.
+ *
+ * @param request The upcoming order.
+ * @param status Its status after validation; Resting if it was accepted.
+ */
+void Book::prefetchLevel(const OrderRequest& request, OrderStatus status) const {
+    if (!mayRest(request, status)) {
+        return;
+    }
+    if (request.side == Side::Buy) {
+        buySide.prefetchLevel(request.limit);
+    } else {
+        sellSide.prefetchLevel(request.limit);
+    }
+}
+
+/**
+ * @brief Second prefetch stage for an upcoming batch entry: the tail order of its level and
+ *        the order table slot of the ID it is expected to receive.
+ *
+ * @param request The upcoming order.
+ * @param status Its status after validation; Resting if it was accepted.
+ * @param orderId The ID it is expected to receive.
+ */
+void Book::prefetchEntry(const OrderRequest& request, OrderStatus status, int64_t orderId) const {
+    if (!mayRest(request, status)) {
+        return;
+    }
+    if (request.side == Side::Buy) {
+        buySide.prefetchTail(request.limit);
+    } else {
+        sellSide.prefetchTail(request.limit);
+    }
+    allOrders.prefetch(orderId);
+}
+
+/**
+ * @brief Checks whether an upcoming batch entry could rest, so that prefetching its level is worthwhile.
+ *
+ * @param request The upcoming order.
+ * @param status Its status after the batch's validation pass, so it is not checked twice.
+ * @return True for an accepted limit order whose remainder is not dropped.
+ */
+bool Book::mayRest(const OrderRequest& request, OrderStatus status) {
+    return status == OrderStatus::Resting
+        && request.type == OrderType::Limit
+        && request.timeInForce != TimeInForce::ImmediateOrCancel
+        && request.timeInForce != TimeInForce::FillOrKill;
+}
+
+/**
+ * @brief Checks order parameters without throwing.
+ *
+ * @param shares Number of shares.
+ * @param limit Limit price in ticks (ignored for market orders).
+ * @param type Order type (Limit or Market).
+ * @param timeInForce Time in force; post-only applies to limit orders only.
+ * @param rejection Set to the reason when the order is rejected.
+ * @return True if the order may enter the book.
+ */
+bool Book::checkOrder(int shares, Price limit, OrderType type, TimeInForce timeInForce, OrderStatus& rejection) {
+    if (type != OrderType::Limit && type != OrderType::Market) {
+        rejection = OrderStatus::RejectedInvalidType;
+        return false;
+    }
+    if (shares <= 0) {
+        rejection = OrderStatus::RejectedInvalidSize;
+        return false;
+    }
+    if (type == OrderType::Limit && (limit <= 0 || limit > LOBSide<Side::Buy>::MAX_PRICE)) {
+        rejection = OrderStatus::RejectedInvalidPrice;
+        return false;
+    }
+    if (timeInForce > TimeInForce::PostOnlyReprice
+        || (type == OrderType::Market && timeInForce >= TimeInForce::PostOnly)) {
+        rejection = OrderStatus::RejectedInvalidTimeInForce;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks order parameters before anything touches the book.
+ *
+ * @param shares Number of shares.
+ * @param limit Limit price in ticks (ignored for market orders).
+ * @param type Order type (Limit or Market).
+ * @param timeInForce Time in force; post-only applies to limit orders only.
+ *
+ * @throws std::invalid_argument if shares <= 0, the limit price is outside the book's range or
+ *         the time in force does not apply to the order type.
+ */
+void Book::validateOrder(int shares, Price limit, OrderType type, TimeInForce timeInForce) {
+    OrderStatus rejection;
+    if (!checkOrder(shares, limit, type, timeInForce, rejection)) {
+        switch (rejection) {
+            case OrderStatus::RejectedInvalidSize:
+                throw std::invalid_argument("Order size must be positive.");
+            case OrderStatus::RejectedInvalidPrice:
+                throw std::invalid_argument("Incorrect limit price");
+            case OrderStatus::RejectedInvalidType:
+                throw std::invalid_argument("Stop orders must be entered with a stop price.");
+            default:
+                throw std::invalid_argument("Time in force does not apply to this order type.");
         }
+    }
+}
 
-        allOrders.emplace(orderPtr->getOrderId(), std::move(order));
+/**
+ * @brief Checks stop order parameters before anything touches the book.
+ *
+ * @param shares Number of shares.
+ * @param stopPrice Trigger price in ticks.
+ * @param limit Limit price in ticks once triggered, or NO_PRICE for a stop market order.
+ *
+ * @throws std::invalid_argument if shares <= 0 or a price is outside the book's range.
+ */
+void Book::validateStopOrder(int shares, Price stopPrice, Price limit) {
+    if (stopPrice <= 0 || stopPrice > TriggerBook::MAX_PRICE) {
+        throw std::invalid_argument("Incorrect stop price");
     }
+    validateOrder(shares, limit, limit == NO_PRICE ? OrderType::Market : OrderType::Limit, TimeInForce::GoodTillCancel);
 }
 
 /**
@@ -82,12 +554,56 @@ void Book::addOrderToBook(Side side, int shares, float limit, OrderType type, Or
  *
  * @param volume Number of shares to execute.
  * @param side Side of the market order.
+ * @param aggressorId Order ID reported as the aggressor in executions (-1 if none was assigned).
+ * @param participant Owner of the order, for self-trade prevention; NO_PARTICIPANT by default.
+ * @return Shares traded: the full volume unless self-trade prevention canceled part of it.
+ */
+int Book::placeMarketOrder(int volume, Side side, int64_t aggressorId, ParticipantId participant) {
+    LatencyTimer timer(latencyStats, LatencyOp::MarketSweep);
+    Clock::Message stamp(*clock);
+    Message message(*this);
+    int aggressorLeaves = volume;
+    SelfTradeCheck selfTrade{participant, matchingPolicy.selfTradePrevention};
+    auto onFill = [&](Order* resting, int32_t quantity) {
+        aggressorLeaves -= quantity;
+        recordFill(aggressorId, side, resting, quantity, aggressorLeaves - selfTrade.decremented);
+    };
+    auto onSelfTrade = [&](Order* resting) { releaseOrder(resting); };
+    withMatching(selfTrade, [&](const auto& policy, auto& check) {
+        if (side == Side::Buy) {
+            sellSide.executeMarket(volume, policy, check, onFill, onSelfTrade);
+        } else {
+            buySide.executeMarket(volume, policy, check, onFill, onSelfTrade);
+        }
+    });
+    releaseStops();
+    return volume - aggressorLeaves;
+}
+
+/**
+ * @brief Runs a matching step with the book's allocation policy and self-trade check as concrete
+ *        types, so each combination gets its own inlined matching loop: FIFO books never see
+ *        pro-rata code, and orders that cannot self-trade never see the owner comparison.
+ *
+ * @param selfTrade The incoming order's self-trade check; only used if the book prevents
+ *                  self-trades and the order has an owner.
+ * @param fn Called once as fn(policy, check) with a FifoMatching or ProRataMatching and a
+ *           NoSelfTradeCheck or SelfTradeCheck.
  */
-void Book::placeMarketOrder(int volume, Side side) {
-    if (side == Side::Buy) {
-        sellSide.executeMarket(volume);
+template<typename Fn>
+void Book::withMatching(SelfTradeCheck& selfTrade, Fn&& fn) {
+    auto run = [&](const auto& policy) {
+        if (selfTrade.owner != NO_PARTICIPANT && selfTrade.mode != SelfTradePrevention::None) {
+            fn(policy, selfTrade);
+        } else {
+            NoSelfTradeCheck none;
+            fn(policy, none);
+        }
+    };
+    if (matchingPolicy.algorithm == MatchingAlgorithm::Fifo) {
+        run(FifoMatching{});
     } else {
-        buySide.executeMarket(volume);
+        run(proRata);
     }
 }
 
@@ -101,12 +617,155 @@ void Book::placeMarketOrder(int volume, Side side) {
  * @throws std::invalid_argument if orderId is not found.
  */
 void Book::cancelOrder(int64_t orderId) {
-    auto it = allOrders.find(orderId);
-    if (it == allOrders.end()) {
+    LatencyTimer timer(latencyStats, LatencyOp::CancelOrder);
+    Order* order = allOrders.get(orderId);
+    if (!order) {
         throw std::invalid_argument("Order ID not found");
     }
+    Message message(*this);
+    removeOrder(order);
+}
+
+/**
+ * @brief Cancels a resting or parked order through its handle, without an ID lookup.
+ *
+ * @param handle The handle returned when the order was entered.
+ * @return Cancelled, or RejectedUnknownOrder if the order already filled or was canceled.
+ */
+OrderStatus Book::cancelOrder(OrderHandle handle) {
+    LatencyTimer timer(latencyStats, LatencyOp::CancelOrder);
+    Order* order = orderPool.resolve(handle);
+    if (!order) {
+        return OrderStatus::RejectedUnknownOrder;
+    }
+    Message message(*this);
+    removeOrder(order);
+    return OrderStatus::Cancelled;
+}
 
-    Order* order = it->second.get();
+/**
+ * @brief Cancels every resting and parked order of a participant.
+ *
+ * Walks the participant's own list rather than the book. Each order is unlinked from its level
+ * in O(1), emptied levels are cleared from the bitmap as they go, and each side's best price is
+ * recomputed once at the end instead of after every order. Each touched level is published once,
+ * with its final state, rather than once per order. The orders are scattered across the
+ * pool, so they are prefetched in two stages ahead of the one being removed: first the order,
+ * then (once that has arrived) its queue neighbours, which unlinking it writes to.
+ *
+ * @param participant The participant; NO_PARTICIPANT cancels nothing.
+ * @return Number of orders canceled.
+ */
+size_t Book::massCancel(ParticipantId participant) {
+    if (participant == NO_PARTICIPANT) {
+        return 0;
+    }
+    Message message(*this);
+    auto advance = [this](uint32_t slot) { return slot == ParticipantIndex::NONE ? slot : participants.next(slot); };
+    uint32_t slot = participants.first(participant);
+    uint32_t near = slot;
+    uint32_t far = slot;
+    for (size_t i = 0; i < 2 * MASS_CANCEL_PREFETCH_DISTANCE; ++i) {
+        if (far != ParticipantIndex::NONE) {
+            __builtin_prefetch(orderPool.at(far), 1);
+        }
+        far = advance(far);
+    }
+    for (size_t i = 0; i < MASS_CANCEL_PREFETCH_DISTANCE; ++i) {
+        near = advance(near);
+    }
+
+    // levels touched on each side, with a small direct-mapped filter so that a level is listed once
+    std::vector<int32_t> touched[2];
+    int32_t lastTouched[2][TOUCH_FILTER_SIZE];
+    std::fill(&lastTouched[0][0], &lastTouched[0][0] + 2 * TOUCH_FILTER_SIZE, -1);
+
+    size_t canceled = 0;
+    while (slot != ParticipantIndex::NONE) {
+        if (far != ParticipantIndex::NONE) {
+            __builtin_prefetch(orderPool.at(far), 1);
+            far = participants.next(far);
+        }
+        if (near != ParticipantIndex::NONE) {
+            const Order* ahead = orderPool.at(near);
+            __builtin_prefetch(ahead->getPrevOrder(), 1);
+            __builtin_prefetch(ahead->getNextOrder(), 1);
+            near = participants.next(near);
+        }
+
+        Order* order = orderPool.at(slot);
+        slot = participants.next(slot);
+        if (order->getOrderType() == OrderType::Stop || order->getOrderType() == OrderType::StopLimit) {
+            stops->remove(order);
+        } else {
+            const int side = order->getOrderSide() == Side::Buy ? 0 : 1;
+            const Price price = order->getLimit();
+            int32_t& seen = lastTouched[side][price & (TOUCH_FILTER_SIZE - 1)];
+            if (seen != price) {
+                seen = price;
+                touched[side].push_back(price);
+            }
+            if (side == 0) {
+                buySide.detachOrder(order);
+            } else {
+                sellSide.detachOrder(order);
+            }
+        }
+        releaseOrder(order);
+        ++canceled;
+    }
+    buySide.settleDetached(touched[0]);
+    sellSide.settleDetached(touched[1]);
+    return canceled;
+}
+
+/**
+ * @brief Cancels every order resting on one side of the book. Parked stops are kept.
+ *
+ * @param side The side to clear.
+ * @return Number of orders canceled.
+ */
+size_t Book::massCancel(Side side) {
+    return massCancel(side, LOBSide<Side::Buy>::MIN_PRICE, LOBSide<Side::Buy>::MAX_PRICE);
+}
+
+/**
+ * @brief Cancels every order resting on one side at prices in [low, high]. Parked stops are kept.
+ *
+ * Whole levels are handed over by the side in one pass: each queue is released without being
+ * unlinked order by order, and the bitmap and volumes are fixed per level rather than per order.
+ *
+ * @param side The side to clear.
+ * @param low Lowest price to cancel, in ticks.
+ * @param high Highest price to cancel, in ticks.
+ * @return Number of orders canceled; zero if low > high.
+ */
+size_t Book::massCancel(Side side, Price low, Price high) {
+    Message message(*this);
+    auto release = [this](Order* order) { releaseOrder(order); };
+    return side == Side::Buy ? buySide.removeRange(low, high, release) : sellSide.removeRange(low, high, release);
+}
+
+/**
+ * @brief Unlinks a resting order from its level and the order table and returns it to the pool.
+ *
+ * @param order The order to remove.
+ */
+void Book::removeOrder(Order* order) {
+    if (order->getOrderType() == OrderType::Stop || order->getOrderType() == OrderType::StopLimit) {
+        stops->remove(order);
+    } else {
+        unlinkOrder(order);
+    }
+    releaseOrder(order);
+}
+
+/**
+ * @brief Takes a resting order off its level, leaving it in the order table and the pool.
+ *
+ * @param order The resting order.
+ */
+void Book::unlinkOrder(Order* order) {
     int shares = order->getShares();
     int price = order->getLimit();
     Limit* parentLimit = order->getParentLimit();
@@ -120,73 +779,350 @@ void Book::cancelOrder(int64_t orderId) {
     } else {
         sellSide.removeOrder(price, order);
     }
-
-    allOrders.erase(it);
 }
 
 /**
- * @brief Modifies the limit price of an existing order by canceling and re-adding.
+ * @brief Moves an existing order to a new limit price; see repriceOrder.
  *
  * @param orderId The order ID to modify.
- * @param newLimitPrice New limit price.
- * @param idSeq Order ID generator for the new order.
+ * @param newLimitPrice New limit price in ticks.
  *
  * @throws std::invalid_argument if orderId is not found.
  */
-void Book::modifyOrderLimitPrice(int64_t orderId, float newLimitPrice, OrderIdSequence& idSeq) {
-    auto it = allOrders.find(orderId);
-    if (it == allOrders.end()) {
+void Book::modifyOrderLimitPrice(int64_t orderId, Price newLimitPrice) {
+    LatencyTimer timer(latencyStats, LatencyOp::ModifyPrice);
+    Order* order = allOrders.get(orderId);
+    if (!order) {
         throw std::invalid_argument("Order ID not found");
     }
-    auto* order = it->second.get();
-    Side side = order->getOrderSide();
-    int shares = order->getShares();
     OrderType type = order->getOrderType();
+    if (type == OrderType::Stop || type == OrderType::StopLimit) {
+        throw std::invalid_argument("Stop orders cannot be repriced; cancel and re-enter them.");
+    }
+    validateOrder(order->getShares(), newLimitPrice, type, TimeInForce::GoodTillCancel);
+    repriceOrder(order, newLimitPrice);
+}
 
-    cancelOrder(orderId);
-    addOrderToBook(side, shares, newLimitPrice, type, idSeq);
+/**
+ * @brief Moves an order to a new limit price through its handle; see repriceOrder.
+ *
+ * @param handle The handle returned when the order was entered.
+ * @param newLimitPrice New limit price in ticks.
+ * @return The repriced order's result, with the same ID and handle. The order is left untouched
+ *         if the handle is stale (RejectedUnknownOrder), it is a stop (RejectedInvalidType) or the
+ *         price is invalid (RejectedInvalidPrice).
+ */
+OrderResult Book::modifyOrderLimitPrice(OrderHandle handle, Price newLimitPrice) {
+    LatencyTimer timer(latencyStats, LatencyOp::ModifyPrice);
+    Order* order = orderPool.resolve(handle);
+    if (!order) {
+        return {-1, 0, OrderStatus::RejectedUnknownOrder};
+    }
+    const OrderType type = order->getOrderType();
+    if (type == OrderType::Stop || type == OrderType::StopLimit) {
+        return {-1, 0, OrderStatus::RejectedInvalidType};
+    }
+    OrderStatus rejection;
+    if (!checkOrder(order->getShares(), newLimitPrice, type, TimeInForce::GoodTillCancel, rejection)) {
+        return {-1, 0, rejection};
+    }
+    return repriceOrder(order, newLimitPrice);
+}
+
+/**
+ * @brief Moves a validated resting order to a new limit price in place.
+ *
+ * The Order keeps its storage, ID, handle and order table slot. If the new price does not cross,
+ * it is moved straight to the back of the new level. Otherwise it is unlinked, matched as an
+ * incoming order and whatever is left is queued at the new price; only if nothing is left is it
+ * released. A move to the price it already rests at changes nothing and keeps its queue position.
+ *
+ * @param order The resting order.
+ * @param newLimitPrice New limit price in ticks, already validated.
+ * @return The order's result: Resting or PartiallyFilled with its handle, Filled, or CancelledSelfTrade.
+ */
+OrderResult Book::repriceOrder(Order* order, Price newLimitPrice) {
+    const int64_t orderId = order->getOrderId();
+    const OrderHandle handle = orderPool.handleOf(order);
+    if (newLimitPrice == order->getLimit()) {
+        return {orderId, 0, OrderStatus::Resting, handle};
+    }
+
+    const Side side = order->getOrderSide();
+    Clock::Message stamp(*clock);
+    Message message(*this);
+    order->setEventTime(stamp.time());
+    const bool crosses = (side == Side::Buy) ? newLimitPrice >= sellSide.getBestPrice()
+                                             : newLimitPrice <= buySide.getBestPrice();
+    if (!crosses) {
+        if (side == Side::Buy) {
+            buySide.moveOrder(order, newLimitPrice);
+        } else {
+            sellSide.moveOrder(order, newLimitPrice);
+        }
+        return {orderId, 0, OrderStatus::Resting, handle};
+    }
+
+    unlinkOrder(order);
+    order->setLimit(newLimitPrice);
+
+    int shares = order->getShares();
+    SelfTradeCheck selfTrade{order->getParticipant(), matchingPolicy.selfTradePrevention};
+    const int filled = crossOrder(side, shares, newLimitPrice, orderId, selfTrade);
+    const OrderStatus status = entryStatus(shares, filled, TimeInForce::GoodTillCancel, selfTrade);
+    if (shares > 0) {
+        order->setShares(shares);
+        if (side == Side::Buy) {
+            buySide.addOrder(newLimitPrice, order);
+        } else {
+            sellSide.addOrder(newLimitPrice, order);
+        }
+    } else {
+        releaseOrder(order);
+    }
+    releaseStops();
+    return {orderId, filled, status, shares > 0 ? handle : OrderHandle{}};
 }
 
 /**
  * @brief Modifies the size (volume) of an existing order.
  *
- * Updates the Limit volume and the side's total volume accordingly.
+ * Updates the Limit volume and the side's total volume accordingly. A decrease keeps the order's
+ * queue position; an increase sends it to the back of its level.
  *
  * @param orderId The order ID to modify.
  * @param newSize New number of shares.
  *
- * @throws std::invalid_argument if orderId is not found.
+ * @throws std::invalid_argument if orderId is not found or newSize <= 0.
  */
 void Book::modifyOrderSize(int64_t orderId, int newSize) {
-    auto it = allOrders.find(orderId);
-    if (it == allOrders.end()) {
+    LatencyTimer timer(latencyStats, LatencyOp::ModifySize);
+    Order* order = allOrders.get(orderId);
+    if (!order) {
         throw std::invalid_argument("Order ID not found");
     }
-    auto* order = it->second.get();
-    int oldSize = order->getShares();
-    int delta = newSize - oldSize;
-
-    order->setShares(newSize);
+    if (newSize <= 0) {
+        throw std::invalid_argument("The order size must be positive");
+    }
+    resizeOrder(order, newSize);
+}
 
-    Limit* parentLimit = order->getParentLimit();
-    if (parentLimit) {
-        parentLimit->adjustVolume(delta);
+/**
+ * @brief Modifies the size of an order through its handle. A decrease keeps the order's queue
+ *        position; an increase sends it to the back of its level.
+ *
+ * @param handle The handle returned when the order was entered.
+ * @param newSize New number of shares.
+ * @return Resting (StopPending for a parked stop), RejectedUnknownOrder if the handle is stale,
+ *         or RejectedInvalidSize if newSize <= 0.
+ */
+OrderStatus Book::modifyOrderSize(OrderHandle handle, int newSize) {
+    LatencyTimer timer(latencyStats, LatencyOp::ModifySize);
+    Order* order = orderPool.resolve(handle);
+    if (!order) {
+        return OrderStatus::RejectedUnknownOrder;
     }
+    if (newSize <= 0) {
+        return OrderStatus::RejectedInvalidSize;
+    }
+    resizeOrder(order, newSize);
+    const bool parked = order->getOrderType() == OrderType::Stop || order->getOrderType() == OrderType::StopLimit;
+    return parked ? OrderStatus::StopPending : OrderStatus::Resting;
+}
 
-    if (order->getOrderSide() == Side::Buy) {
-        buySide.adjustTotalVolume(delta);
+/**
+ * @brief Sets a resting or parked order's size and event time and publishes the level change.
+ *
+ * @param order The order.
+ * @param newSize New number of shares.
+ */
+void Book::resizeOrder(Order* order, int newSize) {
+    Clock::Message stamp(*clock);
+    Message message(*this);
+    order->setEventTime(stamp.time());
+    if (order->getOrderType() == OrderType::Stop || order->getOrderType() == OrderType::StopLimit) {
+        stops->resize(order, newSize);
+    } else if (order->getOrderSide() == Side::Buy) {
+        buySide.resizeOrder(order, newSize);
     } else {
-        sellSide.adjustTotalVolume(delta);
+        sellSide.resizeOrder(order, newSize);
+    }
+}
+
+/**
+ * @brief Serializes every resting order, level by level in FIFO order, then the parked stops.
+ *
+ * Each side is written as a level count followed by (price, order count, orders) per level,
+ * with 32 bytes per order. The last trade price and a count of stop orders follow, with the
+ * stops in the order they would trigger in. The book must not be matching while this runs.
+ *
+ * @param writer Destination buffer.
+ */
+void Book::writeSnapshot(SnapshotWriter& writer) const {
+    writeSide(writer, buySide);
+    writeSide(writer, sellSide);
+
+    writer.put<int32_t>(lastTradePrice);
+    writer.put<uint32_t>(stops ? static_cast<uint32_t>(stops->size()) : 0);
+    if (stops) {
+        stops->forEach([&](const Order& order, Price stopPrice) {
+            writer.put(SnapshotStop{order.getOrderId(), order.getEntryTime(), order.getEventTime(), order.getShares(),
+                                    stopPrice, order.getLimit(), order.getOrderSide(), order.getOrderType(),
+                                    order.getParticipant()});
+        });
     }
 }
 
+/**
+ * @brief Rebuilds an empty book from a snapshot written by writeSnapshot.
+ *
+ * Orders are linked straight into their levels and the order table, without validation or
+ * crossing checks, so the restored queues match the snapshot exactly.
+ *
+ * @param reader Source positioned at the start of this book's data.
+ *
+ * @return The highest order ID restored, resting or parked, or -1 if the book is empty.
+ *
+ * @throws std::runtime_error if the book is not empty or the snapshot is malformed.
+ */
+int64_t Book::restoreSnapshot(SnapshotReader& reader) {
+    if (!allOrders.empty()) {
+        throw std::runtime_error("Cannot restore a snapshot into a non-empty book");
+    }
+    Message message(*this);
+    std::vector<Order*> scratch;
+    int64_t maxOrderId = restoreSide(reader, buySide, scratch);
+    maxOrderId = std::max(maxOrderId, restoreSide(reader, sellSide, scratch));
+
+    lastTradePrice = reader.get<int32_t>();
+    const uint32_t stopCount = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < stopCount; ++i) {
+        const SnapshotStop record = reader.get<SnapshotStop>();
+        const bool limitOk = record.type == OrderType::Stop ? record.limit == NO_PRICE
+                           : record.type == OrderType::StopLimit && record.limit > 0 && record.limit <= TriggerBook::MAX_PRICE;
+        if (record.orderId < 0 || record.shares <= 0 || allOrders.get(record.orderId) || !limitOk
+            || record.stopPrice <= 0 || record.stopPrice > TriggerBook::MAX_PRICE
+            || (record.side != Side::Buy && record.side != Side::Sell)) {
+            throw std::runtime_error("Snapshot stop order is invalid or repeated");
+        }
+        if (!stops) {
+            stops = std::make_unique<TriggerBook>();
+        }
+        Order* order = orderPool.create(record.side, record.shares, record.limit, record.type, nullptr, record.orderId,
+                                        record.entryTime, record.participant);
+        order->setEventTime(record.eventTime);
+        stops->add(order, record.stopPrice);
+        allOrders.insert(record.orderId, order);
+        if (record.participant != NO_PARTICIPANT) {
+            participants.add(order);
+        }
+        maxOrderId = std::max(maxOrderId, record.orderId);
+    }
+    return maxOrderId;
+}
+
+/**
+ * @brief Writes one side of the book.
+ *
+ * Resting orders of one level are scattered across the pool, so a queue walk misses the cache on
+ * almost every order. Queues of several consecutive levels are therefore walked in lockstep,
+ * each writing into its own, already sized, region of the output.
+ */
+template<Side S>
+void Book::writeSide(SnapshotWriter& writer, const LOBSide<S>& side) const {
+    std::vector<const Limit*> levels;
+    side.forEachLevel([&](const Limit& limit) { levels.push_back(&limit); });
+    writer.put(static_cast<uint32_t>(levels.size()));
+
+    for (size_t first = 0; first < levels.size(); first += SNAPSHOT_WALK_WIDTH) {
+        const size_t width = std::min(SNAPSHOT_WALK_WIDTH, levels.size() - first);
+        const Order* cursors[SNAPSHOT_WALK_WIDTH];
+        size_t offsets[SNAPSHOT_WALK_WIDTH];
+        size_t active = 0;
+
+        for (size_t k = 0; k < width; ++k) {
+            const Limit& limit = *levels[first + k];
+            writer.put<int32_t>(limit.getLimitPrice());
+            writer.put<uint32_t>(static_cast<uint32_t>(limit.getSize()));
+            offsets[k] = writer.size();
+            writer.extend(static_cast<size_t>(limit.getSize()) * sizeof(SnapshotOrder));
+            cursors[k] = limit.getHead();
+            active += cursors[k] != nullptr;
+        }
+
+        while (active > 0) {
+            for (size_t k = 0; k < width; ++k) {
+                const Order* order = cursors[k];
+                if (!order) {
+                    continue;
+                }
+                writer.patch(offsets[k], SnapshotOrder{order->getOrderId(), order->getEntryTime(), order->getEventTime(), order->getShares(),
+                                                    order->getParticipant(), 0});
+                offsets[k] += sizeof(SnapshotOrder);
+                cursors[k] = order->getNextOrder();
+                active -= cursors[k] == nullptr;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reads one side of the book, creating its orders and linking each level in one pass.
+ *
+ * Orders of a level usually have scattered IDs, so the order table slot of each upcoming
+ * record is prefetched a few records ahead.
+ */
+template<Side S>
+int64_t Book::restoreSide(SnapshotReader& reader, LOBSide<S>& side, std::vector<Order*>& scratch) {
+    int64_t maxOrderId = -1;
+    const uint32_t levelCount = reader.get<uint32_t>();
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        const int32_t price = reader.get<int32_t>();
+        const uint32_t orderCount = reader.get<uint32_t>();
+        if (price <= LOBSide<S>::MIN_PRICE || price > LOBSide<S>::MAX_PRICE) {
+            throw std::runtime_error("Snapshot price level out of range");
+        }
+        const Limit* existing = side.getLimit(price);
+        if (existing && !existing->empty()) {
+            throw std::runtime_error("Snapshot lists a price level twice");
+        }
+        const char* in = reader.take(static_cast<size_t>(orderCount) * sizeof(SnapshotOrder));
+
+        scratch.clear();
+        allOrders.reserve(allOrders.size() + orderCount);
+        for (uint32_t i = 0; i < orderCount; ++i) {
+            SnapshotOrder record;
+            if (i + SNAPSHOT_PREFETCH_DISTANCE < orderCount) {
+                std::memcpy(&record, in + (i + SNAPSHOT_PREFETCH_DISTANCE) * sizeof(SnapshotOrder), sizeof(record));
+                allOrders.prefetch(record.orderId);
+            }
+            std::memcpy(&record, in + i * sizeof(SnapshotOrder), sizeof(record));
+            if (record.orderId < 0 || record.shares <= 0 || allOrders.get(record.orderId)) {
+                throw std::runtime_error("Snapshot order is invalid or repeated");
+            }
+
+            Order* order = orderPool.create(S, record.shares, price, OrderType::Limit, nullptr, record.orderId,
+                                            record.entryTime, record.participant);
+            order->setEventTime(record.eventTime);
+            allOrders.insert(record.orderId, order);
+            if (record.participant != NO_PARTICIPANT) {
+                participants.add(order);
+            }
+            scratch.push_back(order);
+            maxOrderId = std::max(maxOrderId, record.orderId);
+        }
+        side.restoreLevel(price, scratch.data(), scratch.size());
+    }
+    return maxOrderId;
+}
+
 /**
  * @brief Adds an order to the internal order map.
  *
- * @param order Unique pointer to the Order to insert.
+ * @param order Pointer to a pooled Order to insert.
  */
-void Book::addOrderToAllOrders(std::unique_ptr<Order> order) {
-    allOrders.emplace(order->getOrderId(), std::move(order));
+void Book::addOrderToAllOrders(Order* order) {
+    allOrders.insert(order->getOrderId(), order);
 }
 
 /**
@@ -198,6 +1134,114 @@ void Book::removeOrderFromAllOrders(int64_t orderId) {
     allOrders.erase(orderId);
 }
 
+/**
+ * @brief Publishes one match to the execution stream and retires the resting order if it is done.
+ *
+ * Called from the matching loops for every fill, after the resting order's shares have been
+ * reduced to its leaves.
+ *
+ * @param aggressorId Order ID of the incoming order.
+ * @param aggressorSide Side of the incoming order.
+ * @param resting The resting order that was hit.
+ * @param quantity Shares traded.
+ * @param aggressorLeaves Shares left on the incoming order after this match.
+ */
+void Book::recordFill(int64_t aggressorId, Side aggressorSide, Order* resting, int32_t quantity, int32_t aggressorLeaves) {
+    const int32_t restingLeaves = resting->getShares();
+    const Timestamp time = clock->getMessageTime();
+    lastTradePrice = resting->getLimit();
+    if (stops) {
+        tradeHigh = std::max(tradeHigh, lastTradePrice);
+        tradeLow = std::min(tradeLow, lastTradePrice);
+    }
+    resting->setEventTime(time);
+    executions.record({0, time, aggressorId, resting->getOrderId(), resting->getLimit(), quantity,
+                       restingLeaves, aggressorLeaves, aggressorSide});
+    if (restingLeaves == 0) {
+        releaseOrder(resting);
+    }
+}
+
+/**
+ * @brief Drops a filled, canceled or triggered order from the order map and returns its slot to the pool.
+ *
+ * Called once the order has been unlinked from its Limit.
+ *
+ * @param order The filled order.
+ */
+void Book::releaseOrder(Order* order) {
+    allOrders.erase(order->getOrderId());
+    if (order->getParticipant() != NO_PARTICIPANT) {
+        participants.remove(order);
+    }
+    orderPool.destroy(order);
+}
+
+/**
+ * @brief Enters every stop order that the trades since the last check have triggered.
+ *
+ * Runs as a loop rather than by recursion: stops triggered by the trades of a released stop are
+ * appended behind those already waiting, so a cascade through a fast market takes one pass per
+ * triggered order, in a deterministic order, with no growth of the call stack. Calls made while
+ * the loop is running (from the orders it enters) return immediately.
+ */
+void Book::releaseStops() {
+    if (!stops || releasingStops || tradeHigh < 0) {
+        return;
+    }
+    releasingStops = true;
+    for (;;) {
+        stops->trigger(tradeHigh, tradeLow);
+        tradeHigh = -1;
+        tradeLow = TriggerBook::MAX_PRICE + 1;
+
+        Order* stop = stops->popReleased();
+        if (!stop) {
+            break;
+        }
+        const Side side = stop->getOrderSide();
+        const int shares = stop->getShares();
+        const Price limit = stop->getLimit();
+        const OrderType type = stop->getOrderType();
+        const int64_t orderId = stop->getOrderId();
+        const ParticipantId participant = stop->getParticipant();
+        releaseOrder(stop);
+
+        if (type == OrderType::Stop) {
+            enterOrder(side, shares, NO_PRICE, OrderType::Market, orderId, clock->getMessageTime(), TimeInForce::ImmediateOrCancel,
+                       participant);
+        } else {
+            enterOrder(side, shares, limit, OrderType::Limit, orderId, clock->getMessageTime(), TimeInForce::GoodTillCancel,
+                       participant);
+        }
+    }
+    releasingStops = false;
+}
+
+/**
+ * @brief Copies the best level of each side into the top of book slot if either has changed.
+ *
+ * Called once per inbound message, after all of its fills, cancels and released stops, so readers
+ * never see the intermediate states of a sweep; messages that leave the top alone publish nothing.
+ */
+void Book::publishTopOfBook() {
+    TopOfBook top;
+    if (const Limit* bid = buySide.getBestLimit()) {
+        top.bidPrice = bid->getLimitPrice();
+        top.bidVolume = bid->getTotalVolume();
+        top.bidOrders = bid->getSize();
+    }
+    if (const Limit* ask = sellSide.getBestLimit()) {
+        top.askPrice = ask->getLimitPrice();
+        top.askVolume = ask->getTotalVolume();
+        top.askOrders = ask->getSize();
+    }
+    if (top != publishedTop) {
+        publishedTop = top;
+        topOfBook.publish(top);
+    }
+}
+
 /**
  * @brief Returns a reference to the sell side (ask side) of the book.
  *
@@ -219,8 +1263,120 @@ LOBSide<Side::Buy>& Book::getBuySide() {
 /**
  * @brief Returns all active orders in the book.
  *
- * @return const reference to unordered_map of order IDs to Orders.
+ * @return const reference to the table of Orders keyed by ID.
  */
-const std::unordered_map<int64_t, std::unique_ptr<Order>>& Book::getAllOrders() const {
+const OrderTable& Book::getAllOrders() const {
     return allOrders;
 }
+
+/**
+ * @brief Returns the stream of executions produced by this book, to be drained by downstream consumers.
+ *
+ * @return Reference to the ExecutionReportBuffer.
+ */
+ExecutionReportBuffer& Book::getExecutions() {
+    return executions;
+}
+
+/**
+ * @brief Shares a clock with the book, e.g. the exchange's, instead of the book's own monotonic one.
+ *        The clock must outlive the book.
+ *
+ * @param newClock The clock to stamp orders and executions with.
+ */
+void Book::setClock(Clock& newClock) {
+    clock = &newClock;
+}
+
+/**
+ * @brief Returns the clock this book stamps orders and executions with.
+ *
+ * @return Reference to the Clock.
+ */
+Clock& Book::getClock() {
+    return *clock;
+}
+
+/**
+ * @brief Returns the book's parked stop orders.
+ *
+ * @return The trigger book, or nullptr if no stop order was ever parked.
+ */
+const TriggerBook* Book::getTriggerBook() const {
+    return stops.get();
+}
+
+/**
+ * @brief Returns the price of the book's most recent trade.
+ *
+ * @return The price in ticks, or NO_PRICE if nothing has traded.
+ */
+Price Book::getLastTradePrice() const {
+    return lastTradePrice;
+}
+
+/**
+ * @brief Returns the matching policy the book was constructed with.
+ *
+ * @return const reference to the MatchingPolicy.
+ */
+const MatchingPolicy& Book::getMatchingPolicy() const {
+    return matchingPolicy;
+}
+
+/**
+ * @brief Returns this book's per-operation latency histograms (empty unless built with
+ *        EXCHANGE_ENABLE_LATENCY_STATS). Safe to read from another thread while the book runs.
+ *
+ * @return const reference to the LatencyStats.
+ */
+const LatencyStats& Book::getLatencyStats() const {
+    return latencyStats;
+}
+
+/**
+ * @brief Returns the L2 level changes produced by this book, one coalesced batch per inbound message.
+ *
+ * @return Reference to the DepthUpdateBuffer.
+ */
+DepthUpdateBuffer& Book::getDepthUpdates() {
+    return depthUpdates;
+}
+
+/**
+ * @brief Returns the seqlock slot holding this book's best bid and offer. The slot may be read
+ *        from any thread while the book is matching; it lives as long as the book.
+ *
+ * @return const reference to the TopOfBookSlot.
+ */
+const TopOfBookSlot& Book::getTopOfBook() const {
+    return topOfBook;
+}
+
+/**
+ * @brief Returns the allocator backing this book's resting orders.
+ *
+ * @return const reference to the OrderPool.
+ */
+const OrderPool& Book::getOrderPool() const {
+    return orderPool;
+}
+
+/**
+ * @brief Returns the resting or parked order a handle refers to.
+ *
+ * @param handle The handle returned when the order was entered.
+ * @return Pointer to the order, or nullptr if the handle is stale.
+ */
+const Order* Book::findOrder(OrderHandle handle) const {
+    return orderPool.resolve(handle);
+}
+
+/**
+ * @brief Returns the per-participant lists of this book's live orders.
+ *
+ * @return const reference to the ParticipantIndex.
+ */
+const ParticipantIndex& Book::getParticipants() const {
+    return participants;
+}
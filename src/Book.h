@@ -1,10 +1,22 @@
 #pragma once
 
-#include <unordered_map>
 #include <memory>
+#include <span>
+#include "Clock.h"
+#include "DepthUpdate.h"
+#include "ExecutionReport.h"
+#include "LatencyStats.h"
 #include "LOBSide.hpp"
+#include "MatchingPolicy.hpp"
 #include "Order.h"
 #include "OrderIdSequence.h"
+#include "OrderRequest.h"
+#include "OrderPool.h"
+#include "OrderTable.h"
+#include "ParticipantIndex.h"
+#include "Snapshot.hpp"
+#include "TopOfBook.h"
+#include "TriggerBook.h"
 
 /**
  * @class Book
@@ -12,35 +24,138 @@
  */
 class Book {
 public:
-    Book();
+    explicit Book(MatchingPolicy matchingPolicy = MatchingPolicy());
 
     // adding limit orders
-    void addOrderToBook(Side side, int shares, float limit, OrderType type, OrderIdSequence& idSeq);
+    OrderResult addOrderToBook(Side side, int shares, Price limit, OrderType type, OrderIdSequence& idSeq,
+                               TimeInForce timeInForce = TimeInForce::GoodTillCancel,
+                               ParticipantId participant = NO_PARTICIPANT);
+    OrderResult addOrderToBook(Side side, int shares, Price limit, OrderType type, int64_t orderId,
+                               TimeInForce timeInForce = TimeInForce::GoodTillCancel,
+                               ParticipantId participant = NO_PARTICIPANT);
+    size_t submitBatch(std::span<const OrderRequest> requests, std::span<OrderResult> results, OrderIdSequence& idSeq);
+
+    // stop and stop-limit orders
+    OrderResult addStopOrder(Side side, int shares, Price stopPrice, Price limit, OrderIdSequence& idSeq,
+                             ParticipantId participant = NO_PARTICIPANT);
+    OrderResult addStopOrder(Side side, int shares, Price stopPrice, Price limit, int64_t orderId,
+                             ParticipantId participant = NO_PARTICIPANT);
 
     // placing market orders
-    void placeMarketOrder(int volume, Side side);
+    int placeMarketOrder(int volume, Side side, int64_t aggressorId = -1, ParticipantId participant = NO_PARTICIPANT);
 
     // canceling orders
     void cancelOrder(int64_t orderId);
+    OrderStatus cancelOrder(OrderHandle handle);
+    size_t massCancel(ParticipantId participant);
+    size_t massCancel(Side side);
+    size_t massCancel(Side side, Price low, Price high);
 
     // modifying orders
-    void modifyOrderLimitPrice(int64_t orderId, float newLimitPrice, OrderIdSequence& idSeq);
+    void modifyOrderLimitPrice(int64_t orderId, Price newLimitPrice);
     void modifyOrderSize(int64_t orderId, int newSize);
+    OrderResult modifyOrderLimitPrice(OrderHandle handle, Price newLimitPrice);
+    OrderStatus modifyOrderSize(OrderHandle handle, int newSize);
+
+    // snapshots
+    void writeSnapshot(SnapshotWriter& writer) const;
+    int64_t restoreSnapshot(SnapshotReader& reader);
 
     // internal order map management
-    void addOrderToAllOrders(std::unique_ptr<Order> order);
+    void addOrderToAllOrders(Order* order);
     void removeOrderFromAllOrders(int64_t orderId);
 
     // getters
     LOBSide<Side::Sell>& getSellSide();
     LOBSide<Side::Buy>& getBuySide();
-    const std::unordered_map<int64_t, std::unique_ptr<Order>>& getAllOrders() const;
+    const OrderTable& getAllOrders() const;
+    const OrderPool& getOrderPool() const;
+    const Order* findOrder(OrderHandle handle) const;
+    const ParticipantIndex& getParticipants() const;
+    ExecutionReportBuffer& getExecutions();
+    DepthUpdateBuffer& getDepthUpdates();
+    const TopOfBookSlot& getTopOfBook() const;
+    Clock& getClock();
+    const LatencyStats& getLatencyStats() const;
+    const MatchingPolicy& getMatchingPolicy() const;
+    const TriggerBook* getTriggerBook() const;
+    Price getLastTradePrice() const;
+    void setClock(Clock& newClock);
 
 private:
+    /**
+     * @class Message
+     * @brief Scope of one inbound message: joins the depth update scope and, once the outermost
+     *        scope closes, republishes the top of book if the message touched any level.
+     */
+    class Message {
+    public:
+        explicit Message(Book& book) : book(book), depth(book.depthUpdates) { ++book.openMessages; }
+        ~Message() {
+            if (--book.openMessages == 0 && book.depthUpdates.hasPending())
+                book.publishTopOfBook();
+        }
+
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+
+    private:
+        Book& book;
+        DepthUpdateBuffer::Message depth;
+    };
+
     LOBSide<Side::Sell> sellSide;
     LOBSide<Side::Buy> buySide;
 
-    std::unordered_map<int64_t, std::unique_ptr<Order>> allOrders;
+    OrderPool orderPool;
+    OrderTable allOrders;
+    ParticipantIndex participants;
+    ExecutionReportBuffer executions;
+    DepthUpdateBuffer depthUpdates;
+    TopOfBookSlot topOfBook;            // read by other threads; written at the end of each message
+    TopOfBook publishedTop;             // matching thread's copy of what the slot holds
+    Clock defaultClock;
+    Clock* clock;
+    LatencyStats latencyStats;
+    MatchingPolicy matchingPolicy;
+    ProRataMatching proRata;
+    std::unique_ptr<TriggerBook> stops; // created with the first parked stop
+    Price lastTradePrice;
+    Price tradeHigh;                    // highest and lowest prices traded since stops were last checked
+    Price tradeLow;
+    bool releasingStops;
+    int openMessages;                   // nesting depth of Message scopes
+
+    static constexpr size_t BATCH_PREFETCH_DISTANCE = 4;
+    static constexpr size_t MASS_CANCEL_PREFETCH_DISTANCE = 8;
+    static constexpr size_t TOUCH_FILTER_SIZE = 1024;
+
+    static bool checkOrder(int shares, Price limit, OrderType type, TimeInForce timeInForce, OrderStatus& rejection);
+    static void validateOrder(int shares, Price limit, OrderType type, TimeInForce timeInForce);
+    static void validateStopOrder(int shares, Price stopPrice, Price limit);
+    OrderResult enterOrder(Side side, int shares, Price price, OrderType type, int64_t orderId, Timestamp entryTime,
+                           TimeInForce timeInForce, ParticipantId participant);
+    int crossOrder(Side side, int& shares, Price price, int64_t orderId, SelfTradeCheck& selfTrade);
+    static OrderStatus entryStatus(int remaining, int filled, TimeInForce timeInForce, const SelfTradeCheck& selfTrade);
+    OrderResult enterMarketOrder(Side side, int shares, int64_t orderId, TimeInForce timeInForce,
+                                 ParticipantId participant);
+    static bool mayRest(const OrderRequest& request, OrderStatus status);
+    void prefetchLevel(const OrderRequest& request, OrderStatus status) const;
+    void prefetchEntry(const OrderRequest& request, OrderStatus status, int64_t orderId) const;
+    void recordFill(int64_t aggressorId, Side aggressorSide, Order* resting, int32_t quantity, int32_t aggressorLeaves);
+    void releaseOrder(Order* order);
+    void releaseStops();
+    void publishTopOfBook();
+    void removeOrder(Order* order);
+    void unlinkOrder(Order* order);
+    OrderResult repriceOrder(Order* order, Price newLimitPrice);
+    void resizeOrder(Order* order, int newSize);
+    template<typename Fn>
+    void withMatching(SelfTradeCheck& selfTrade, Fn&& fn);
+    template<Side S>
+    void writeSide(SnapshotWriter& writer, const LOBSide<S>& side) const;
+    template<Side S>
+    int64_t restoreSide(SnapshotReader& reader, LOBSide<S>& side, std::vector<Order*>& scratch);
 
     // disable copying
     Book(const Book&) = delete;
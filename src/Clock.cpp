@@ -0,0 +1,86 @@
+#include "Clock.h"
+#include <stdexcept>
+
+namespace {
+
+/// TSC-to-nanosecond scale measured once per process.
+struct TscCalibration {
+    uint64_t base;
+    Timestamp baseTime;
+    uint64_t nanosPerTickQ32;
+};
+
+constexpr std::chrono::milliseconds TSC_CALIBRATION_WINDOW{10};
+
+/**
+ * @brief Times the TSC against steady_clock over a short busy-wait.
+ */
+TscCalibration calibrateTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    using std::chrono::steady_clock;
+    const steady_clock::time_point start = steady_clock::now();
+    const uint64_t startTicks = __rdtsc();
+    steady_clock::time_point end = start;
+    while (end - start < TSC_CALIBRATION_WINDOW) {
+        end = steady_clock::now();
+    }
+    const uint64_t endTicks = __rdtsc();
+
+    const auto nanos = static_cast<unsigned __int128>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    const uint64_t ticks = endTicks - startTicks;
+    const Timestamp baseTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()).count();
+    return {endTicks, baseTime, ticks ? static_cast<uint64_t>((nanos << 32) / ticks) : 0};
+#else
+    return {0, 0, 0};
+#endif
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a clock on the given source. The first TSC clock of the process pays for a
+ *        ~10 ms calibration; a virtual clock starts at zero.
+ * @param source Where to read time from.
+ */
+Clock::Clock(ClockSource source)
+    : source(source), openMessages(0), messageTime(0), virtualTime(0), tscBase(0), tscBaseTime(0), nanosPerTickQ32(0)
+{
+    if (source == ClockSource::Tsc) {
+        static const TscCalibration calibration = calibrateTsc();
+        if (calibration.nanosPerTickQ32 == 0) {
+            this->source = ClockSource::Monotonic;
+            return;
+        }
+        tscBase = calibration.base;
+        tscBaseTime = calibration.baseTime;
+        nanosPerTickQ32 = calibration.nanosPerTickQ32;
+    }
+}
+
+/**
+ * @brief Returns the time read by the current (or last) Message scope.
+ * @return Nanoseconds.
+ */
+Timestamp Clock::getMessageTime() const {
+    return messageTime;
+}
+
+/**
+ * @brief Returns the source this clock reads, which is Monotonic if a TSC was asked for but is unavailable.
+ */
+ClockSource Clock::getSource() const {
+    return source;
+}
+
+/**
+ * @brief Moves a virtual clock to the given time.
+ * @param time Nanoseconds.
+ * @throws std::runtime_error if the clock is not virtual.
+ */
+void Clock::setTime(Timestamp time) {
+    if (source != ClockSource::Virtual) {
+        throw std::runtime_error("Only a virtual clock can be set.");
+    }
+    virtualTime = time;
+}
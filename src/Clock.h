@@ -0,0 +1,132 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/// Nanoseconds since the clock's epoch (steady_clock's for real clocks, caller-defined for virtual ones).
+using Timestamp = int64_t;
+
+/**
+ * @enum ClockSource
+ * @brief Where a Clock reads time from.
+ */
+enum class ClockSource : uint8_t {
+    Monotonic, ///< std::chrono::steady_clock
+    Tsc,       ///< the CPU time-stamp counter, scaled to steady_clock nanoseconds
+    Virtual    ///< only moves when set, for replay and simulation
+};
+
+/**
+ * @class Clock
+ * @brief Timestamp source of a book, read once per inbound message.
+ *
+ * Work triggered by one inbound message opens a Message scope; the outermost scope reads the
+ * source once and every nested scope, order and fill of that message reuse the same time.
+ * A TSC clock is calibrated against steady_clock once per process, so its readings are on the
+ * same nanosecond scale and epoch as a monotonic clock. On targets without a TSC it falls back
+ * to the monotonic source.
+ */
+class Clock {
+public:
+    /**
+     * @class Message
+     * @brief Scope of one inbound message; nested scopes join the outermost one.
+     */
+    class Message {
+    public:
+        explicit Message(Clock& clock) : clock(clock) {
+            if (clock.openMessages++ == 0) clock.messageTime = clock.now();
+        }
+        ~Message() { --clock.openMessages; }
+
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+
+        Timestamp time() const { return clock.messageTime; }
+
+    private:
+        Clock& clock;
+    };
+
+    explicit Clock(ClockSource source = ClockSource::Monotonic);
+
+    Timestamp now() const;
+    Timestamp getMessageTime() const;
+    ClockSource getSource() const;
+    void setTime(Timestamp time);
+
+private:
+    ClockSource source;
+    int openMessages;
+    Timestamp messageTime;
+    Timestamp virtualTime;
+    uint64_t tscBase;
+    Timestamp tscBaseTime;
+    uint64_t nanosPerTickQ32; // fixed point, 32 fractional bits
+
+    Timestamp readTsc() const;
+    static Timestamp readMonotonic();
+};
+
+/**
+ * @brief Reads the clock's source. Prefer a Message scope on the matching path.
+ * @return The current time in nanoseconds.
+ */
+inline Timestamp Clock::now() const {
+    switch (source) {
+        case ClockSource::Tsc:
+            return readTsc();
+        case ClockSource::Virtual:
+            return virtualTime;
+        case ClockSource::Monotonic:
+            break;
+    }
+    return readMonotonic();
+}
+
+/**
+ * @brief Converts the time-stamp counter to nanoseconds on the steady_clock scale.
+ */
+inline Timestamp Clock::readTsc() const {
+#if defined(__x86_64__) || defined(__i386__)
+    const unsigned __int128 elapsed = static_cast<unsigned __int128>(__rdtsc() - tscBase) * nanosPerTickQ32;
+    return tscBaseTime + static_cast<Timestamp>(elapsed >> 32);
+#else
+    return readMonotonic();
+#endif
+}
+
+/**
+ * @brief Reads steady_clock in nanoseconds.
+ */
+inline Timestamp Clock::readMonotonic() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
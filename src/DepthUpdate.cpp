@@ -0,0 +1,122 @@
+#include "DepthUpdate.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+/**
+ * @brief Constructs an empty buffer.
+ * @param capacity Published updates the ring holds before it overflows, rounded up to a power of two.
+ */
+DepthUpdateBuffer::DepthUpdateBuffer(size_t capacity)
+    : pending{},
+      pendingCount(0),
+      touched(false),
+      slots(std::bit_ceil(std::max<size_t>(capacity, 1))),
+      mask(slots.size() - 1),
+      readIndex(0),
+      writeIndex(0),
+      nextSequence(0),
+      dropped(0),
+      openMessages(0)
+{}
+
+/**
+ * @brief Returns the number of published updates waiting to be drained.
+ */
+size_t DepthUpdateBuffer::size() const {
+    return static_cast<size_t>(writeIndex - readIndex);
+}
+
+/**
+ * @brief Checks whether there are no published updates.
+ */
+bool DepthUpdateBuffer::empty() const {
+    return writeIndex == readIndex;
+}
+
+/**
+ * @brief Returns the number of published updates the ring can hold before it overflows.
+ */
+size_t DepthUpdateBuffer::capacity() const {
+    return slots.size();
+}
+
+/**
+ * @brief Returns the sequence number the next message with level changes will get.
+ */
+uint64_t DepthUpdateBuffer::getNextSequence() const {
+    return nextSequence;
+}
+
+/**
+ * @brief Returns how many updates were overwritten because the ring was full and no overflow handler was set.
+ */
+uint64_t DepthUpdateBuffer::getDroppedCount() const {
+    return dropped;
+}
+
+/**
+ * @brief Sets the consumer that receives the published updates whenever an update arrives at a full ring.
+ * @param handler The consumer, or an empty function to overwrite the oldest update instead.
+ */
+void DepthUpdateBuffer::setOverflowHandler(OverflowHandler handler) {
+    onOverflow = std::move(handler);
+}
+
+/**
+ * @brief Keeps the last recorded change of each pending level and publishes it under the open
+ *        message's sequence number. Most messages touch one or two levels (a reprice touches two)
+ *        and sweeps record them already ordered by price, so an in-place insertion sort is enough
+ *        and never allocates.
+ */
+void DepthUpdateBuffer::coalesce() {
+    auto before = [](const DepthUpdate& a, const DepthUpdate& b) {
+        return a.side != b.side ? a.side < b.side : a.price < b.price;
+    };
+    for (size_t i = 1; i < pendingCount; ++i) {
+        const DepthUpdate update = pending[i];
+        size_t j = i;
+        for (; j > 0 && before(update, pending[j - 1]); --j) {
+            pending[j] = pending[j - 1];
+        }
+        pending[j] = update;
+    }
+    for (size_t i = 0; i < pendingCount; ++i) {
+        const bool lastOfLevel = i + 1 == pendingCount
+            || pending[i + 1].side != pending[i].side || pending[i + 1].price != pending[i].price;
+        if (lastOfLevel) {
+            if (writeIndex - readIndex == slots.size()) [[unlikely]] {
+                overflow();
+            }
+            DepthUpdate& slot = slots[writeIndex & mask];
+            slot = pending[i];
+            slot.sequence = nextSequence;
+            ++writeIndex;
+        }
+    }
+    pendingCount = 0;
+}
+
+/**
+ * @brief Closes the current message: publishes what is still pending and moves to the next sequence number.
+ */
+void DepthUpdateBuffer::seal() {
+    if (!touched) {
+        return;
+    }
+    coalesce();
+    ++nextSequence;
+    touched = false;
+}
+
+/**
+ * @brief Makes room for one update: drains to the overflow handler, or drops the oldest update.
+ */
+void DepthUpdateBuffer::overflow() {
+    if (onOverflow) {
+        drain(onOverflow);
+    } else {
+        ++readIndex;
+        ++dropped;
+    }
+}
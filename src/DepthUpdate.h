@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include "Side.hpp"
+
+/**
+ * @struct DepthLevel
+ * @brief Aggregated state of one price level, as returned by depth snapshots.
+ */
+struct DepthLevel {
+    int32_t price;      ///< price (in cents)
+    int32_t volume;     ///< total resting shares at this price
+    int32_t orderCount; ///< number of resting orders at this price
+};
+
+/**
+ * @struct DepthUpdate
+ * @brief The new state of one price level after an inbound message changed it.
+ *        A volume and order count of zero mean the level was removed.
+ */
+struct DepthUpdate {
+    uint64_t sequence;  ///< per-book message sequence number; all updates from one message share it
+    int32_t price;      ///< price (in cents)
+    int32_t volume;     ///< total resting shares now at this price
+    int32_t orderCount; ///< number of resting orders now at this price
+    Side side;          ///< side of the book the level belongs to
+};
+
+/**
+ * @class DepthUpdateBuffer
+ * @brief Collects L2 level changes while a message is applied and publishes one update per changed level.
+ *
+ * LOBSide records the new state of a level every time it touches it. When the outermost
+ * message scope closes, repeated changes to the same level are collapsed to the last one
+ * and the result is appended to a preallocated ring of published updates, so the cost of
+ * publishing is proportional to the number of levels the message touched rather than to
+ * the book size. A message touching more than PENDING_CAPACITY level changes is coalesced
+ * in chunks, which may publish a level more than once under the same sequence number;
+ * the last update still carries its final state. Nothing allocates after construction:
+ * when the ring is full, its updates go to the overflow handler if one is set, otherwise
+ * the oldest update is overwritten and counted in getDroppedCount().
+ */
+class DepthUpdateBuffer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+    static constexpr size_t PENDING_CAPACITY = 64;
+    using OverflowHandler = std::function<void(std::span<const DepthUpdate>)>;
+
+    /**
+     * @class Message
+     * @brief Scope of one inbound message; nested scopes join the outermost one.
+     */
+    class Message {
+    public:
+        explicit Message(DepthUpdateBuffer& buffer) : buffer(buffer) { ++buffer.openMessages; }
+        ~Message() { if (--buffer.openMessages == 0) buffer.seal(); }
+
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+
+    private:
+        DepthUpdateBuffer& buffer;
+    };
+
+    explicit DepthUpdateBuffer(size_t capacity = DEFAULT_CAPACITY);
+
+    void record(Side side, int32_t price, int32_t volume, int32_t orderCount);
+
+    template<typename Fn>
+    size_t drain(Fn&& onBatch);
+
+    size_t size() const;
+    bool empty() const;
+    bool hasPending() const;
+    size_t capacity() const;
+    uint64_t getNextSequence() const;
+    uint64_t getDroppedCount() const;
+    void setOverflowHandler(OverflowHandler handler);
+
+private:
+    /// level changes of the open message, in the order they happened
+    std::array<DepthUpdate, PENDING_CAPACITY> pending;
+    size_t pendingCount;
+    /// whether the open message has touched a level, even if its changes were already coalesced
+    bool touched;
+    std::vector<DepthUpdate> slots;
+    size_t mask;
+    uint64_t readIndex;
+    uint64_t writeIndex;
+    uint64_t nextSequence;
+    uint64_t dropped;
+    int openMessages;
+    OverflowHandler onOverflow;
+
+    void coalesce();
+    void seal();
+    void overflow();
+};
+
+/**
+ * @brief Notes the new state of a level touched by the current message.
+ * @param side Side of the level.
+ * @param price The level's price (in cents).
+ * @param volume Total resting shares now at the level.
+ * @param orderCount Resting orders now at the level.
+ */
+inline void DepthUpdateBuffer::record(Side side, int32_t price, int32_t volume, int32_t orderCount) {
+    if (pendingCount == PENDING_CAPACITY) [[unlikely]] {
+        coalesce();
+    }
+    pending[pendingCount++] = {0, price, volume, orderCount, side};
+    touched = true;
+}
+
+/**
+ * @brief Checks whether the open message has touched any level yet.
+ */
+inline bool DepthUpdateBuffer::hasPending() const {
+    return touched;
+}
+
+/**
+ * @brief Hands every published update to a consumer and empties the buffer.
+ * @param onBatch Called with a std::span<const DepthUpdate>, once or twice if the ring wraps.
+ * @return Number of updates drained.
+ */
+template<typename Fn>
+size_t DepthUpdateBuffer::drain(Fn&& onBatch) {
+    const size_t count = size();
+    if (count == 0) {
+        return 0;
+    }
+
+    const size_t start = readIndex & mask;
+    const size_t first = std::min(count, slots.size() - start);
+    onBatch(std::span<const DepthUpdate>(slots.data() + start, first));
+    if (first < count) {
+        onBatch(std::span<const DepthUpdate>(slots.data(), count - first));
+    }
+
+    readIndex = writeIndex;
+    return count;
+}
@@ -1,65 +1,374 @@
 #include "Exchange.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+constexpr uint64_t SNAPSHOT_MAGIC = 0x50414e5343584521ULL; // "!EXCSNAP"
+constexpr uint32_t SNAPSHOT_VERSION = 6;
+
+} // namespace
 
 /**
  * @brief Constructs a new Exchange with a specified name.
  * @param exchangeName The name of the exchange.
+ * @param clockSource Clock that stamps orders and executions: monotonic, TSC, or virtual for replay.
  */
-Exchange::Exchange(const std::string& exchangeName)
-    : exchangeName(exchangeName) {}
+Exchange::Exchange(const std::string& exchangeName, ClockSource clockSource)
+    : exchangeName(exchangeName), clock(clockSource) {}
 
 /**
  * @brief Adds an order to the order book of a specific ticker.
+ * @return The order's result; see Book::addOrderToBook.
+ */
+OrderResult Exchange::addOrder(const std::string& ticker, Side orderSide, int shares, Price limit, OrderType orderType,
+                               TimeInForce timeInForce, ParticipantId participant) {
+    return addOrder(resolve(ticker, "Cannot add order: instrument not covered by the exchange."), orderSide, shares, limit,
+                    orderType, timeInForce, participant);
+}
+
+/**
+ * @brief Adds an order to the order book of an instrument.
+ * @return The order's result; see Book::addOrderToBook.
+ */
+OrderResult Exchange::addOrder(InstrumentId instrument, Side orderSide, int shares, Price limit, OrderType orderType,
+                               TimeInForce timeInForce, ParticipantId participant) {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::runtime_error("Cannot add order: instrument not covered by the exchange.");
+    }
+    Clock::Message stamp(clock);
+    if (journal) {
+        journal->logAddOrder(instrument, orderSide, shares, limit, orderType, timeInForce, participant, stamp.time());
+    }
+
+    if (orderType == OrderType::Limit && limit == NO_PRICE) {
+        throw std::invalid_argument("Limit price must be provided for limit orders.");
+    }
+    const OrderResult result =
+        instrumentBook->addOrderToBook(orderSide, shares, limit, orderType, globalOrderId, timeInForce, participant);
+    publish(instrument, *instrumentBook);
+    return result;
+}
+
+/**
+ * @brief Adds a burst of orders to one instrument; see Book::submitBatch.
+ *        Each order is journaled individually, so replay reproduces the batch exactly.
+ * @return Number of requests processed. An unknown instrument rejects every request.
+ * @throws std::invalid_argument if results is shorter than requests.
+ */
+size_t Exchange::submitBatch(InstrumentId instrument, std::span<const OrderRequest> requests, std::span<OrderResult> results) {
+    if (results.size() < requests.size()) {
+        throw std::invalid_argument("Result span is smaller than the batch.");
+    }
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            results[i] = {-1, 0, OrderStatus::RejectedUnknownInstrument};
+        }
+        return requests.size();
+    }
+    Clock::Message stamp(clock);
+    if (journal) {
+        for (const OrderRequest& request : requests) {
+            journal->logAddOrder(instrument, request.side, request.shares, request.limit, request.type, request.timeInForce,
+                                 request.participant, stamp.time());
+        }
+    }
+    const size_t processed = instrumentBook->submitBatch(requests, results, globalOrderId);
+    publish(instrument, *instrumentBook);
+    return processed;
+}
+
+/**
+ * @brief Adds a stop (limit == NO_PRICE) or stop-limit order to the order book of a specific ticker.
+ * @return The order's result; see Book::addStopOrder.
+ */
+OrderResult Exchange::addStopOrder(const std::string& ticker, Side orderSide, int shares, Price stopPrice, Price limit,
+                                   ParticipantId participant) {
+    return addStopOrder(resolve(ticker, "Cannot add order: instrument not covered by the exchange."), orderSide, shares,
+                        stopPrice, limit, participant);
+}
+
+/**
+ * @brief Adds a stop (limit == NO_PRICE) or stop-limit order to the order book of an instrument.
+ * @return The order's result; see Book::addStopOrder.
  */
-void Exchange::addOrder(const std::string& ticker, Side orderSide, int shares, float limit, OrderType orderType) {
-    Book* instrumentBook = getOrderBook(ticker);
+OrderResult Exchange::addStopOrder(InstrumentId instrument, Side orderSide, int shares, Price stopPrice, Price limit,
+                                   ParticipantId participant) {
+    Book* instrumentBook = getOrderBook(instrument);
     if (!instrumentBook) {
         throw std::runtime_error("Cannot add order: instrument not covered by the exchange.");
     }
+    Clock::Message stamp(clock);
+    if (journal) {
+        journal->logAddStopOrder(instrument, orderSide, shares, stopPrice, limit, participant, stamp.time());
+    }
+    const OrderResult result = instrumentBook->addStopOrder(orderSide, shares, stopPrice, limit, globalOrderId, participant);
+    publish(instrument, *instrumentBook);
+    return result;
+}
+
+/**
+ * @brief Cancels an order.
+ */
+void Exchange::cancelOrder(const std::string& ticker, int64_t orderId) {
+    cancelOrder(resolve(ticker, "Cannot cancel order: instrument not covered by the exchange."), orderId);
+}
+
+/**
+ * @brief Cancels an order on an instrument.
+ */
+void Exchange::cancelOrder(InstrumentId instrument, int64_t orderId) {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::runtime_error("Cannot cancel order: instrument not covered by the exchange.");
+    }
+    if (journal) {
+        journal->logCancelOrder(instrument, orderId, clock.now());
+    }
+    instrumentBook->cancelOrder(orderId);
+    publish(instrument, *instrumentBook);
+}
+
+/**
+ * @brief Cancels an order on an instrument through its handle; see Book::cancelOrder(OrderHandle).
+ *        A stale handle is not journaled, since it leaves the book untouched.
+ */
+OrderStatus Exchange::cancelOrder(InstrumentId instrument, OrderHandle handle) {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::runtime_error("Cannot cancel order: instrument not covered by the exchange.");
+    }
+    if (journal) {
+        if (const Order* order = instrumentBook->findOrder(handle)) {
+            journal->logCancelOrder(instrument, order->getOrderId(), clock.now());
+        }
+    }
+    const OrderStatus status = instrumentBook->cancelOrder(handle);
+    publish(instrument, *instrumentBook);
+    return status;
+}
 
-    if (orderType == OrderType::Limit) {
-        if (limit == -1) {
-            throw std::invalid_argument("Limit price must be provided for limit orders.");
+/**
+ * @brief Cancels every order of a participant on every instrument, e.g. when its session drops.
+ *        Only instruments where the participant has orders are journaled.
+ * @return Number of orders canceled.
+ */
+size_t Exchange::massCancel(ParticipantId participant) {
+    size_t canceled = 0;
+    for (size_t i = 0; i < books.size(); ++i) {
+        if (books[i] && books[i]->getParticipants().count(participant) > 0) {
+            canceled += massCancel(InstrumentId{static_cast<uint32_t>(i)}, participant);
         }
-        instrumentBook->addOrderToBook(orderSide, shares, limit, orderType, globalOrderId);
-    } else if (orderType == OrderType::Market) {
-        instrumentBook->placeMarketOrder(shares, orderSide);
     }
+    return canceled;
+}
+
+/**
+ * @brief Cancels every order of a participant on an instrument; see Book::massCancel(ParticipantId).
+ * @return Number of orders canceled.
+ */
+size_t Exchange::massCancel(InstrumentId instrument, ParticipantId participant) {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::runtime_error("Cannot cancel orders: instrument not covered by the exchange.");
+    }
+    if (journal) {
+        journal->logMassCancel(instrument, participant, clock.now());
+    }
+    const size_t canceled = instrumentBook->massCancel(participant);
+    publish(instrument, *instrumentBook);
+    return canceled;
+}
+
+/**
+ * @brief Cancels every order resting on one side of an instrument.
+ * @return Number of orders canceled.
+ */
+size_t Exchange::massCancel(InstrumentId instrument, Side side) {
+    return massCancel(instrument, side, LOBSide<Side::Buy>::MIN_PRICE, LOBSide<Side::Buy>::MAX_PRICE);
+}
+
+/**
+ * @brief Cancels every order resting on one side of an instrument within a price range;
+ *        see Book::massCancel(Side, Price, Price).
+ * @return Number of orders canceled.
+ */
+size_t Exchange::massCancel(InstrumentId instrument, Side side, Price low, Price high) {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::runtime_error("Cannot cancel orders: instrument not covered by the exchange.");
+    }
+    if (journal) {
+        journal->logMassCancel(instrument, side, low, high, clock.now());
+    }
+    const size_t canceled = instrumentBook->massCancel(side, low, high);
+    publish(instrument, *instrumentBook);
+    return canceled;
 }
 
 /**
  * @brief Modifies the limit price of an order.
  */
-void Exchange::modifyLimitPrice(const std::string& ticker, int64_t orderId, int newLimitPrice) {
-    Book* instrumentBook = getOrderBook(ticker);
+void Exchange::modifyLimitPrice(const std::string& ticker, int64_t orderId, Price newLimitPrice) {
+    modifyLimitPrice(resolve(ticker, "Cannot modify price: instrument not covered by the exchange."), orderId, newLimitPrice);
+}
+
+/**
+ * @brief Modifies the limit price of an order on an instrument.
+ */
+void Exchange::modifyLimitPrice(InstrumentId instrument, int64_t orderId, Price newLimitPrice) {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::runtime_error("Cannot modify price: instrument not covered by the exchange.");
+    }
+    Clock::Message stamp(clock);
+    if (journal) {
+        journal->logModifyLimitPrice(instrument, orderId, newLimitPrice, stamp.time());
+    }
+    instrumentBook->modifyOrderLimitPrice(orderId, newLimitPrice);
+    publish(instrument, *instrumentBook);
+}
+
+/**
+ * @brief Modifies the limit price of an order on an instrument through its handle;
+ *        see Book::modifyOrderLimitPrice(OrderHandle, Price).
+ */
+OrderResult Exchange::modifyLimitPrice(InstrumentId instrument, OrderHandle handle, Price newLimitPrice) {
+    Book* instrumentBook = getOrderBook(instrument);
     if (!instrumentBook) {
         throw std::runtime_error("Cannot modify price: instrument not covered by the exchange.");
     }
-    instrumentBook->modifyOrderLimitPrice(orderId, static_cast<float>(newLimitPrice), globalOrderId);
+    Clock::Message stamp(clock);
+    if (journal) {
+        if (const Order* order = instrumentBook->findOrder(handle)) {
+            journal->logModifyLimitPrice(instrument, order->getOrderId(), newLimitPrice, stamp.time());
+        }
+    }
+    const OrderResult result = instrumentBook->modifyOrderLimitPrice(handle, newLimitPrice);
+    publish(instrument, *instrumentBook);
+    return result;
 }
 
 /**
  * @brief Modifies the size of an order.
  */
 void Exchange::modifyOrderSize(const std::string& ticker, int64_t orderId, int newSize) {
-    Book* instrumentBook = getOrderBook(ticker);
+    modifyOrderSize(resolve(ticker, "Cannot modify size: instrument not covered by the exchange."), orderId, newSize);
+}
+
+/**
+ * @brief Modifies the size of an order on an instrument.
+ * @throws std::invalid_argument if newSize <= 0; the command is then not journaled.
+ */
+void Exchange::modifyOrderSize(InstrumentId instrument, int64_t orderId, int newSize) {
+    Book* instrumentBook = getOrderBook(instrument);
     if (!instrumentBook) {
         throw std::runtime_error("Cannot modify size: instrument not covered by the exchange.");
     }
+    if (newSize <= 0) {
+        throw std::invalid_argument("The order size must be positive");
+    }
+    Clock::Message stamp(clock);
+    if (journal) {
+        journal->logModifyOrderSize(instrument, orderId, newSize, stamp.time());
+    }
     instrumentBook->modifyOrderSize(orderId, newSize);
+    publish(instrument, *instrumentBook);
+}
+
+/**
+ * @brief Modifies the size of an order on an instrument through its handle;
+ *        see Book::modifyOrderSize(OrderHandle, int). Rejected sizes are not journaled.
+ */
+OrderStatus Exchange::modifyOrderSize(InstrumentId instrument, OrderHandle handle, int newSize) {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::runtime_error("Cannot modify size: instrument not covered by the exchange.");
+    }
+    Clock::Message stamp(clock);
+    if (journal && newSize > 0) {
+        if (const Order* order = instrumentBook->findOrder(handle)) {
+            journal->logModifyOrderSize(instrument, order->getOrderId(), newSize, stamp.time());
+        }
+    }
+    const OrderStatus status = instrumentBook->modifyOrderSize(handle, newSize);
+    publish(instrument, *instrumentBook);
+    return status;
 }
 
 /**
  * @brief Adds a new instrument to the exchange.
+ * @param newTicker The instrument's ticker.
+ * @param tickScale How the instrument's decimal prices map to the integer ticks its book uses.
+ * @param matchingPolicy How the instrument's book allocates fills within a price level.
+ * @return The instrument's ID; listing a ticker twice returns the existing ID and keeps its settings.
+ * @throws std::invalid_argument if the matching policy is invalid.
  */
-void Exchange::addInstrument(const std::string& newTicker) {
-    tickerLob.emplace(newTicker, std::make_unique<Book>());
+InstrumentId Exchange::addInstrument(const std::string& newTicker, TickScale tickScale, MatchingPolicy matchingPolicy) {
+    auto existing = tickerIds.find(newTicker);
+    if (existing != tickerIds.end()) {
+        return existing->second;
+    }
+
+    auto book = std::make_unique<Book>(matchingPolicy);
+    if (journal) {
+        journal->logAddInstrument(newTicker, tickScale.getTicksPerUnit(), matchingPolicy);
+    }
+    const InstrumentId instrument{static_cast<uint32_t>(books.size())};
+    connect(instrument, *book);
+    books.push_back(std::move(book));
+    tickScales.push_back(tickScale);
+    tickerIds.emplace(newTicker, instrument);
+    return instrument;
 }
 
 /**
  * @brief Removes an instrument from the exchange.
  */
 void Exchange::removeInstrument(const std::string& ticker) {
-    tickerLob.erase(ticker);
+    auto it = tickerIds.find(ticker);
+    if (it != tickerIds.end()) {
+        removeInstrument(it->second);
+    }
+}
+
+/**
+ * @brief Removes an instrument from the exchange by ID.
+ */
+void Exchange::removeInstrument(InstrumentId instrument) {
+    if (!getOrderBook(instrument)) {
+        return;
+    }
+    if (journal) {
+        journal->logRemoveInstrument(instrument);
+    }
+    books[instrument.value].reset();
+    std::erase_if(tickerIds, [instrument](const auto& entry) { return entry.second == instrument; });
+}
+
+/**
+ * @brief Looks up the ID of a listed ticker.
+ */
+std::optional<InstrumentId> Exchange::findInstrument(const std::string& ticker) const {
+    auto it = tickerIds.find(ticker);
+    if (it != tickerIds.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Returns the tick scale an instrument was listed with, for converting decimal prices at the edge.
+ * @throws std::invalid_argument if the instrument was never listed.
+ */
+const TickScale& Exchange::getTickScale(InstrumentId instrument) const {
+    if (instrument.value >= tickScales.size()) {
+        throw std::invalid_argument("Instrument is not covered by the exchange.");
+    }
+    return tickScales[instrument.value];
 }
 
 /**
@@ -67,7 +376,7 @@ void Exchange::removeInstrument(const std::string& ticker) {
  */
 std::vector<std::string> Exchange::getTickerList() const {
     std::vector<std::string> tickers;
-    for (const auto& pair : tickerLob) {
+    for (const auto& pair : tickerIds) {
         tickers.push_back(pair.first);
     }
     return tickers;
@@ -77,9 +386,16 @@ std::vector<std::string> Exchange::getTickerList() const {
  * @brief Retrieves the order book for a ticker.
  */
 Book* Exchange::getOrderBook(const std::string& ticker) const {
-    auto it = tickerLob.find(ticker);
-    if (it != tickerLob.end()) {
-        return it->second.get();
+    auto instrument = findInstrument(ticker);
+    return instrument ? getOrderBook(*instrument) : nullptr;
+}
+
+/**
+ * @brief Retrieves the order book for an instrument.
+ */
+Book* Exchange::getOrderBook(InstrumentId instrument) const {
+    if (instrument.value < books.size()) {
+        return books[instrument.value].get();
     }
     return nullptr;
 }
@@ -87,14 +403,25 @@ Book* Exchange::getOrderBook(const std::string& ticker) const {
 /**
  * @brief Retrieves the National Best Bid and Offer (NBBO) for a ticker.
  */
-std::pair<std::optional<int>, std::optional<int>> Exchange::getNBBO(const std::string& ticker) const {
-    Book* instrumentBook = getOrderBook(ticker);
+std::pair<std::optional<Price>, std::optional<Price>> Exchange::getNBBO(const std::string& ticker) const {
+    auto instrument = findInstrument(ticker);
+    if (!instrument) {
+        throw std::invalid_argument("Instrument is not covered by the exchange.");
+    }
+    return getNBBO(*instrument);
+}
+
+/**
+ * @brief Retrieves the National Best Bid and Offer (NBBO) for an instrument.
+ */
+std::pair<std::optional<Price>, std::optional<Price>> Exchange::getNBBO(InstrumentId instrument) const {
+    Book* instrumentBook = getOrderBook(instrument);
     if (!instrumentBook) {
         throw std::invalid_argument("Instrument is not covered by the exchange.");
     }
 
-    std::optional<int> bestBid;
-    std::optional<int> bestOffer;
+    std::optional<Price> bestBid;
+    std::optional<Price> bestOffer;
 
     const Limit* bestBidLimit = instrumentBook->getBuySide().getBestLimit();
     if (bestBidLimit) {
@@ -108,3 +435,271 @@ std::pair<std::optional<int>, std::optional<int>> Exchange::getNBBO(const std::s
 
     return {bestBid, bestOffer};
 }
+
+/**
+ * @brief Retrieves the top of book slot of an instrument. Unlike getNBBO, the slot may be read from
+ *        any thread while orders are matched; it stays valid until the instrument is removed.
+ * @throws std::invalid_argument if the instrument is not listed.
+ */
+const TopOfBookSlot& Exchange::getTopOfBook(InstrumentId instrument) const {
+    Book* instrumentBook = getOrderBook(instrument);
+    if (!instrumentBook) {
+        throw std::invalid_argument("Instrument is not covered by the exchange.");
+    }
+    return instrumentBook->getTopOfBook();
+}
+
+/**
+ * @brief Captures every listed instrument, its resting orders and the order ID sequence.
+ *
+ * The exchange must be quiescent for the duration of the call, which only copies resting orders
+ * into memory; persisting the returned buffer can happen while matching continues.
+ *
+ * @return A compact binary snapshot accepted by restoreSnapshot.
+ */
+std::vector<char> Exchange::snapshot() const {
+    std::vector<char> data;
+    SnapshotWriter writer(data);
+    writer.put(SNAPSHOT_MAGIC);
+    writer.put(SNAPSHOT_VERSION);
+    writer.put(static_cast<uint32_t>(books.size()));
+    writer.put(globalOrderId.peekNextId());
+
+    std::vector<const std::string*> tickers(books.size(), nullptr);
+    for (const auto& [ticker, instrument] : tickerIds) {
+        tickers[instrument.value] = &ticker;
+    }
+
+    for (size_t i = 0; i < books.size(); ++i) {
+        writer.put<uint8_t>(books[i] ? 1 : 0);
+        if (!books[i]) {
+            continue;
+        }
+        writer.put(static_cast<uint16_t>(tickers[i]->size()));
+        std::memcpy(writer.extend(tickers[i]->size()), tickers[i]->data(), tickers[i]->size());
+        writer.put(tickScales[i].getTicksPerUnit());
+        const MatchingPolicy& matching = books[i]->getMatchingPolicy();
+        writer.put(static_cast<uint8_t>(matching.algorithm));
+        writer.put(static_cast<uint8_t>(matching.rounding));
+        writer.put(matching.topOrderPercent);
+        writer.put(static_cast<uint8_t>(matching.selfTradePrevention));
+        books[i]->writeSnapshot(writer);
+    }
+    return data;
+}
+
+/**
+ * @brief Writes a snapshot of the exchange to a file.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void Exchange::saveSnapshot(const std::string& path) const {
+    const std::vector<char> data = snapshot();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out) {
+        throw std::runtime_error("Cannot write snapshot: " + path);
+    }
+}
+
+/**
+ * @brief Rebuilds instruments, books and the order ID sequence from a snapshot.
+ *
+ * Instrument IDs are preserved, including the gaps left by removed instruments. Nothing is
+ * changed unless the whole snapshot restores successfully; the restored levels are then
+ * published to the depth handler.
+ *
+ * @param data A buffer produced by snapshot().
+ * @throws std::runtime_error if the exchange already lists instruments, the snapshot is malformed,
+ *         or its next order ID is not above every restored order ID.
+ */
+void Exchange::restoreSnapshot(std::span<const char> data) {
+    if (!books.empty()) {
+        throw std::runtime_error("Cannot restore a snapshot into an exchange with instruments.");
+    }
+
+    SnapshotReader reader(data);
+    if (reader.get<uint64_t>() != SNAPSHOT_MAGIC || reader.get<uint32_t>() != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Not a supported exchange snapshot.");
+    }
+    const uint32_t slotCount = reader.get<uint32_t>();
+    const int64_t nextOrderId = reader.get<int64_t>();
+
+    std::vector<std::unique_ptr<Book>> restoredBooks(slotCount);
+    std::vector<TickScale> restoredScales(slotCount);
+    std::unordered_map<std::string, InstrumentId> restoredIds;
+    int64_t maxOrderId = -1;
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        if (reader.get<uint8_t>() == 0) {
+            continue;
+        }
+        const uint16_t tickerLength = reader.get<uint16_t>();
+        std::string ticker(reader.take(tickerLength), tickerLength);
+        const int32_t ticksPerUnit = reader.get<int32_t>();
+        if (ticksPerUnit <= 0) {
+            throw std::runtime_error("Snapshot tick scale is invalid.");
+        }
+        MatchingPolicy matching;
+        matching.algorithm = static_cast<MatchingAlgorithm>(reader.get<uint8_t>());
+        matching.rounding = static_cast<ProRataRounding>(reader.get<uint8_t>());
+        matching.topOrderPercent = reader.get<int32_t>();
+        matching.selfTradePrevention = static_cast<SelfTradePrevention>(reader.get<uint8_t>());
+        if (matching.algorithm > MatchingAlgorithm::TopOrderProRata || matching.rounding > ProRataRounding::Nearest ||
+            matching.topOrderPercent < 0 || matching.topOrderPercent > 100 ||
+            matching.selfTradePrevention > SelfTradePrevention::DecrementAndCancel) {
+            throw std::runtime_error("Snapshot matching policy is invalid.");
+        }
+        restoredScales[i] = TickScale(ticksPerUnit);
+        restoredBooks[i] = std::make_unique<Book>(matching);
+        connect(InstrumentId{i}, *restoredBooks[i]);
+        maxOrderId = std::max(maxOrderId, restoredBooks[i]->restoreSnapshot(reader));
+        restoredIds.emplace(std::move(ticker), InstrumentId{i});
+    }
+    if (!reader.atEnd()) {
+        throw std::runtime_error("Snapshot has trailing data.");
+    }
+    if (nextOrderId <= maxOrderId) {
+        throw std::runtime_error("Snapshot order ID sequence would reissue a restored order ID.");
+    }
+
+    books = std::move(restoredBooks);
+    tickScales = std::move(restoredScales);
+    tickerIds = std::move(restoredIds);
+    globalOrderId.reset(nextOrderId);
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        if (books[i]) {
+            publish(InstrumentId{i}, *books[i]);
+        }
+    }
+}
+
+/**
+ * @brief Restores the exchange from a snapshot file written by saveSnapshot.
+ * @throws std::runtime_error if the file cannot be read or restoreSnapshot fails.
+ */
+void Exchange::loadSnapshot(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Cannot read snapshot: " + path);
+    }
+    std::vector<char> data(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(data.data(), static_cast<std::streamsize>(data.size()));
+    restoreSnapshot(data);
+}
+
+/**
+ * @brief Starts logging every inbound command to a journal before it is applied.
+ * @param newJournal The journal to append to, or nullptr to stop journaling.
+ */
+void Exchange::attachJournal(std::unique_ptr<Journal> newJournal) {
+    journal = std::move(newJournal);
+}
+
+/**
+ * @brief Installs the consumer of execution reports, called with the instrument they belong to
+ *        after each message that traded, and mid-message if a sweep fills a book's report ring.
+ *        Without a handler, executions are discarded once each message has been applied.
+ */
+void Exchange::setExecutionHandler(ExecutionHandler handler) {
+    executionHandler = std::move(handler);
+}
+
+/**
+ * @brief Installs the consumer of L2 depth updates, called with the instrument and book they belong to
+ *        after each message that changed a level. Without a handler, depth updates are discarded.
+ */
+void Exchange::setDepthHandler(DepthHandler handler) {
+    depthHandler = std::move(handler);
+}
+
+/**
+ * @brief Returns the attached journal, or nullptr if journaling is off.
+ */
+Journal* Exchange::getJournal() const {
+    return journal.get();
+}
+
+/**
+ * @brief Housekeeping for an idle gateway loop or timer: syncs journal records that have waited
+ *        longer than the journal's EveryMicros interval, since appends alone only sync when the
+ *        next message arrives.
+ */
+void Exchange::poll() {
+    if (journal) {
+        journal->poll(clock.now());
+    }
+}
+
+/**
+ * @brief Returns the clock shared by every book, e.g. to move a virtual clock.
+ */
+Clock& Exchange::getClock() {
+    return clock;
+}
+
+/**
+ * @brief Merges one operation's latency histograms across every book.
+ *
+ * The histograms may be read while the books are matching, but not while instruments are
+ * being added or removed. Empty unless built with EXCHANGE_ENABLE_LATENCY_STATS.
+ *
+ * @param op The operation.
+ * @return The merged distribution, with percentile and max queries.
+ */
+LatencyDistribution Exchange::getLatency(LatencyOp op) const {
+    LatencyDistribution distribution;
+    for (const std::unique_ptr<Book>& book : books) {
+        if (book) {
+            book->getLatencyStats().mergeInto(op, distribution);
+        }
+    }
+    return distribution;
+}
+
+/**
+ * @brief Resolves a ticker to its instrument ID for the string API.
+ * @throws std::runtime_error with the given message if the ticker is not listed.
+ */
+InstrumentId Exchange::resolve(const std::string& ticker, const char* error) const {
+    auto it = tickerIds.find(ticker);
+    if (it == tickerIds.end()) {
+        throw std::runtime_error(error);
+    }
+    return it->second;
+}
+
+/**
+ * @brief Wires a new book to the shared clock and routes the overflow of its rings to the handlers.
+ */
+void Exchange::connect(InstrumentId instrument, Book& book) {
+    book.setClock(clock);
+    book.getExecutions().setOverflowHandler([this, instrument](std::span<const ExecutionReport> batch) {
+        if (executionHandler) {
+            executionHandler(instrument, batch);
+        }
+    });
+    book.getDepthUpdates().setOverflowHandler([this, instrument, &book](std::span<const DepthUpdate> batch) {
+        if (depthHandler) {
+            depthHandler(instrument, book, batch);
+        }
+    });
+}
+
+/**
+ * @brief Hands what one message produced on a book to the handlers, so its buffers never outlive the message.
+ */
+void Exchange::publish(InstrumentId instrument, Book& book) {
+    ExecutionReportBuffer& executions = book.getExecutions();
+    if (executionHandler) {
+        executions.drain([&](std::span<const ExecutionReport> batch) { executionHandler(instrument, batch); });
+    } else {
+        executions.drain([](std::span<const ExecutionReport>) {});
+    }
+
+    DepthUpdateBuffer& depthUpdates = book.getDepthUpdates();
+    if (depthHandler) {
+        depthUpdates.drain([&](std::span<const DepthUpdate> batch) { depthHandler(instrument, book, batch); });
+    } else {
+        depthUpdates.drain([](std::span<const DepthUpdate>) {});
+    }
+}
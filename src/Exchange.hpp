@@ -28,6 +28,13 @@
 #define Exchange_hpp
 
 #include "Book.h"
+#include "Clock.h"
+#include "InstrumentId.h"
+#include "Journal.h"
+#include "Price.h"
+#include <functional>
+#include <memory>
+#include <span>
 #include <cassert>
 #include <utility>
 #include <optional>
@@ -42,31 +49,90 @@
 
 class Exchange {
 public:
-    Exchange(const std::string& exchangeName);
+    using ExecutionHandler = std::function<void(InstrumentId instrument, std::span<const ExecutionReport>)>;
+    using DepthHandler = std::function<void(InstrumentId instrument, const Book& book, std::span<const DepthUpdate>)>;
+
+    Exchange(const std::string& exchangeName, ClockSource clockSource = ClockSource::Monotonic);
+    
+    OrderResult addOrder(const std::string& ticker, Side orderSide, int shares, Price limit, OrderType orderType,
+                         TimeInForce timeInForce = TimeInForce::GoodTillCancel, ParticipantId participant = NO_PARTICIPANT);
+    OrderResult addOrder(InstrumentId instrument, Side orderSide, int shares, Price limit, OrderType orderType,
+                         TimeInForce timeInForce = TimeInForce::GoodTillCancel, ParticipantId participant = NO_PARTICIPANT);
+    size_t submitBatch(InstrumentId instrument, std::span<const OrderRequest> requests, std::span<OrderResult> results);
+    OrderResult addStopOrder(const std::string& ticker, Side orderSide, int shares, Price stopPrice, Price limit = NO_PRICE,
+                             ParticipantId participant = NO_PARTICIPANT);
+    OrderResult addStopOrder(InstrumentId instrument, Side orderSide, int shares, Price stopPrice, Price limit = NO_PRICE,
+                             ParticipantId participant = NO_PARTICIPANT);
     
-    void addOrder(const std::string& ticker, Side orderSide, int shares, float limit, OrderType orderType);
+    void cancelOrder(const std::string& ticker, int64_t orderId);
+    void cancelOrder(InstrumentId instrument, int64_t orderId);
+    OrderStatus cancelOrder(InstrumentId instrument, OrderHandle handle);
+    size_t massCancel(ParticipantId participant);
+    size_t massCancel(InstrumentId instrument, ParticipantId participant);
+    size_t massCancel(InstrumentId instrument, Side side);
+    size_t massCancel(InstrumentId instrument, Side side, Price low, Price high);
     
-    void modifyLimitPrice(const std::string& ticker, int64_t orderId, int newLimitPrice);
+    void modifyLimitPrice(const std::string& ticker, int64_t orderId, Price newLimitPrice);
+    void modifyLimitPrice(InstrumentId instrument, int64_t orderId, Price newLimitPrice);
     void modifyOrderSize(const std::string& ticker, int64_t orderId, int newSize);
+    void modifyOrderSize(InstrumentId instrument, int64_t orderId, int newSize);
+    OrderResult modifyLimitPrice(InstrumentId instrument, OrderHandle handle, Price newLimitPrice);
+    OrderStatus modifyOrderSize(InstrumentId instrument, OrderHandle handle, int newSize);
     
-    void addInstrument(const std::string& newTicker);
+    InstrumentId addInstrument(const std::string& newTicker, TickScale tickScale = TickScale(),
+                               MatchingPolicy matchingPolicy = MatchingPolicy());
     void removeInstrument(const std::string& ticker);
+    void removeInstrument(InstrumentId instrument);
+    std::optional<InstrumentId> findInstrument(const std::string& ticker) const;
+    const TickScale& getTickScale(InstrumentId instrument) const;
     
     Book* getOrderBook(const std::string& ticker) const;
+    Book* getOrderBook(InstrumentId instrument) const;
     std::vector<std::string> getTickerList() const;
-    std::pair<std::optional<int>, std::optional<int>> getNBBO(const std::string& ticker) const;
+    std::pair<std::optional<Price>, std::optional<Price>> getNBBO(const std::string& ticker) const;
+    std::pair<std::optional<Price>, std::optional<Price>> getNBBO(InstrumentId instrument) const;
+    const TopOfBookSlot& getTopOfBook(InstrumentId instrument) const;
+    
+    std::vector<char> snapshot() const;
+    void saveSnapshot(const std::string& path) const;
+    void restoreSnapshot(std::span<const char> data);
+    void loadSnapshot(const std::string& path);
+    
+    void attachJournal(std::unique_ptr<Journal> newJournal);
+    Journal* getJournal() const;
+    void poll();
+    void setExecutionHandler(ExecutionHandler handler);
+    void setDepthHandler(DepthHandler handler);
+    Clock& getClock();
+    LatencyDistribution getLatency(LatencyOp op) const;
     
     // Deleted copy constructor and assignment operator to prevent copying
     Exchange(const Exchange&) = delete;
     Exchange& operator=(const Exchange&) = delete;
     
 private:
-    /// a map of ticker symbols to their respective order books
-    std::unordered_map<std::string, std::unique_ptr<Book>> tickerLob;
+    /// books indexed by InstrumentId; removed instruments leave an empty slot so IDs are never reused
+    std::vector<std::unique_ptr<Book>> books;
+    /// decimal price <-> tick conversion of each instrument, indexed like books
+    std::vector<TickScale> tickScales;
+    /// a map of ticker symbols to their instrument IDs, only consulted by the string API
+    std::unordered_map<std::string, InstrumentId> tickerIds;
     /// the name of the exchange
     std::string exchangeName;
     /// Order ID sequence generator
     OrderIdSequence globalOrderId;
+    /// write-ahead log of inbound commands, if journaling is enabled
+    std::unique_ptr<Journal> journal;
+    /// shared by every book, so each inbound command reads the time once
+    Clock clock;
+    /// consumer of every book's execution reports; empty discards them
+    ExecutionHandler executionHandler;
+    /// consumer of every book's L2 depth updates; empty discards them
+    DepthHandler depthHandler;
+
+    InstrumentId resolve(const std::string& ticker, const char* error) const;
+    void connect(InstrumentId instrument, Book& book);
+    void publish(InstrumentId instrument, Book& book);
 };
 
 #endif /* Exchange_hpp */
@@ -0,0 +1,86 @@
+#include "ExecutionReport.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+/**
+ * @brief Constructs the buffer with storage for at least the requested number of reports.
+ * @param capacity Requested capacity, rounded up to a power of two.
+ */
+ExecutionReportBuffer::ExecutionReportBuffer(size_t capacity)
+    : slots(std::bit_ceil(std::max<size_t>(capacity, 1))),
+      mask(slots.size() - 1),
+      readIndex(0),
+      writeIndex(0),
+      nextSequence(0),
+      dropped(0)
+{}
+
+/**
+ * @brief Copies up to out.size() of the oldest pending reports into out.
+ * @param out Destination span.
+ * @return Number of reports copied.
+ */
+size_t ExecutionReportBuffer::drain(std::span<ExecutionReport> out) {
+    const size_t count = std::min(out.size(), size());
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = slots[(readIndex + i) & mask];
+    }
+    readIndex += count;
+    return count;
+}
+
+/**
+ * @brief Returns the number of reports waiting to be drained.
+ */
+size_t ExecutionReportBuffer::size() const {
+    return static_cast<size_t>(writeIndex - readIndex);
+}
+
+/**
+ * @brief Checks whether there are no pending reports.
+ */
+bool ExecutionReportBuffer::empty() const {
+    return writeIndex == readIndex;
+}
+
+/**
+ * @brief Returns the number of reports the ring can hold before it overflows.
+ */
+size_t ExecutionReportBuffer::capacity() const {
+    return slots.size();
+}
+
+/**
+ * @brief Returns the sequence number the next recorded execution will carry.
+ */
+uint64_t ExecutionReportBuffer::getNextSequence() const {
+    return nextSequence;
+}
+
+/**
+ * @brief Returns how many reports were overwritten because the ring was full and no overflow handler was set.
+ */
+uint64_t ExecutionReportBuffer::getDroppedCount() const {
+    return dropped;
+}
+
+/**
+ * @brief Sets the consumer that receives the pending reports whenever a report arrives at a full ring.
+ * @param handler The consumer, or an empty function to overwrite the oldest report instead.
+ */
+void ExecutionReportBuffer::setOverflowHandler(OverflowHandler handler) {
+    onOverflow = std::move(handler);
+}
+
+/**
+ * @brief Makes room for one report: drains to the overflow handler, or drops the oldest report.
+ */
+void ExecutionReportBuffer::overflow() {
+    if (onOverflow) {
+        drain(onOverflow);
+    } else {
+        ++readIndex;
+        ++dropped;
+    }
+}
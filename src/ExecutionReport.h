@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include "Clock.h"
+#include "Side.hpp"
+
+/**
+ * @struct ExecutionReport
+ * @brief A single match between an incoming (aggressor) order and a resting order.
+ */
+struct ExecutionReport {
+    uint64_t sequence;       ///< per-book execution sequence number, starting at 0
+    Timestamp timestamp;     ///< time of the inbound message that caused the match, in ns
+    int64_t aggressorId;     ///< order ID of the incoming order (-1 if it was never assigned one)
+    int64_t restingId;       ///< order ID of the resting order that was hit
+    int32_t price;           ///< execution price (in ticks), always the resting order's limit
+    int32_t quantity;        ///< shares traded in this match
+    int32_t restingLeaves;   ///< shares left on the resting order after this match
+    int32_t aggressorLeaves; ///< shares left on the aggressor after this match
+    Side aggressorSide;      ///< side of the incoming order
+};
+
+/**
+ * @class ExecutionReportBuffer
+ * @brief Preallocated ring of execution reports written by the matching loop and drained in batches.
+ *
+ * The matching thread appends with record(), which is a couple of stores into
+ * preallocated storage. Consumers drain on the same thread between messages, either
+ * into their own span or through a callback that receives at most two contiguous
+ * batches. The capacity is fixed: when a report arrives at a full ring, the pending
+ * reports are handed to the overflow handler if one is set, so a sweep larger than the
+ * ring still reaches the consumer in order. Without a handler the oldest report is
+ * overwritten and counted in getDroppedCount().
+ */
+class ExecutionReportBuffer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+    using OverflowHandler = std::function<void(std::span<const ExecutionReport>)>;
+
+    explicit ExecutionReportBuffer(size_t capacity = DEFAULT_CAPACITY);
+
+    void record(const ExecutionReport& report);
+
+    template<typename Fn>
+    size_t drain(Fn&& onBatch);
+    size_t drain(std::span<ExecutionReport> out);
+
+    size_t size() const;
+    bool empty() const;
+    size_t capacity() const;
+    uint64_t getNextSequence() const;
+    uint64_t getDroppedCount() const;
+    void setOverflowHandler(OverflowHandler handler);
+
+private:
+    std::vector<ExecutionReport> slots;
+    size_t mask;
+    uint64_t readIndex;
+    uint64_t writeIndex;
+    uint64_t nextSequence;
+    uint64_t dropped;
+    OverflowHandler onOverflow;
+
+    void overflow();
+};
+
+/**
+ * @brief Appends a report, stamping it with the next execution sequence number.
+ * @param report The execution; its sequence field is overwritten.
+ */
+inline void ExecutionReportBuffer::record(const ExecutionReport& report) {
+    if (writeIndex - readIndex == slots.size()) [[unlikely]] {
+        overflow();
+    }
+    ExecutionReport& slot = slots[writeIndex & mask];
+    slot = report;
+    slot.sequence = nextSequence++;
+    ++writeIndex;
+}
+
+/**
+ * @brief Hands every pending report to a consumer and empties the buffer.
+ * @param onBatch Called with a std::span<const ExecutionReport>, once or twice if the ring wraps.
+ * @return Number of reports drained.
+ */
+template<typename Fn>
+size_t ExecutionReportBuffer::drain(Fn&& onBatch) {
+    const size_t pending = size();
+    if (pending == 0) {
+        return 0;
+    }
+
+    const size_t start = readIndex & mask;
+    const size_t first = std::min(pending, slots.size() - start);
+    onBatch(std::span<const ExecutionReport>(slots.data() + start, first));
+    if (first < pending) {
+        onBatch(std::span<const ExecutionReport>(slots.data(), pending - first));
+    }
+
+    readIndex = writeIndex;
+    return pending;
+}
@@ -0,0 +1,432 @@
+#include "Journal.h"
+#include "Exchange.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+size_t roundUp8(size_t n) {
+    return (n + 7) & ~size_t{7};
+}
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+} // namespace
+
+/**
+ * @brief Opens a journal for appending, creating and preallocating the file if needed.
+ *        An existing journal is scanned to its last complete record and appended to.
+ * @param path File path of the journal.
+ * @param options Sync policy and preallocation size.
+ * @throws std::runtime_error if the file cannot be opened, mapped or is not a journal.
+ */
+Journal::Journal(const std::string& path, JournalOptions options)
+    : fd(-1), base(nullptr), capacity(0), writeOffset(FILE_HEADER_SIZE), syncedOffset(FILE_HEADER_SIZE),
+      recordCount(0), unsyncedRecords(0), firstUnsyncedTime(0), latestTime(0), options(options)
+{
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open journal: " + path);
+    }
+
+    struct stat st {};
+    ::fstat(fd, &st);
+    const size_t existing = static_cast<size_t>(st.st_size);
+    map(std::max({existing, options.initialCapacity, FILE_HEADER_SIZE + pageSize()}));
+
+    if (existing == 0) {
+        std::memcpy(base, &MAGIC, sizeof(MAGIC));
+        return;
+    }
+
+    if (std::memcmp(base, &MAGIC, sizeof(MAGIC)) != 0) {
+        unmap();
+        ::close(fd);
+        throw std::runtime_error("Not a journal file: " + path);
+    }
+    while (writeOffset + sizeof(RecordHeader) <= capacity) {
+        const auto* header = reinterpret_cast<const RecordHeader*>(base + writeOffset);
+        if (header->type == RecordType::End || header->length == 0 || writeOffset + header->length > capacity) {
+            break;
+        }
+        writeOffset += header->length;
+        ++recordCount;
+    }
+    syncedOffset = writeOffset;
+}
+
+/**
+ * @brief Flushes outstanding records and releases the mapping. The file keeps its preallocated size.
+ */
+Journal::~Journal() {
+    sync();
+    unmap();
+    ::close(fd);
+}
+
+/**
+ * @brief Appends an instrument listing.
+ */
+void Journal::logAddInstrument(const std::string& ticker, int32_t ticksPerUnit, const MatchingPolicy& matching) {
+    CommandRecord record{};
+    record.header.type = RecordType::AddInstrument;
+    record.value = ticksPerUnit;
+    record.orderId = static_cast<int64_t>(matching.algorithm) | static_cast<int64_t>(matching.rounding) << 8
+                   | static_cast<int64_t>(matching.selfTradePrevention) << 16;
+    record.limit = matching.topOrderPercent;
+    record.tickerLength = static_cast<uint16_t>(ticker.size());
+    append(record, ticker.data(), ticker.size());
+}
+
+/**
+ * @brief Appends an instrument removal.
+ */
+void Journal::logRemoveInstrument(InstrumentId instrument) {
+    CommandRecord record{};
+    record.header.type = RecordType::RemoveInstrument;
+    record.instrument = instrument.value;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Appends a new order.
+ */
+void Journal::logAddOrder(InstrumentId instrument, Side side, int shares, Price limit, OrderType type, TimeInForce timeInForce,
+                          ParticipantId participant, Timestamp timestamp) {
+    CommandRecord record{};
+    record.header.type = RecordType::AddOrder;
+    record.instrument = instrument.value;
+    record.side = side;
+    record.orderType = type;
+    record.value = shares;
+    record.limit = limit;
+    record.orderId = static_cast<int64_t>(timeInForce);
+    record.participant = participant;
+    record.timestamp = timestamp;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Appends a cancel.
+ */
+void Journal::logCancelOrder(InstrumentId instrument, int64_t orderId, Timestamp timestamp) {
+    CommandRecord record{};
+    record.header.type = RecordType::CancelOrder;
+    record.instrument = instrument.value;
+    record.orderId = orderId;
+    record.timestamp = timestamp;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Appends a price modification.
+ */
+void Journal::logModifyLimitPrice(InstrumentId instrument, int64_t orderId, Price newLimitPrice, Timestamp timestamp) {
+    CommandRecord record{};
+    record.header.type = RecordType::ModifyLimitPrice;
+    record.instrument = instrument.value;
+    record.orderId = orderId;
+    record.value = newLimitPrice;
+    record.timestamp = timestamp;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Appends a size modification.
+ */
+void Journal::logModifyOrderSize(InstrumentId instrument, int64_t orderId, int newSize, Timestamp timestamp) {
+    CommandRecord record{};
+    record.header.type = RecordType::ModifyOrderSize;
+    record.instrument = instrument.value;
+    record.orderId = orderId;
+    record.value = newSize;
+    record.timestamp = timestamp;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Appends a new stop or stop-limit order.
+ */
+void Journal::logAddStopOrder(InstrumentId instrument, Side side, int shares, Price stopPrice, Price limit,
+                              ParticipantId participant, Timestamp timestamp) {
+    CommandRecord record{};
+    record.header.type = RecordType::AddStopOrder;
+    record.instrument = instrument.value;
+    record.side = side;
+    record.orderType = limit == NO_PRICE ? OrderType::Stop : OrderType::StopLimit;
+    record.orderId = stopPrice;
+    record.value = shares;
+    record.limit = limit;
+    record.participant = participant;
+    record.timestamp = timestamp;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Appends a cancel of every order of one participant on an instrument.
+ */
+void Journal::logMassCancel(InstrumentId instrument, ParticipantId participant, Timestamp timestamp) {
+    CommandRecord record{};
+    record.header.type = RecordType::MassCancelParticipant;
+    record.instrument = instrument.value;
+    record.participant = participant;
+    record.timestamp = timestamp;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Appends a cancel of every order resting on one side of an instrument within a price range.
+ */
+void Journal::logMassCancel(InstrumentId instrument, Side side, Price low, Price high, Timestamp timestamp) {
+    CommandRecord record{};
+    record.header.type = RecordType::MassCancelRange;
+    record.instrument = instrument.value;
+    record.side = side;
+    record.value = low;
+    record.limit = high;
+    record.timestamp = timestamp;
+    append(record, nullptr, 0);
+}
+
+/**
+ * @brief Forces every record appended so far to stable storage.
+ */
+void Journal::sync() {
+    if (writeOffset > syncedOffset) {
+        const size_t start = syncedOffset & ~(pageSize() - 1);
+        ::msync(base + start, writeOffset - start, MS_SYNC);
+        syncedOffset = writeOffset;
+    }
+    unsyncedRecords = 0;
+}
+
+/**
+ * @brief Syncs under the EveryMicros policy if the oldest unsynced record has waited long enough.
+ *        Lets an idle owner bound how long the last records of a burst stay unsynced.
+ * @param now Current message time, from the same clock that stamps the records.
+ */
+void Journal::poll(Timestamp now) {
+    if (options.policy == JournalSyncPolicy::EveryMicros && unsyncedRecords > 0
+        && now - firstUnsyncedTime >= static_cast<Timestamp>(options.syncEveryMicros) * 1000) {
+        sync();
+    }
+}
+
+/**
+ * @brief Returns the number of records in the journal, including those found when it was opened.
+ */
+uint64_t Journal::getRecordCount() const {
+    return recordCount;
+}
+
+/**
+ * @brief Returns the number of records appended since the last sync.
+ */
+uint64_t Journal::getUnsyncedRecords() const {
+    return unsyncedRecords;
+}
+
+/**
+ * @brief Returns the number of bytes used, including the file header.
+ */
+size_t Journal::getSize() const {
+    return writeOffset;
+}
+
+/**
+ * @brief Returns the number of bytes currently preallocated and mapped.
+ */
+size_t Journal::getCapacity() const {
+    return capacity;
+}
+
+/**
+ * @brief Re-applies every record of a journal to an exchange, in order.
+ *
+ * Commands that failed when they were first submitted fail the same way again and are skipped,
+ * so the rebuilt books and order ID sequence match the original exchange. An exchange on a
+ * virtual clock is moved to each order command's recorded time before it is applied.
+ *
+ * @param path File path of the journal.
+ * @param exchange A fresh exchange with no journal attached.
+ * @return Number of records replayed.
+ * @throws std::runtime_error if the file is not a journal or the exchange is journaling.
+ */
+uint64_t Journal::replay(const std::string& path, Exchange& exchange) {
+    if (exchange.getJournal()) {
+        throw std::runtime_error("Cannot replay into an exchange that is writing a journal.");
+    }
+
+    const int in = ::open(path.c_str(), O_RDONLY);
+    if (in < 0) {
+        throw std::runtime_error("Cannot open journal: " + path);
+    }
+    struct stat st {};
+    ::fstat(in, &st);
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size < FILE_HEADER_SIZE) {
+        ::close(in);
+        throw std::runtime_error("Not a journal file: " + path);
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, in, 0);
+    ::close(in);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot map journal: " + path);
+    }
+    const char* data = static_cast<const char*>(mapped);
+    if (std::memcmp(data, &MAGIC, sizeof(MAGIC)) != 0) {
+        ::munmap(mapped, size);
+        throw std::runtime_error("Not a journal file: " + path);
+    }
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    Clock& clock = exchange.getClock();
+    const bool virtualTime = clock.getSource() == ClockSource::Virtual;
+    uint64_t replayed = 0;
+    size_t offset = FILE_HEADER_SIZE;
+    while (offset + sizeof(CommandRecord) <= size) {
+        const auto* record = reinterpret_cast<const CommandRecord*>(data + offset);
+        if (record->header.type == RecordType::End || record->header.length == 0 || offset + record->header.length > size) {
+            break;
+        }
+
+        const InstrumentId instrument{record->instrument};
+        if (virtualTime && record->header.type >= RecordType::AddOrder) {
+            clock.setTime(record->timestamp);
+        }
+        try {
+            switch (record->header.type) {
+                case RecordType::AddInstrument:
+                    exchange.addInstrument(std::string(data + offset + sizeof(CommandRecord), record->tickerLength),
+                                           TickScale(record->value),
+                                           MatchingPolicy{static_cast<MatchingAlgorithm>(record->orderId & 0xff),
+                                                          static_cast<ProRataRounding>((record->orderId >> 8) & 0xff),
+                                                          record->limit,
+                                                          static_cast<SelfTradePrevention>((record->orderId >> 16) & 0xff)});
+                    break;
+                case RecordType::RemoveInstrument:
+                    exchange.removeInstrument(instrument);
+                    break;
+                case RecordType::AddOrder:
+                    exchange.addOrder(instrument, record->side, record->value, record->limit, record->orderType,
+                                      static_cast<TimeInForce>(record->orderId), record->participant);
+                    break;
+                case RecordType::CancelOrder:
+                    exchange.cancelOrder(instrument, record->orderId);
+                    break;
+                case RecordType::ModifyLimitPrice:
+                    exchange.modifyLimitPrice(instrument, record->orderId, record->value);
+                    break;
+                case RecordType::ModifyOrderSize:
+                    exchange.modifyOrderSize(instrument, record->orderId, record->value);
+                    break;
+                case RecordType::AddStopOrder:
+                    exchange.addStopOrder(instrument, record->side, record->value, static_cast<Price>(record->orderId),
+                                          record->limit, record->participant);
+                    break;
+                case RecordType::MassCancelParticipant:
+                    exchange.massCancel(instrument, record->participant);
+                    break;
+                case RecordType::MassCancelRange:
+                    exchange.massCancel(instrument, record->side, record->value, record->limit);
+                    break;
+                case RecordType::End:
+                    break;
+            }
+        } catch (const std::exception&) {
+            // the command was rejected the first time too
+        }
+
+        offset += record->header.length;
+        ++replayed;
+    }
+
+    ::munmap(mapped, size);
+    return replayed;
+}
+
+/**
+ * @brief Copies a record (and optional trailing bytes) to the end of the journal.
+ *        The header type is stored last, after a release fence, so a torn record reads as End.
+ */
+void Journal::append(const CommandRecord& record, const char* tail, size_t tailLength) {
+    const size_t length = sizeof(CommandRecord) + roundUp8(tailLength);
+    if (writeOffset + length + sizeof(RecordHeader) > capacity) {
+        map(std::max(capacity * 2, writeOffset + length + pageSize()));
+    }
+
+    char* dest = base + writeOffset;
+    std::memcpy(dest + sizeof(RecordHeader), reinterpret_cast<const char*>(&record) + sizeof(RecordHeader),
+                sizeof(CommandRecord) - sizeof(RecordHeader));
+    if (tailLength > 0) {
+        std::memcpy(dest + sizeof(CommandRecord), tail, tailLength);
+    }
+
+    auto* header = reinterpret_cast<RecordHeader*>(dest);
+    header->length = static_cast<uint32_t>(length);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->type = record.header.type;
+
+    writeOffset += length;
+    ++recordCount;
+    latestTime = std::max(latestTime, record.timestamp);
+    afterAppend(latestTime);
+}
+
+/**
+ * @brief Applies the sync policy after a record has been appended.
+ * @param now Message time of the record.
+ */
+void Journal::afterAppend(Timestamp now) {
+    if (unsyncedRecords++ == 0) {
+        firstUnsyncedTime = now;
+    }
+    switch (options.policy) {
+        case JournalSyncPolicy::None:
+            break;
+        case JournalSyncPolicy::EveryN:
+            if (unsyncedRecords >= options.syncEveryMessages) {
+                sync();
+            }
+            break;
+        case JournalSyncPolicy::EveryMicros:
+            poll(now);
+            break;
+    }
+}
+
+/**
+ * @brief Sizes the file to newCapacity bytes and maps it, replacing any existing mapping.
+ */
+void Journal::map(size_t newCapacity) {
+    newCapacity = (newCapacity + pageSize() - 1) & ~(pageSize() - 1);
+    unmap();
+    if (::ftruncate(fd, static_cast<off_t>(newCapacity)) != 0) {
+        throw std::runtime_error("Cannot preallocate journal");
+    }
+    void* mapped = ::mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot map journal");
+    }
+    base = static_cast<char*>(mapped);
+    capacity = newCapacity;
+}
+
+/**
+ * @brief Releases the current mapping, if any.
+ */
+void Journal::unmap() {
+    if (base) {
+        ::munmap(base, capacity);
+        base = nullptr;
+    }
+}
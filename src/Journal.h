@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Clock.h"
+#include "InstrumentId.h"
+#include "MatchingPolicy.hpp"
+#include "OrderType.h"
+#include "ParticipantId.h"
+#include "Price.h"
+#include "Side.hpp"
+
+class Exchange;
+
+/**
+ * @enum JournalSyncPolicy
+ * @brief When the journal forces its mapped pages to stable storage.
+ */
+enum class JournalSyncPolicy : uint8_t {
+    None,        ///< leave write-back to the OS; survives a process crash but not a power loss
+    EveryN,      ///< msync after every syncEveryMessages records
+    EveryMicros  ///< msync once the oldest unsynced record is syncEveryMicros old, by message time
+};
+
+/**
+ * @struct JournalOptions
+ * @brief Tuning knobs for a Journal.
+ */
+struct JournalOptions {
+    JournalSyncPolicy policy = JournalSyncPolicy::None;
+    uint64_t syncEveryMessages = 1024;
+    uint64_t syncEveryMicros = 1000;
+    size_t initialCapacity = size_t{64} << 20; // bytes preallocated on disk and mapped up front
+};
+
+/**
+ * @class Journal
+ * @brief Memory-mapped, preallocated, append-only write-ahead log of inbound Exchange commands.
+ *
+ * Every command is appended as a fixed-layout binary record before the exchange applies it.
+ * Appends are plain stores into the mapping, so the per-message cost is a few dozen bytes
+ * of memcpy plus whatever the sync policy asks for. The record header is written last,
+ * so a record torn by a crash reads as the end of the journal.
+ *
+ * EveryMicros measures age by the exchange's message timestamps, so it reads no clock of its own.
+ * It can only act when called, though: an append checks the age of the oldest unsynced record,
+ * and between messages the owner must call poll() (Exchange::poll() from an idle loop or timer),
+ * or records written just before a quiet period stay unsynced until the next message.
+ *
+ * Replaying a journal into a fresh Exchange re-applies the same commands in the same
+ * order, which reproduces the books and the order ID sequence exactly. If that exchange runs
+ * on a virtual clock, it is moved to each order command's recorded time, so replayed orders
+ * and executions carry their original timestamps too.
+ */
+class Journal {
+public:
+    enum class RecordType : uint8_t {
+        End = 0,
+        AddInstrument,
+        RemoveInstrument,
+        AddOrder,
+        CancelOrder,
+        ModifyLimitPrice,
+        ModifyOrderSize,
+        AddStopOrder,
+        MassCancelParticipant,
+        MassCancelRange
+    };
+
+    Journal(const std::string& path, JournalOptions options = {});
+    ~Journal();
+
+    void logAddInstrument(const std::string& ticker, int32_t ticksPerUnit, const MatchingPolicy& matching);
+    void logRemoveInstrument(InstrumentId instrument);
+    void logAddOrder(InstrumentId instrument, Side side, int shares, Price limit, OrderType type, TimeInForce timeInForce,
+                     ParticipantId participant, Timestamp timestamp);
+    void logCancelOrder(InstrumentId instrument, int64_t orderId, Timestamp timestamp);
+    void logModifyLimitPrice(InstrumentId instrument, int64_t orderId, Price newLimitPrice, Timestamp timestamp);
+    void logModifyOrderSize(InstrumentId instrument, int64_t orderId, int newSize, Timestamp timestamp);
+    void logAddStopOrder(InstrumentId instrument, Side side, int shares, Price stopPrice, Price limit,
+                         ParticipantId participant, Timestamp timestamp);
+    void logMassCancel(InstrumentId instrument, ParticipantId participant, Timestamp timestamp);
+    void logMassCancel(InstrumentId instrument, Side side, Price low, Price high, Timestamp timestamp);
+
+    void sync();
+    void poll(Timestamp now);
+
+    uint64_t getRecordCount() const;
+    uint64_t getUnsyncedRecords() const;
+    size_t getSize() const;
+    size_t getCapacity() const;
+
+    static uint64_t replay(const std::string& path, Exchange& exchange);
+
+    // disable copying
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+private:
+    /// Common prefix of every record; length covers header and payload and is a multiple of 8.
+    struct RecordHeader {
+        uint32_t length;
+        RecordType type;
+        uint8_t padding[3];
+    };
+
+    /// Payload shared by all order and instrument records.
+    struct CommandRecord {
+        RecordHeader header;
+        uint32_t instrument;
+        Side side;
+        OrderType orderType;
+        union {
+            uint16_t tickerLength;     // instrument records
+            ParticipantId participant; // order and mass cancel records
+        };
+        int64_t orderId; // order ID, a new order's time in force or stop price, or a listed instrument's matching algorithm | rounding << 8 | self-trade prevention << 16
+        int32_t value;  // shares, new size, new price, ticks per unit or the low end of a cancel range
+        Price limit;    // limit price, a listed instrument's top order percentage or the high end of a cancel range
+        Timestamp timestamp; // message time of order commands, in ns
+    };
+
+    static constexpr uint64_t MAGIC = 0x4c4e524a43584521ULL; // "!EXCJRNL"
+    static constexpr size_t FILE_HEADER_SIZE = 64;
+
+    int fd;
+    char* base;
+    size_t capacity;
+    size_t writeOffset;
+    size_t syncedOffset;
+    uint64_t recordCount;
+    uint64_t unsyncedRecords;
+    Timestamp firstUnsyncedTime; // message time of the oldest record not yet synced
+    Timestamp latestTime;        // latest message time seen, stamped on records that carry none
+    JournalOptions options;
+
+    void append(const CommandRecord& record, const char* tail, size_t tailLength);
+    void afterAppend(Timestamp now);
+    void map(size_t newCapacity);
+    void unmap();
+};
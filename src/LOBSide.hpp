@@ -1,15 +1,22 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
+#include <span>
 #include <stdexcept>
+#include "DepthUpdate.h"
+#include "LatencyStats.h"
 #include "Limit.h"
+#include "LimitLadder.h"
+#include "MatchingPolicy.hpp"
 #include "Order.h"
+#include "PriceBitmap.hpp"
 #include "Side.hpp"
 
 /**
  * @class LOBSide
- * @brief Manages one side of the order book (buy or sell) using a bitmap for fast price lookup.
+ * @brief Manages one side of the order book (buy or sell) using a hierarchical bitmap for fast price lookup.
  * @tparam S The side of the book (Side::Buy or Side::Sell).
  */
 template<Side S>
@@ -24,39 +31,68 @@ public:
 
     void addOrder(int32_t price, Order* order);
     void removeOrder(int32_t price, Order* order);
-    void executeMarket(int32_t volume);
-    void executeMatching(int32_t& volume);
+    void moveOrder(Order* order, int32_t newPrice);
+    void detachOrder(Order* order);
+    void settleDetached(std::span<const int32_t> prices);
+    template<typename OnRemoved>
+    size_t removeRange(int32_t low, int32_t high, OnRemoved&& onRemoved);
+    template<typename Policy, typename Check, typename OnFill, typename OnCancel>
+    int32_t executeMarket(int32_t volume, const Policy& policy, Check& check, OnFill&& onFill, OnCancel&& onCancel);
+    template<typename Policy, typename Check, typename OnFill, typename OnCancel>
+    void executeMatching(int32_t& volume, const Policy& policy, Check& check, OnFill&& onFill, OnCancel&& onCancel);
+    template<typename Policy, typename Check, typename OnFill, typename OnCancel>
+    void sweep(int32_t& volume, int32_t limitPrice, const Policy& policy, Check& check, OnFill&& onFill,
+               OnCancel&& onCancel);
     void adjustTotalVolume(int delta);
+    void resizeOrder(Order* order, int32_t newShares);
+    void restoreLevel(int32_t price, Order* const* orders, size_t count);
+    template<typename Fn>
+    void forEachLevel(Fn&& fn) const;
 
     Limit* getLimit(int32_t price);
     Limit* getBestLimit();
     int32_t getBestPrice() const;
     int32_t getTotalVolume() const;
+    const LimitLadder& getLadder() const;
+    size_t getDepth(std::span<DepthLevel> out) const;
+    int32_t getVolumeThrough(int32_t price, int32_t needed) const;
+    void prefetchLevel(int32_t price) const;
+    void prefetchTail(int32_t price) const;
+    void setDepthUpdates(DepthUpdateBuffer* updates);
+    void setLatencyStats(LatencyStats* stats);
 
 private:
-    std::vector<Limit> limits;
-    uint64_t bitmap[BITMAP_SIZE]{};
+    LimitLadder limits;
+    PriceBitmap<RANGE> bitmap;
     int32_t totalVolume;
     int32_t bestPrice;
+    DepthUpdateBuffer* depthUpdates;
+    LatencyStats* latencyStats;
 
+    void publishLevel(const Limit& limit);
+    template<typename Fn>
+    void timeLevel(Fn&& trade);
     void updateBestPrice();
+    static uint64_t bitsFrom(uint64_t word, int32_t price);
+    template<typename OnFill>
+    void consumeLevel(Limit& limit, OnFill& onFill);
+    template<typename Policy, typename OnCancel>
+    bool preventSelfTrades(Limit& limit, int32_t& volume, SelfTradeCheck& check, OnCancel& onCancel);
 };
 
 /**
  * @brief Constructs the LOBSide object.
- *        Initializes all price levels (Limit objects) across the configured price range,
- *        reserves storage for performance, and sets the initial best price based on the side.
+ *        Price levels are materialized lazily by the ladder, so construction only sets up
+ *        the page directory and the initial best price based on the side.
  */
 template<Side S>
 LOBSide<S>::LOBSide()
-    : totalVolume(0),
-      bestPrice(S == Side::Buy ? -1 : MAX_PRICE + 1)
-{
-    limits.reserve(RANGE);
-    for (int32_t i = 0; i < RANGE; ++i) {
-        limits.emplace_back(i);
-    }
-}
+    : limits(RANGE),
+      totalVolume(0),
+      bestPrice(S == Side::Buy ? -1 : MAX_PRICE + 1),
+      depthUpdates(nullptr),
+      latencyStats(nullptr)
+{}
 
 /**
  * @brief Adds a new order at the specified price.
@@ -66,16 +102,16 @@ LOBSide<S>::LOBSide()
  */
 template<Side S>
 void LOBSide<S>::addOrder(int32_t price, Order* order) {
-    auto& limit = limits[price];
+    auto& limit = limits.materialize(price);
     if (limit.empty()) {
-        int chunk = price / 64;
-        int bit = price % 64;
-        bitmap[chunk] |= (1ULL << bit);
+        bitmap.set(price);
+        limits.occupy(price);
     }
 
     limit.addOrder(order);
     order->setParentLimit(&limit);
     totalVolume += order->getShares();
+    publishLevel(limit);
 
     if constexpr (S == Side::Buy) {
         if (price > bestPrice)
@@ -94,26 +130,151 @@ void LOBSide<S>::addOrder(int32_t price, Order* order) {
  */
 template<Side S>
 void LOBSide<S>::removeOrder(int32_t price, Order* order) {
-    auto& limit = limits[price];
+    auto& limit = *limits.find(price);
+    limit.removeOrder(order);
+    totalVolume -= order->getShares();
+    publishLevel(limit);
+
+    if (limit.empty()) {
+        bitmap.clear(price);
+        limits.vacate(price);
+        if (price == bestPrice)
+            updateBestPrice();
+    }
+}
+
+/**
+ * @brief Moves a resting order to the back of the queue at another price on this side.
+ *
+ * The new level is occupied before the old one is vacated, so a move within one page never
+ * hands the page back to the ladder, and the best price is only searched for if the move
+ * emptied the best level and did not land on a better one.
+ *
+ * @param order The resting order.
+ * @param newPrice Its new price; must differ from the current one.
+ */
+template<Side S>
+void LOBSide<S>::moveOrder(Order* order, int32_t newPrice) {
+    Limit& from = *order->getParentLimit();
+    const int32_t oldPrice = from.getLimitPrice();
+    from.removeOrder(order);
+    from.adjustVolume(-order->getShares());
+    publishLevel(from);
+
+    Limit& to = limits.materialize(newPrice);
+    if (to.empty()) {
+        bitmap.set(newPrice);
+        limits.occupy(newPrice);
+    }
+    order->setLimit(newPrice);
+    to.addOrder(order);
+    order->setParentLimit(&to);
+    publishLevel(to);
+
+    const bool emptied = from.empty();
+    if (emptied) {
+        bitmap.clear(oldPrice);
+        limits.vacate(oldPrice);
+    }
+    if (S == Side::Buy ? newPrice > bestPrice : newPrice < bestPrice) {
+        bestPrice = newPrice;
+    } else if (emptied && oldPrice == bestPrice) {
+        updateBestPrice();
+    }
+}
+
+/**
+ * @brief Removes a resting order from its level without publishing the level or moving the
+ *        best price. For removing many orders at once: call settleDetached after the last one.
+ * @param order The resting order.
+ */
+template<Side S>
+void LOBSide<S>::detachOrder(Order* order) {
+    Limit& limit = *order->getParentLimit();
     limit.removeOrder(order);
+    limit.adjustVolume(-order->getShares());
     totalVolume -= order->getShares();
 
     if (limit.empty()) {
-        int chunk = price / 64;
-        int bit = price % 64;
-        bitmap[chunk] &= ~(1ULL << bit);
+        bitmap.clear(limit.getLimitPrice());
+        limits.vacate(limit.getLimitPrice());
+    }
+}
+
+/**
+ * @brief Publishes the final state of the levels detachOrder touched and recomputes the best
+ *        price if its level was emptied.
+ * @param prices Each touched price at least once; repeats only cost a repeated update.
+ */
+template<Side S>
+void LOBSide<S>::settleDetached(std::span<const int32_t> prices) {
+    for (int32_t price : prices) {
+        const Limit* limit = limits.find(price);
+        if (limit && !limit->empty()) {
+            publishLevel(*limit);
+        } else if (depthUpdates) {
+            depthUpdates->record(S, price, 0, 0);
+        }
+    }
+    if (bestPrice >= MIN_PRICE && bestPrice <= MAX_PRICE && !bitmap.test(bestPrice))
         updateBestPrice();
+}
+
+/**
+ * @brief Removes every order resting at prices in [low, high] in one pass.
+ *
+ * Occupied levels are found word by word in the bitmap. Each level's queue is handed over
+ * whole and the level emptied in one step, the bits of a word are cleared with one store, and
+ * the best price is recomputed once at the end.
+ *
+ * @param low Lowest price to clear.
+ * @param high Highest price to clear.
+ * @param onRemoved Called as onRemoved(order) for every removed order, once it is unlinked.
+ * @return Number of orders removed.
+ */
+template<Side S>
+template<typename OnRemoved>
+size_t LOBSide<S>::removeRange(int32_t low, int32_t high, OnRemoved&& onRemoved) {
+    low = std::max(low, MIN_PRICE);
+    high = std::min(high, MAX_PRICE);
+    size_t removed = 0;
+    int32_t price = low > high ? -1 : bitmap.findNext(low - 1);
+    while (price >= 0 && price <= high) {
+        const int32_t word = price >> 6;
+        uint64_t bits = bitmap.word(word) & (~0ULL << (price & 63));
+        if ((high >> 6) == word)
+            bits &= ~0ULL >> (63 - (high & 63));
+
+        for (uint64_t rest = bits; rest; rest &= rest - 1) {
+            Limit& limit = *limits.find((word << 6) + __builtin_ctzll(rest));
+            totalVolume -= limit.getTotalVolume();
+            removed += static_cast<size_t>(limit.getSize());
+            Order* order = limit.getHead();
+            limit.clear();
+            publishLevel(limit);
+            limits.vacate(limit.getLimitPrice());
+            while (order) {
+                Order* next = order->getNextOrder();
+                onRemoved(order);
+                order = next;
+            }
+        }
+        bitmap.clearBits(word, bits);
+        price = bitmap.findNext((word << 6) + 63);
     }
+    if (bestPrice >= MIN_PRICE && bestPrice <= MAX_PRICE && !bitmap.test(bestPrice))
+        updateBestPrice();
+    return removed;
 }
 
 /**
  * @brief Returns a pointer to the limit object at the given price.
  * @param price The price level.
- * @return Pointer to Limit.
+ * @return Pointer to Limit, or nullptr if no level in its page currently holds orders.
  */
 template<Side S>
 Limit* LOBSide<S>::getLimit(int32_t price) {
-    return &limits[price];
+    return limits.find(price);
 }
 
 /**
@@ -124,7 +285,7 @@ template<Side S>
 Limit* LOBSide<S>::getBestLimit() {
     if (bestPrice < MIN_PRICE || bestPrice > MAX_PRICE)
         return nullptr;
-    return &limits[bestPrice];
+    return limits.find(bestPrice);
 }
 
 /**
@@ -146,117 +307,379 @@ int32_t LOBSide<S>::getTotalVolume() const {
 }
 
 /**
- * @brief Updates the best price after orders are removed.
+ * @brief Returns the paged ladder holding this side's price levels.
+ * @return const reference to the LimitLadder.
  */
 template<Side S>
-void LOBSide<S>::updateBestPrice() {
-    bestPrice = S == Side::Buy ? -1 : MAX_PRICE + 1;
+const LimitLadder& LOBSide<S>::getLadder() const {
+    return limits;
+}
 
-    if constexpr (S == Side::Buy) {
-        for (int i = BITMAP_SIZE - 1; i >= 0; --i) {
-            if (bitmap[i]) {
-                int pos = 63 - __builtin_clzll(bitmap[i]);
-                bestPrice = i * 64 + pos;
-                return;
-            }
+/**
+ * @brief Sums the volume resting at prices at least as good as a limit, best level first,
+ *        without touching any order. Stops as soon as the sum reaches what is needed.
+ * @param price The limit: the highest price for the sell side, the lowest for the buy side.
+ * @param needed Volume after which the walk may stop.
+ * @return The volume found, at least needed if that much is available.
+ */
+template<Side S>
+int32_t LOBSide<S>::getVolumeThrough(int32_t price, int32_t needed) const {
+    int32_t volume = 0;
+    int32_t level = bestPrice;
+    while (volume < needed && level >= MIN_PRICE && level <= MAX_PRICE) {
+        if constexpr (S == Side::Buy) {
+            if (level < price)
+                break;
+            volume += limits.find(level)->getTotalVolume();
+            level = bitmap.findPrev(level);
+        } else {
+            if (level > price)
+                break;
+            volume += limits.find(level)->getTotalVolume();
+            level = bitmap.findNext(level);
         }
-    } else {
-        for (int i = 0; i < BITMAP_SIZE; ++i) {
-            if (bitmap[i]) {
-                int pos = __builtin_ctzll(bitmap[i]);
-                bestPrice = i * 64 + pos;
-                return;
-            }
+    }
+    return volume;
+}
+
+/**
+ * @brief Copies the best levels of this side, best price first, walking only occupied prices.
+ * @param out Destination; at most out.size() levels are written.
+ * @return Number of levels written.
+ */
+template<Side S>
+size_t LOBSide<S>::getDepth(std::span<DepthLevel> out) const {
+    size_t count = 0;
+    int32_t price = bestPrice;
+    while (count < out.size() && price >= MIN_PRICE && price <= MAX_PRICE) {
+        const Limit& limit = *limits.find(price);
+        out[count++] = {price, limit.getTotalVolume(), limit.getSize()};
+        if constexpr (S == Side::Buy) {
+            price = bitmap.findPrev(price);
+        } else {
+            price = bitmap.findNext(price);
         }
     }
+    return count;
 }
 
 /**
- * @brief Executes a market order, consuming volume until fully filled or the book is empty.
- *        Throws if insufficient liquidity.
- * @param volume The desired volume to execute.
+ * @brief Hints the cache to load the level at a price that an upcoming order will rest at.
+ *        Does nothing if the level's page is not materialized.
+ * @param price The price level.
  */
 template<Side S>
-void LOBSide<S>::executeMarket(int32_t volume) {
-    if (volume > totalVolume)
-        throw std::runtime_error("Market order volume exceeds available liquidity.");
+void LOBSide<S>::prefetchLevel(int32_t price) const {
+    if (const Limit* limit = limits.find(price))
+        __builtin_prefetch(limit, 1);
+}
 
-    int32_t originalVolume = volume;
+/**
+ * @brief Hints the cache to load the last order queued at a price, which an order resting there
+ *        will be linked behind. Reads the level, so prefetch it with prefetchLevel first.
+ * @param price The price level.
+ */
+template<Side S>
+void LOBSide<S>::prefetchTail(int32_t price) const {
+    const Limit* limit = limits.find(price);
+    if (limit && limit->getTail())
+        __builtin_prefetch(limit->getTail(), 1);
+}
 
-    while (volume > 0 && bestPrice >= MIN_PRICE && bestPrice <= MAX_PRICE) {
-        Limit& limit = limits[bestPrice];
-        Order* order = limit.getHead();
+/**
+ * @brief Routes this side's level changes to a depth update buffer.
+ * @param updates The buffer, or nullptr to stop publishing.
+ */
+template<Side S>
+void LOBSide<S>::setDepthUpdates(DepthUpdateBuffer* updates) {
+    depthUpdates = updates;
+}
 
-        while (volume > 0 && order) {
-            int orderShares = order->getShares();
-            if (volume >= orderShares) {
-                volume -= orderShares;
-                totalVolume -= orderShares;
-                limit.adjustVolume(-orderShares);
+/**
+ * @brief Records the time each level of a sweep takes to trade into a latency histogram.
+ * @param stats The book's latency stats, or nullptr to stop recording.
+ */
+template<Side S>
+void LOBSide<S>::setLatencyStats(LatencyStats* stats) {
+    latencyStats = stats;
+}
 
-                Order* next = order->getNextOrder();
-                limit.removeOrder(order);
-                order = next;
-            } else {
-                order->setShares(orderShares - volume);
-                totalVolume -= volume;
-                limit.adjustVolume(-volume);
-                volume = 0;
-            }
+/**
+ * @brief Trades one level, recording its duration under LatencyOp::MatchLevel when latency stats
+ *        are compiled in and attached.
+ * @param trade Performs the fills at the level.
+ */
+template<Side S>
+template<typename Fn>
+void LOBSide<S>::timeLevel(Fn&& trade) {
+    if constexpr (LATENCY_STATS_ENABLED) {
+        if (latencyStats) {
+            LatencyTimer timer(*latencyStats, LatencyOp::MatchLevel);
+            trade();
+            return;
         }
+    }
+    trade();
+}
 
-        if (limit.empty()) {
-            int chunk = bestPrice / 64;
-            int bit = bestPrice % 64;
-            bitmap[chunk] &= ~(1ULL << bit);
-            updateBestPrice();
-        } else {
-            break;
-        }
+/**
+ * @brief Records the current state of a level that the current message changed.
+ */
+template<Side S>
+void LOBSide<S>::publishLevel(const Limit& limit) {
+    if (depthUpdates)
+        depthUpdates->record(S, limit.getLimitPrice(), limit.getTotalVolume(), limit.getSize());
+}
+
+/**
+ * @brief Recomputes the best price from the bitmap after the best level empties.
+ *        Costs a few ctz/clz operations wherever the remaining levels sit in the range.
+ */
+template<Side S>
+void LOBSide<S>::updateBestPrice() {
+    if constexpr (S == Side::Buy) {
+        bestPrice = bitmap.findLast();
+    } else {
+        int32_t first = bitmap.findFirst();
+        bestPrice = first < 0 ? MAX_PRICE + 1 : first;
     }
 }
 
 /**
- * @brief Executes matching volume against the best limit, decrementing the volume reference.
+ * @brief Masks a bitmap word down to the price given and the prices behind it, in the order a
+ *        sweep visits them (upwards on the sell side, downwards on the buy side).
+ * @param word The level-0 word covering price.
+ * @param price The price to start from.
+ */
+template<Side S>
+uint64_t LOBSide<S>::bitsFrom(uint64_t word, int32_t price) {
+    if constexpr (S == Side::Buy) {
+        return word & (~0ULL >> (63 - (price & 63)));
+    } else {
+        return word & (~0ULL << (price & 63));
+    }
+}
+
+/**
+ * @brief Executes a market order, consuming volume until fully filled or the book is empty.
+ *        Throws if insufficient liquidity.
+ * @param volume The desired volume to execute.
+ * @param policy Allocation of each level's share among its orders (FifoMatching, ProRataMatching).
+ * @param check Self-trade prevention (NoSelfTradeCheck, SelfTradeCheck).
+ * @param onFill Called as onFill(restingOrder, quantity) for every match, after the resting order's
+ *               shares have been reduced to its leaves. Orders with zero leaves are already unlinked.
+ * @param onCancel Called as onCancel(restingOrder) for every order self-trade prevention unlinked.
+ * @return Volume left unfilled, which only self-trade prevention can leave.
+ */
+template<Side S>
+template<typename Policy, typename Check, typename OnFill, typename OnCancel>
+int32_t LOBSide<S>::executeMarket(int32_t volume, const Policy& policy, Check& check, OnFill&& onFill,
+                                  OnCancel&& onCancel) {
+    executeMatching(volume, policy, check, onFill, onCancel);
+    return volume;
+}
+
+/**
+ * @brief Executes matching volume against the best limits at any price, decrementing the volume reference.
+ *
  * @param volume Reference to the remaining volume to fill (decrements as filled).
+ * @param policy Allocation of each level's share among its orders (FifoMatching, ProRataMatching).
+ * @param check Self-trade prevention (NoSelfTradeCheck, SelfTradeCheck).
+ * @param onFill Called as onFill(restingOrder, quantity) for every match; see sweep.
+ * @param onCancel Called as onCancel(restingOrder) for every order self-trade prevention unlinked.
+ * @throws std::runtime_error if volume exceeds the side's total volume.
  */
 template<Side S>
-void LOBSide<S>::executeMatching(int32_t& volume) {
+template<typename Policy, typename Check, typename OnFill, typename OnCancel>
+void LOBSide<S>::executeMatching(int32_t& volume, const Policy& policy, Check& check, OnFill&& onFill,
+                                 OnCancel&& onCancel) {
     if (volume > totalVolume) {
         throw std::runtime_error("Market order volume exceeds available liquidity.");
     }
+    sweep(volume, S == Side::Buy ? MIN_PRICE : MAX_PRICE, policy, check, onFill, onCancel);
+}
 
-    while (volume > 0 && bestPrice >= MIN_PRICE && bestPrice <= MAX_PRICE) {
-        Limit& limit = limits[bestPrice];
-        Order* order = limit.getHead();
-
-        while (volume > 0 && order) {
-            int orderShares = order->getShares();
-            if (volume >= orderShares) {
-                volume -= orderShares;
-                totalVolume -= orderShares;
-                limit.adjustVolume(-orderShares);
+/**
+ * @brief Matches an aggressive order through every level it crosses in one pass.
+ *
+ * The walk runs over the bitmap word under the cursor, so each further level in the same word
+ * costs one ctz/clz; the summary levels are only consulted when a word runs out. Levels taken in
+ * full are consumed head to tail without unlinking their orders one by one, their bits are
+ * cleared with one store per word, and the best price is set once, where the sweep stopped.
+ * Only the last, partially filled level goes through the policy's allocation.
+ *
+ * With a SelfTradeCheck, the orders of each level the incoming order reaches are checked for its
+ * owner before the level trades; with NoSelfTradeCheck that step does not exist in the loop.
+ *
+ * @param volume Reference to the remaining volume to fill (decrements as filled, and as self-trade
+ *               prevention cancels incoming shares).
+ * @param limitPrice Worst price the order may trade at: the highest for the sell side, the lowest for the buy side.
+ * @param policy Allocation of a partially filled level's share among its orders (FifoMatching, ProRataMatching).
+ * @param check Self-trade prevention (NoSelfTradeCheck, SelfTradeCheck).
+ * @param onFill Called as onFill(restingOrder, quantity) for every match, after the resting order's
+ *               shares have been reduced to its leaves. Orders with zero leaves are already unlinked.
+ * @param onCancel Called as onCancel(restingOrder) for every order self-trade prevention unlinked.
+ */
+template<Side S>
+template<typename Policy, typename Check, typename OnFill, typename OnCancel>
+void LOBSide<S>::sweep(int32_t& volume, int32_t limitPrice, const Policy& policy, Check& check, OnFill&& onFill,
+                       OnCancel&& onCancel) {
+    int32_t price = bestPrice;
+    if (volume <= 0 || price < MIN_PRICE || price > MAX_PRICE)
+        return;
 
-                Order* next = order->getNextOrder();
-                limit.removeOrder(order);
-                order = next;
-            } else {
-                order->setShares(orderShares - volume);
-                totalVolume -= volume;
-                limit.adjustVolume(-volume);
-                volume = 0;
+    int32_t word = price >> 6;
+    uint64_t bits = bitsFrom(bitmap.word(word), price);
+    uint64_t consumed = 0;
+    for (;;) {
+        if (!bits) {
+            if (consumed) {
+                bitmap.clearBits(word, consumed);
+                consumed = 0;
             }
+            price = (S == Side::Buy) ? bitmap.findPrev(word << 6) : bitmap.findNext((word << 6) + 63);
+            if (price < 0) {
+                price = (S == Side::Buy) ? -1 : MAX_PRICE + 1;
+                break;
+            }
+            word = price >> 6;
+            bits = bitsFrom(bitmap.word(word), price);
         }
+        const int32_t bit = (S == Side::Buy) ? 63 - __builtin_clzll(bits) : __builtin_ctzll(bits);
+        price = (word << 6) + bit;
+        if (volume == 0 || (S == Side::Buy ? price < limitPrice : price > limitPrice))
+            break;
 
-        if (limit.empty()) {
-            int chunk = bestPrice / 64;
-            int bit = bestPrice % 64;
-            bitmap[chunk] &= ~(1ULL << bit);
-            updateBestPrice();
-        } else {
+        Limit& limit = *limits.find(price);
+        if constexpr (Check::enabled) {
+            if (preventSelfTrades<Policy>(limit, volume, check, onCancel)) {
+                publishLevel(limit);
+                if (limit.empty()) {
+                    limits.vacate(price);
+                    consumed |= 1ULL << bit;
+                    bits &= ~(1ULL << bit);
+                    continue;
+                }
+            }
+            if (volume == 0)
+                break;
+        }
+        if (volume < limit.getTotalVolume()) {
+            const int32_t quantity = volume;
+            volume = 0;
+            totalVolume -= quantity;
+            timeLevel([&] {
+                policy.allocate(limit, quantity, [&](Order* order, int32_t shares) {
+                    const int32_t leaves = order->getShares() - shares;
+                    limit.adjustVolume(-shares);
+                    if (leaves == 0) {
+                        limit.removeOrder(order);
+                    }
+                    order->setShares(leaves);
+                    onFill(order, shares);
+                });
+            });
+            publishLevel(limit);
             break;
         }
+
+        volume -= limit.getTotalVolume();
+        totalVolume -= limit.getTotalVolume();
+        timeLevel([&] { consumeLevel(limit, onFill); });
+        publishLevel(limit);
+        limits.vacate(price);
+        consumed |= 1ULL << bit;
+        bits &= ~(1ULL << bit);
+    }
+
+    if (consumed)
+        bitmap.clearBits(word, consumed);
+    bestPrice = price;
+}
+
+/**
+ * @brief Fills every order queued at a level in full, oldest first, and empties the level.
+ * @param limit The level.
+ * @param onFill Called as onFill(restingOrder, shares) with the order's shares already set to zero.
+ */
+template<Side S>
+template<typename OnFill>
+void LOBSide<S>::consumeLevel(Limit& limit, OnFill& onFill) {
+    Order* order = limit.getHead();
+    limit.clear();
+    while (order) {
+        Order* next = order->getNextOrder();
+        const int32_t shares = order->getShares();
+        order->setShares(0);
+        onFill(order, shares);
+        order = next;
+    }
+}
+
+/**
+ * @brief Applies self-trade prevention to the orders of a level before the level trades.
+ *
+ * Walks the queue from its head. Under time priority only the orders the incoming volume reaches
+ * are visited, and an incoming order that is canceled still trades with the other participants'
+ * orders ahead of its own. Under pro-rata every order at the level would share the fill, so every
+ * order is visited and a canceled incoming order does not trade at the level at all.
+ *
+ * @param limit The level about to trade.
+ * @param volume Remaining incoming volume; reduced by decrements, and capped to what may still
+ *               trade here once the incoming order is canceled.
+ * @param check The incoming order's owner and mode; records what was done to the incoming order.
+ * @param onCancel Called as onCancel(restingOrder) for every resting order unlinked.
+ * @return True if any resting order at the level was reduced or unlinked.
+ */
+template<Side S>
+template<typename Policy, typename OnCancel>
+bool LOBSide<S>::preventSelfTrades(Limit& limit, int32_t& volume, SelfTradeCheck& check, OnCancel& onCancel) {
+    bool changed = false;
+    int32_t ahead = 0; // other participants' shares ahead in the queue
+    Order* order = limit.getHead();
+    while (order && ahead < volume) {
+        Order* next = order->getNextOrder();
+        if (order->getParticipant() != check.owner) {
+            if constexpr (Policy::timePriority)
+                ahead += order->getShares();
+            order = next;
+            continue;
+        }
+
+        int32_t canceled = order->getShares();
+        switch (check.mode) {
+            case SelfTradePrevention::CancelAggressor:
+                check.aggressorCancelled = true;
+                volume = ahead;
+                return changed;
+            case SelfTradePrevention::CancelBoth:
+                check.aggressorCancelled = true;
+                volume = ahead;
+                break;
+            case SelfTradePrevention::DecrementAndCancel: {
+                const int32_t decrement = std::min(canceled, volume - ahead);
+                volume -= decrement;
+                check.decremented += decrement;
+                if (decrement < canceled) {
+                    // the incoming order is used up; the resting one keeps its place with fewer shares
+                    order->setShares(canceled - decrement);
+                    limit.adjustVolume(-decrement);
+                    totalVolume -= decrement;
+                    return true;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        limit.removeOrder(order);
+        limit.adjustVolume(-canceled);
+        totalVolume -= canceled;
+        onCancel(order);
+        changed = true;
+        order = next;
     }
+    return changed;
 }
 
 /**
@@ -267,3 +690,77 @@ template<Side S>
 void LOBSide<S>::adjustTotalVolume(int delta) {
     totalVolume += delta;
 }
+
+/**
+ * @brief Changes the size of a resting order. A decrease keeps its queue position; an increase
+ *        loses time priority and sends the order to the back of its level, as on most venues.
+ * @param order The resting order.
+ * @param newShares Its new size.
+ */
+template<Side S>
+void LOBSide<S>::resizeOrder(Order* order, int32_t newShares) {
+    const int32_t delta = newShares - order->getShares();
+    totalVolume += delta;
+
+    Limit* limit = order->getParentLimit();
+    if (!limit) {
+        order->setShares(newShares);
+        return;
+    }
+    if (delta > 0 && limit->getTail() != order) {
+        limit->removeOrder(order);
+        limit->adjustVolume(-order->getShares());
+        order->setShares(newShares);
+        limit->addOrder(order);
+    } else {
+        order->setShares(newShares);
+        limit->adjustVolume(delta);
+    }
+    publishLevel(*limit);
+}
+
+/**
+ * @brief Rebuilds one price level from a snapshot, linking the orders in the given FIFO order.
+ *        Skips validation and crossing checks; the caller guarantees the level was not already occupied.
+ * @param price The price level (in cents).
+ * @param orders Orders to queue at this level, oldest first.
+ * @param count Number of orders.
+ * @throws std::runtime_error if the level already holds orders.
+ */
+template<Side S>
+void LOBSide<S>::restoreLevel(int32_t price, Order* const* orders, size_t count) {
+    if (count == 0)
+        return;
+    auto& limit = limits.materialize(price);
+    if (!limit.empty())
+        throw std::runtime_error("Snapshot lists a price level twice");
+
+    bitmap.set(price);
+    limits.occupy(price);
+    for (size_t i = 0; i < count; ++i) {
+        limit.addOrder(orders[i]);
+        orders[i]->setParentLimit(&limit);
+    }
+    totalVolume += limit.getTotalVolume();
+    publishLevel(limit);
+
+    if constexpr (S == Side::Buy) {
+        if (price > bestPrice)
+            bestPrice = price;
+    } else {
+        if (price < bestPrice)
+            bestPrice = price;
+    }
+}
+
+/**
+ * @brief Visits every non-empty level from the lowest price to the highest.
+ * @param fn Called as fn(const Limit&) for each level.
+ */
+template<Side S>
+template<typename Fn>
+void LOBSide<S>::forEachLevel(Fn&& fn) const {
+    for (int32_t price = bitmap.findFirst(); price >= 0; price = bitmap.findNext(price)) {
+        fn(static_cast<const Limit&>(*limits.find(price)));
+    }
+}
@@ -0,0 +1,125 @@
+#include "LatencyStats.h"
+#include <algorithm>
+
+/**
+ * @brief Returns the number of samples in a bucket.
+ * @param bucket The bucket index.
+ */
+uint64_t LatencyHistogram::getCount(size_t bucket) const {
+    return counts[bucket].load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the largest sample recorded.
+ */
+int64_t LatencyHistogram::getMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the largest latency that maps to a bucket.
+ * @param bucket The bucket index.
+ * @return Nanoseconds.
+ */
+int64_t LatencyHistogram::highestIn(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<int64_t>(bucket);
+    }
+    const int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+    const int64_t lowest = static_cast<int64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return lowest + (int64_t{1} << shift) - 1;
+}
+
+/**
+ * @brief Adds a live histogram's current counts.
+ * @param histogram The histogram; may be written concurrently by its owner.
+ */
+void LatencyDistribution::merge(const LatencyHistogram& histogram) {
+    for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+        const uint64_t count = histogram.getCount(i);
+        counts[i] += count;
+        total += count;
+    }
+    max = std::max(max, histogram.getMax());
+}
+
+/**
+ * @brief Adds another distribution's counts.
+ * @param other The distribution to fold in.
+ */
+void LatencyDistribution::merge(const LatencyDistribution& other) {
+    for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    max = std::max(max, other.max);
+}
+
+/**
+ * @brief Returns the number of samples.
+ */
+uint64_t LatencyDistribution::getCount() const {
+    return total;
+}
+
+/**
+ * @brief Returns the largest sample, exact rather than bucketed.
+ */
+int64_t LatencyDistribution::getMax() const {
+    return max;
+}
+
+/**
+ * @brief Returns the latency at or below which the given share of samples fall, e.g. 99.9.
+ * @param percent Percentile in [0, 100].
+ * @return Nanoseconds, the upper edge of the matching bucket capped at the maximum (the exact
+ *         maximum for the last sample); 0 if empty.
+ */
+int64_t LatencyDistribution::percentile(double percent) const {
+    if (total == 0) {
+        return 0;
+    }
+    const double clamped = std::clamp(percent, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(total) + 0.5));
+    if (rank >= total) {
+        return max;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(LatencyHistogram::highestIn(i), max);
+        }
+    }
+    return max;
+}
+
+#ifdef EXCHANGE_ENABLE_LATENCY_STATS
+
+/**
+ * @brief Creates empty histograms timed by a TSC clock.
+ */
+LatencyStats::LatencyStats() : clock(ClockSource::Tsc) {}
+
+/**
+ * @brief Adds the current counts of one operation to a distribution.
+ * @param op The operation.
+ * @param out Distribution to merge into.
+ */
+void LatencyStats::mergeInto(LatencyOp op, LatencyDistribution& out) const {
+    out.merge(histograms[static_cast<size_t>(op)]);
+}
+
+#else
+
+/**
+ * @brief Creates stats that record nothing.
+ */
+LatencyStats::LatencyStats() = default;
+
+/**
+ * @brief Leaves the distribution unchanged, since nothing is recorded.
+ */
+void LatencyStats::mergeInto(LatencyOp, LatencyDistribution&) const {}
+
+#endif
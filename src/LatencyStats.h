@@ -0,0 +1,203 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Clock.h"
+
+#ifdef EXCHANGE_ENABLE_LATENCY_STATS
+inline constexpr bool LATENCY_STATS_ENABLED = true;
+#else
+inline constexpr bool LATENCY_STATS_ENABLED = false;
+#endif
+
+/**
+ * @enum LatencyOp
+ * @brief Book operations whose latency is recorded.
+ */
+enum class LatencyOp : uint8_t {
+    AddOrder,
+    CancelOrder,
+    ModifySize,
+    ModifyPrice,
+    MarketSweep,
+    MatchLevel, ///< one price level traded by a sweep, whether taken in full or in part
+    MatchSweep  ///< the crossing part of a limit order, across every level it takes
+};
+
+inline constexpr size_t LATENCY_OP_COUNT = 7;
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear (HDR-style) histogram of nanosecond latencies with one writer and any number of readers.
+ *
+ * Values below 16 ns get a bucket each; above that every power of two is split into 16 buckets,
+ * so any recorded value is reported within 1/16 (6.25%) of its true value. Values beyond
+ * MAX_TRACKED_NANOS land in the last bucket. The writer bumps counters with relaxed loads and
+ * stores rather than read-modify-writes; readers on other threads see a slightly stale but
+ * consistent-enough view.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 36; // ~68 s
+    static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+    static constexpr int64_t MAX_TRACKED_NANOS = (int64_t{1} << (MAX_EXPONENT + 1)) - 1;
+
+    void record(int64_t nanos);
+    uint64_t getCount(size_t bucket) const;
+    int64_t getMax() const;
+
+    static size_t bucketOf(int64_t nanos);
+    static int64_t highestIn(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts{};
+    std::atomic<int64_t> max{0};
+};
+
+/**
+ * @brief Counts one latency sample. Only the owning thread may call this.
+ * @param nanos The latency in nanoseconds.
+ */
+inline void LatencyHistogram::record(int64_t nanos) {
+    std::atomic<uint64_t>& count = counts[bucketOf(nanos)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (nanos > max.load(std::memory_order_relaxed)) {
+        max.store(nanos, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Maps a latency to its bucket.
+ * @param nanos The latency in nanoseconds; negative values count as 0.
+ * @return The bucket index.
+ */
+inline size_t LatencyHistogram::bucketOf(int64_t nanos) {
+    const uint64_t value = static_cast<uint64_t>(std::clamp<int64_t>(nanos, 0, MAX_TRACKED_NANOS));
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    const int exponent = 63 - __builtin_clzll(value);
+    const int shift = exponent - SUB_BUCKET_BITS;
+    return static_cast<size_t>((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1)));
+}
+
+/**
+ * @class LatencyDistribution
+ * @brief Plain copy of one or more histograms, merged on read, with percentile queries.
+ */
+class LatencyDistribution {
+public:
+    void merge(const LatencyHistogram& histogram);
+    void merge(const LatencyDistribution& other);
+
+    uint64_t getCount() const;
+    int64_t getMax() const;
+    int64_t percentile(double percent) const;
+
+private:
+    std::array<uint64_t, LatencyHistogram::BUCKET_COUNT> counts{};
+    uint64_t total = 0;
+    int64_t max = 0;
+};
+
+/**
+ * @class LatencyStats
+ * @brief One latency histogram per LatencyOp for a single book, timed with a TSC clock.
+ *
+ * Holds no storage unless EXCHANGE_ENABLE_LATENCY_STATS is defined; otherwise record() and
+ * LatencyTimer compile to nothing and every distribution reads back empty.
+ */
+class LatencyStats {
+public:
+    LatencyStats();
+
+    Timestamp now() const;
+    void record(LatencyOp op, int64_t nanos);
+    void mergeInto(LatencyOp op, LatencyDistribution& out) const;
+
+    // disable copying
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+
+#ifdef EXCHANGE_ENABLE_LATENCY_STATS
+private:
+    Clock clock;
+    std::array<LatencyHistogram, LATENCY_OP_COUNT> histograms;
+#endif
+};
+
+/**
+ * @brief Reads the stats' clock, or returns 0 when stats are compiled out.
+ */
+inline Timestamp LatencyStats::now() const {
+#ifdef EXCHANGE_ENABLE_LATENCY_STATS
+    return clock.now();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Records one sample of an operation; a no-op when stats are compiled out.
+ * @param op The operation.
+ * @param nanos Its latency in nanoseconds.
+ */
+inline void LatencyStats::record(LatencyOp op, int64_t nanos) {
+#ifdef EXCHANGE_ENABLE_LATENCY_STATS
+    histograms[static_cast<size_t>(op)].record(nanos);
+#else
+    (void)op;
+    (void)nanos;
+#endif
+}
+
+/**
+ * @class LatencyTimer
+ * @brief Scope that records its own duration under an operation; empty when stats are compiled out.
+ */
+class LatencyTimer {
+public:
+    LatencyTimer(LatencyStats& stats, LatencyOp op) : stats(stats), op(op) {
+        if constexpr (LATENCY_STATS_ENABLED) start = stats.now();
+    }
+    ~LatencyTimer() {
+        if constexpr (LATENCY_STATS_ENABLED) stats.record(op, stats.now() - start);
+    }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+private:
+    LatencyStats& stats;
+    LatencyOp op;
+    Timestamp start = 0;
+};
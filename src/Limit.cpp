@@ -52,6 +52,17 @@ void Limit::adjustVolume(int delta) {
     totalVolume += delta;
 }
 
+/**
+ * @brief Empties this limit level in one step, without unlinking its orders one by one.
+ *        Used when a sweep has filled every order queued here.
+ */
+void Limit::clear() {
+    totalVolume = 0;
+    size = 0;
+    head = nullptr;
+    tail = nullptr;
+}
+
 /**
  * @brief Checks if this limit has any orders.
  * @return True if no orders are present, false otherwise.
@@ -21,6 +21,7 @@ public:
     Order* getHead() const;
     Order* getTail() const;
     void adjustVolume(int delta);
+    void clear();
 
 private:
     const int32_t limitPrice;
@@ -0,0 +1,98 @@
+#include "LimitLadder.h"
+#include <new>
+#include <type_traits>
+
+static_assert(std::is_trivially_destructible_v<Limit>, "LimitLadder recycles pages without running Limit destructors");
+
+/**
+ * @brief Constructs an empty ladder covering prices [0, range).
+ * @param range Number of price levels addressable by the ladder.
+ */
+LimitLadder::LimitLadder(int32_t range)
+    : directory((range + PAGE_SIZE - 1) / PAGE_SIZE, nullptr), pageCount(0)
+{}
+
+/**
+ * @brief Frees every live and spare page.
+ */
+LimitLadder::~LimitLadder() {
+    for (Page* page : directory) {
+        delete page;
+    }
+    for (Page* page : sparePages) {
+        delete page;
+    }
+}
+
+/**
+ * @brief Returns the level at a price, materializing its page on first use.
+ *        A page taken from the spare pool is only re-initialized if it last covered other prices;
+ *        its levels are all empty already, so a page coming back to the same prices is reused as is.
+ * @param price The price level.
+ * @return Reference to the Limit.
+ */
+Limit& LimitLadder::materialize(int32_t price) {
+    const int32_t pageIndex = price >> PAGE_BITS;
+    Page*& page = directory[pageIndex];
+    if (!page) {
+        if (!sparePages.empty()) {
+            page = sparePages.back();
+            sparePages.pop_back();
+        } else {
+            page = new Page;
+            page->pageIndex = -1;
+        }
+        if (page->pageIndex != pageIndex) {
+            const int32_t firstPrice = pageIndex << PAGE_BITS;
+            for (int32_t i = 0; i < PAGE_SIZE; ++i) {
+                ::new (static_cast<void*>(page->levels() + i)) Limit(firstPrice + i);
+            }
+            page->pageIndex = pageIndex;
+        }
+        page->occupied = 0;
+        ++pageCount;
+    }
+    return page->levels()[price & (PAGE_SIZE - 1)];
+}
+
+/**
+ * @brief Records that the level at a price went from empty to non-empty.
+ * @param price The price level (its page must be materialized).
+ */
+void LimitLadder::occupy(int32_t price) {
+    directory[price >> PAGE_BITS]->occupied += 1;
+}
+
+/**
+ * @brief Records that the level at a price became empty, releasing the page once all its levels are empty.
+ *        The Limit at that price must not be used after this call.
+ * @param price The price level.
+ */
+void LimitLadder::vacate(int32_t price) {
+    Page*& page = directory[price >> PAGE_BITS];
+    if (--page->occupied > 0) {
+        return;
+    }
+
+    if (sparePages.size() < MAX_SPARE_PAGES) {
+        sparePages.push_back(page);
+    } else {
+        delete page;
+    }
+    page = nullptr;
+    --pageCount;
+}
+
+/**
+ * @brief Returns the number of pages currently materialized.
+ */
+size_t LimitLadder::getPageCount() const {
+    return pageCount;
+}
+
+/**
+ * @brief Returns the number of empty pages held for reuse.
+ */
+size_t LimitLadder::getSparePageCount() const {
+    return sparePages.size();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Limit.h"
+
+/**
+ * @class LimitLadder
+ * @brief Sparse array of Limit levels, materialized one fixed-size page at a time.
+ *
+ * A page of PAGE_SIZE consecutive price levels is only allocated when a price inside it
+ * first receives an order, and is handed back to a small per-ladder pool as soon as its
+ * last non-empty level empties. Looking up a level is a directory read plus an offset,
+ * so top-of-book access stays O(1) while an idle side costs only its directory.
+ */
+class LimitLadder {
+public:
+    static constexpr int32_t PAGE_BITS = 8;
+    static constexpr int32_t PAGE_SIZE = 1 << PAGE_BITS;
+    static constexpr size_t MAX_SPARE_PAGES = 4;
+
+    explicit LimitLadder(int32_t range);
+    ~LimitLadder();
+
+    Limit* find(int32_t price) const;
+    Limit& materialize(int32_t price);
+    void occupy(int32_t price);
+    void vacate(int32_t price);
+
+    size_t getPageCount() const;
+    size_t getSparePageCount() const;
+
+    // disable copying
+    LimitLadder(const LimitLadder&) = delete;
+    LimitLadder& operator=(const LimitLadder&) = delete;
+
+private:
+    struct Page {
+        alignas(Limit) unsigned char storage[PAGE_SIZE * sizeof(Limit)];
+        int32_t occupied;
+        int32_t pageIndex; // which prices the levels were last initialized for
+
+        Limit* levels() { return reinterpret_cast<Limit*>(storage); }
+    };
+
+    std::vector<Page*> directory;
+    std::vector<Page*> sparePages;
+    size_t pageCount;
+};
+
+/**
+ * @brief Returns the level at a price if its page is materialized.
+ * @param price The price level.
+ * @return Pointer to the Limit, or nullptr if no order has touched its page.
+ */
+inline Limit* LimitLadder::find(int32_t price) const {
+    Page* page = directory[price >> PAGE_BITS];
+    return page ? page->levels() + (price & (PAGE_SIZE - 1)) : nullptr;
+}
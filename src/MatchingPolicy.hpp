@@ -0,0 +1,201 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include "Limit.h"
+#include "Order.h"
+#include "ParticipantId.h"
+
+/**
+ * @enum MatchingAlgorithm
+ * @brief How an incoming order's quantity at one price level is shared among the orders resting there.
+ */
+enum class MatchingAlgorithm : uint8_t {
+    Fifo,           ///< price-time priority
+    ProRata,        ///< in proportion to resting size
+    TopOrderProRata ///< the order at the head of the queue first, then pro-rata over the rest
+};
+
+/**
+ * @enum ProRataRounding
+ * @brief How fractional pro-rata shares are rounded. The level always trades the full quantity;
+ *        rounding only decides which orders receive the odd lots.
+ */
+enum class ProRataRounding : uint8_t {
+    Down,    ///< odd lots drift to the back of the queue
+    Up,      ///< odd lots go to the front of the queue
+    Nearest  ///< each order within half a lot of its exact share, ties to the back
+};
+
+/**
+ * @enum SelfTradePrevention
+ * @brief What happens when an incoming order would trade with a resting order of the same participant.
+ *        Orders without a participant never count as self-trades.
+ */
+enum class SelfTradePrevention : uint8_t {
+    None,              ///< self-trades are allowed
+    CancelResting,     ///< the resting order is canceled and matching continues behind it
+    CancelAggressor,   ///< the incoming order trades up to the resting order and the rest is canceled
+    CancelBoth,        ///< the resting order and the rest of the incoming order are canceled
+    DecrementAndCancel ///< both are reduced by the smaller size, without a trade; whichever reaches zero is canceled
+};
+
+/**
+ * @struct MatchingPolicy
+ * @brief Matching configuration of a book, chosen when the instrument is listed.
+ */
+struct MatchingPolicy {
+    MatchingAlgorithm algorithm = MatchingAlgorithm::Fifo;
+    ProRataRounding rounding = ProRataRounding::Down;
+    int32_t topOrderPercent = 100; ///< TopOrderProRata: share of the quantity the head order may take first
+    SelfTradePrevention selfTradePrevention = SelfTradePrevention::None;
+};
+
+/**
+ * @struct NoSelfTradeCheck
+ * @brief Matching without self-trade prevention: the owner comparison is compiled out of the loop.
+ */
+struct NoSelfTradeCheck {
+    static constexpr bool enabled = false;
+};
+
+/**
+ * @struct SelfTradeCheck
+ * @brief Self-trade prevention for one incoming order, and what it did to that order.
+ */
+struct SelfTradeCheck {
+    static constexpr bool enabled = true;
+    ParticipantId owner;
+    SelfTradePrevention mode;
+    int32_t decremented = 0;        ///< incoming shares canceled by DecrementAndCancel
+    bool aggressorCancelled = false; ///< the incoming order may not trade beyond the current level
+};
+
+/**
+ * @struct FifoMatching
+ * @brief Price-time allocation: fill the queue from its head.
+ */
+struct FifoMatching {
+    static constexpr bool timePriority = true; ///< a level fills from its head
+
+    /**
+     * @brief Allocates a quantity over a level's queue.
+     * @param limit The level; quantity must not exceed its volume.
+     * @param quantity Shares to allocate.
+     * @param fill Called as fill(order, shares) in queue order; may unlink the order.
+     */
+    template<typename Fill>
+    void allocate(const Limit& limit, int32_t quantity, Fill&& fill) const {
+        Order* order = limit.getHead();
+        while (quantity > 0 && order) {
+            Order* next = order->getNextOrder();
+            const int32_t shares = std::min(quantity, order->getShares());
+            quantity -= shares;
+            fill(order, shares);
+            order = next;
+        }
+    }
+};
+
+/**
+ * @struct ProRataMatching
+ * @brief Size-proportional allocation, optionally after giving the head order a first share.
+ *
+ * The pro-rata part is one pass over the queue: each order receives the difference between the
+ * rounded cumulative allocation up to and including it and the one before it, i.e.
+ * round(Q * C_i / V) - round(Q * C_{i-1} / V) for quantity Q, level volume V and cumulative
+ * resting size C_i. The shares sum to Q exactly, each is within one lot of the exact
+ * proportional share, and no order receives more than it rests.
+ */
+struct ProRataMatching {
+    static constexpr bool timePriority = false; ///< every order at a level shares the fill
+    ProRataRounding rounding = ProRataRounding::Down;
+    int32_t topOrderPercent = 0; ///< 0 for plain pro-rata
+
+    /**
+     * @brief Allocates a quantity over a level's queue.
+     * @param limit The level; quantity must not exceed its volume.
+     * @param quantity Shares to allocate.
+     * @param fill Called as fill(order, shares) in queue order; may unlink the order.
+     */
+    template<typename Fill>
+    void allocate(const Limit& limit, int32_t quantity, Fill&& fill) const {
+        Order* order = limit.getHead();
+        int64_t volume = limit.getTotalVolume();
+        if (quantity >= volume) {
+            FifoMatching{}.allocate(limit, quantity, fill);
+            return;
+        }
+
+        if (topOrderPercent > 0 && order) {
+            Order* next = order->getNextOrder();
+            const int32_t resting = order->getShares();
+            const int32_t first = std::min<int32_t>(resting, static_cast<int32_t>(int64_t{quantity} * topOrderPercent / 100));
+            if (first > 0) {
+                quantity -= first;
+                fill(order, first);
+            }
+            if (first < resting) {
+                // the head keeps its leaves and competes pro-rata with the rest
+                volume -= first;
+            } else {
+                volume -= resting;
+                order = next;
+            }
+        }
+
+        const int64_t total = quantity;
+        int64_t cumulative = 0;
+        int64_t allocated = 0;
+        while (allocated < total && order) {
+            Order* next = order->getNextOrder();
+            cumulative += order->getShares();
+            const int64_t target = roundShare(total * cumulative, volume);
+            const int32_t shares = static_cast<int32_t>(target - allocated);
+            allocated = target;
+            if (shares > 0) {
+                fill(order, shares);
+            }
+            order = next;
+        }
+    }
+
+    /**
+     * @brief Divides with the configured rounding (operands are non-negative).
+     */
+    int64_t roundShare(int64_t numerator, int64_t denominator) const {
+        switch (rounding) {
+            case ProRataRounding::Up:
+                return (numerator + denominator - 1) / denominator;
+            case ProRataRounding::Nearest:
+                return (2 * numerator + denominator - 1) / (2 * denominator);
+            case ProRataRounding::Down:
+                break;
+        }
+        return numerator / denominator;
+    }
+};
@@ -1,41 +1,38 @@
 #include "Order.h"
 
-/**
- * @brief Utility to get current timestamp in seconds.
- * @return Current time as an integer timestamp.
- */
-inline int getCurrentTimeSeconds() {
-    return static_cast<int>(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
-}
-
 /**
  * @brief Constructs a new Order.
  * @param orderSide The side of the order (buy or sell).
  * @param shares The number of shares.
- * @param limit The limit price (in float), or -1 for market.
+ * @param limit The limit price in ticks, or NO_PRICE for market.
  * @param orderType The order type (Limit or Market).
  * @param parentLimit Pointer to the parent Limit object.
- * @param idSequence Sequence generator to create a unique order ID.
+ * @param orderId Unique order ID, assigned by the book when the order entered.
+ * @param entryTime Time the order entered the book, in nanoseconds; also its first event time.
+ * @param participant Owner of the order, or NO_PARTICIPANT.
  * @throws std::invalid_argument if the order parameters are invalid.
  */
-Order::Order(Side orderSide, int shares, float limit, OrderType orderType, Limit* parentLimit, OrderIdSequence& idSequence)
-    : orderSide(orderSide),
+Order::Order(Side orderSide, int shares, Price limit, OrderType orderType, Limit* parentLimit, int64_t orderId, Timestamp entryTime,
+             ParticipantId participant)
+    : orderId(orderId),
+      entryTime(entryTime),
+      eventTime(entryTime),
       shares(shares),
-      limit(static_cast<int>(std::round(limit * 100))),
+      limit(limit),
+      orderSide(orderSide),
       orderType(orderType),
-      entryTime(getCurrentTimeSeconds()),
-      eventTime(getCurrentTimeSeconds()),
-      parentLimit(parentLimit),
+      participant(participant),
+      poolSlot(0),
+      prevOrder(nullptr),
       nextOrder(nullptr),
-      prevOrder(nullptr)
+      parentLimit(parentLimit)
 {
-    if ((limit <= 0 && orderType == OrderType::Limit) || (limit != -1 && orderType == OrderType::Market)) {
+    if ((limit <= 0 && orderType == OrderType::Limit) || (limit != NO_PRICE && orderType == OrderType::Market)) {
         throw std::invalid_argument("Incorrect limit price");
     }
     if (shares <= 0) {
         throw std::invalid_argument("The order size must be positive");
     }
-    orderId = idSequence.getNextId();
 }
 
 /**
@@ -62,11 +59,27 @@ void Order::setShares(const int shares) {
     this->shares = shares;
 }
 
+/**
+ * @brief Sets the limit price of the order, when it is repriced in place.
+ * @param limit New limit price in ticks.
+ */
+void Order::setLimit(Price limit) {
+    this->limit = limit;
+}
+
+/**
+ * @brief Records the time of the order's latest fill or modification.
+ * @param eventTime Event time in nanoseconds.
+ */
+void Order::setEventTime(Timestamp eventTime) {
+    this->eventTime = eventTime;
+}
+
 /**
  * @brief Returns the limit price of the order.
- * @return Price limit as integer (in cents).
+ * @return Price limit in ticks.
  */
-int Order::getLimit() const {
+Price Order::getLimit() const {
     return limit;
 }
 
@@ -104,17 +117,17 @@ Limit* Order::getParentLimit() const {
 
 /**
  * @brief Returns the entry timestamp of the order.
- * @return Entry time in seconds since epoch.
+ * @return Entry time in nanoseconds on the book's clock.
  */
-int Order::getEntryTime() const {
+Timestamp Order::getEntryTime() const {
     return entryTime;
 }
 
 /**
  * @brief Returns the timestamp of the last event for this order.
- * @return Event time in seconds since epoch.
+ * @return Event time in nanoseconds on the book's clock.
  */
-int Order::getEventTime() const {
+Timestamp Order::getEventTime() const {
     return eventTime;
 }
 
@@ -134,6 +147,22 @@ OrderType Order::getOrderType() const {
     return orderType;
 }
 
+/**
+ * @brief Returns the participant that owns the order.
+ * @return Participant ID, or NO_PARTICIPANT.
+ */
+ParticipantId Order::getParticipant() const {
+    return participant;
+}
+
+/**
+ * @brief Returns the index of the OrderPool slot holding this order.
+ * @return Pool slot index.
+ */
+uint32_t Order::getPoolSlot() const {
+    return poolSlot;
+}
+
 /**
  * @brief Returns the unique order ID.
  * @return Order ID.
@@ -29,6 +29,9 @@
 #include "OrderIdSequence.h"
 #include "Side.hpp"
 #include "OrderType.h"
+#include "ParticipantId.h"
+#include "Price.h"
+#include "Clock.h"
 
 // Forward declaration of Limit
 class Limit;
@@ -39,43 +42,52 @@ struct OrderData;
 /**
  * @class Order
  * @brief Represents an individual order in the order book, containing order details such as side, size, limit price, timestamps, and links to neighboring orders.
+ *        Aligned to a cache line so that pooled orders never straddle two lines.
  */
-class Order {
+class alignas(64) Order {
 public:
-    Order(Side orderSide, int shares, float limit, OrderType orderType, Limit* parentLimit, OrderIdSequence& idSequence);
-    
+    Order(Side orderSide, int shares, Price limit, OrderType orderType, Limit* parentLimit, int64_t orderId, Timestamp entryTime,
+          ParticipantId participant = NO_PARTICIPANT);
+
     Order& operator=(const Order&) = delete;
     Order(const Order&) = delete;
 
     // getters
-    int getLimit() const;
+    Price getLimit() const;
     Side getOrderSide() const;
     Order* getNextOrder() const;
     Order* getPrevOrder() const;
     Limit* getParentLimit() const;
-    int getEntryTime() const;
-    int getEventTime() const;
+    Timestamp getEntryTime() const;
+    Timestamp getEventTime() const;
     int getShares() const;
     int64_t getOrderId() const;
     OrderType getOrderType() const;
+    ParticipantId getParticipant() const;
+    uint32_t getPoolSlot() const;
     
     // setters
     void setNextOrder(Order* nextOrder);
     void setPrevOrder(Order* prevOrder);
     void setShares(const int shares);
+    void setEventTime(Timestamp eventTime);
     void setParentLimit(Limit* parentLimit);
+    void setLimit(Price limit);
 private:
     int64_t orderId;
-    int32_t id;
+    Timestamp entryTime; // ns, when the order entered the book
+    Timestamp eventTime; // ns, last fill or modification
     int32_t shares;
-    int32_t limit; // -1 for market
-    int32_t entryTime;
-    int32_t eventTime;
+    Price limit; // in ticks, NO_PRICE for market
     Side orderSide;
     OrderType orderType;
-    char padding[2]; // to align pointers
+    ParticipantId participant;
+    uint32_t poolSlot; // index of this order's OrderPool slot, set by the pool
     Order* prevOrder;
     Order* nextOrder;
     Limit* parentLimit;
-    char padding2[16]; // pad to 64 bytes exactly
+
+    friend class OrderPool;
 };
+
+static_assert(sizeof(Order) == 64, "Order must occupy exactly one cache line");
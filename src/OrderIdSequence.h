@@ -38,6 +38,16 @@ public:
         return currentId.fetch_add(1, std::memory_order_relaxed);
     }
 
+    // the ID the next call to getNextId() will return, e.g. to persist in a snapshot
+    int64_t peekNextId() const {
+        return currentId.load(std::memory_order_relaxed);
+    }
+
+    // continue the sequence from a restored snapshot
+    void reset(int64_t nextId) {
+        currentId.store(nextId, std::memory_order_relaxed);
+    }
+
 private:
     std::atomic<int64_t> currentId;
 };
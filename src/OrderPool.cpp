@@ -0,0 +1,90 @@
+#include "OrderPool.h"
+#include <stdexcept>
+
+/**
+ * @brief Constructs an empty pool. No memory is reserved until the first order.
+ * @param slotsPerChunk Number of Order slots allocated per chunk.
+ * @throws std::invalid_argument if slotsPerChunk is not a power of two.
+ */
+OrderPool::OrderPool(size_t slotsPerChunk)
+    : freeList(nullptr), slotsPerChunk(slotsPerChunk), chunkShift(0), liveCount(0), highWaterMark(0)
+{
+    if (slotsPerChunk == 0 || (slotsPerChunk & (slotsPerChunk - 1)) != 0) {
+        throw std::invalid_argument("OrderPool chunk size must be a power of two");
+    }
+    while ((size_t{1} << chunkShift) < slotsPerChunk) {
+        ++chunkShift;
+    }
+}
+
+/**
+ * @brief Releases every chunk back to the global allocator.
+ */
+OrderPool::~OrderPool() {
+    for (Slot* chunk : chunks) {
+        ::operator delete(chunk, std::align_val_t{alignof(Slot)});
+    }
+}
+
+/**
+ * @brief Destroys an Order, invalidates its handle and pushes its slot onto the free list.
+ * @param order Pointer previously returned by create().
+ */
+void OrderPool::destroy(Order* order) {
+    const uint32_t index = order->getPoolSlot();
+    ++generations[index];
+    order->~Order();
+    Slot* slot = reinterpret_cast<Slot*>(order);
+    slot->free.next = freeList;
+    slot->free.index = index;
+    freeList = slot;
+    --liveCount;
+}
+
+/**
+ * @brief Allocates a new chunk and threads all of its slots onto the free list.
+ */
+void OrderPool::grow() {
+    Slot* chunk = static_cast<Slot*>(::operator new(slotsPerChunk * sizeof(Slot), std::align_val_t{alignof(Slot)}));
+    chunks.push_back(chunk);
+    const size_t firstIndex = generations.size();
+    generations.resize(firstIndex + slotsPerChunk, 0);
+
+    for (size_t i = slotsPerChunk; i-- > 0;) {
+        chunk[i].free.next = freeList;
+        chunk[i].free.index = static_cast<uint32_t>(firstIndex + i);
+        freeList = &chunk[i];
+    }
+}
+
+/**
+ * @brief Returns the number of Orders currently alive in the pool.
+ * @return Live order count.
+ */
+size_t OrderPool::getLiveCount() const {
+    return liveCount;
+}
+
+/**
+ * @brief Returns the largest number of Orders that were alive at the same time.
+ * @return High-water mark.
+ */
+size_t OrderPool::getHighWaterMark() const {
+    return highWaterMark;
+}
+
+/**
+ * @brief Returns the number of chunks obtained from the global allocator.
+ * @return Chunk count.
+ */
+size_t OrderPool::getChunkCount() const {
+    return chunks.size();
+}
+
+/**
+ * @brief Returns the total number of slots across all chunks.
+ * @return Slot capacity.
+ */
+size_t OrderPool::getCapacity() const {
+    return chunks.size() * slotsPerChunk;
+}
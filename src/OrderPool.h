@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Order.h"
+#include "OrderHandle.h"
+
+/**
+ * @class OrderPool
+ * @brief Slab allocator for Order objects owned by a Book.
+ *
+ * Orders live in 64-byte-aligned slots carved out of large chunks. Released slots are
+ * threaded onto an intrusive free list and reused before any new chunk is requested,
+ * so add/cancel churn never reaches the global allocator once the pool has warmed up.
+ *
+ * Every slot has an index and a generation that is odd while the slot holds an order and
+ * moves on at each create and destroy, so an OrderHandle taken from a live order stops
+ * resolving as soon as that order is gone.
+ */
+class OrderPool {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    explicit OrderPool(size_t slotsPerChunk = DEFAULT_CHUNK_SIZE);
+    ~OrderPool();
+
+    template<typename... Args>
+    Order* create(Args&&... args);
+    void destroy(Order* order);
+    Order* resolve(OrderHandle handle) const;
+    Order* at(uint32_t slot) const;
+    OrderHandle handleOf(const Order* order) const;
+
+    size_t getLiveCount() const;
+    size_t getHighWaterMark() const;
+    size_t getChunkCount() const;
+    size_t getCapacity() const;
+
+    // disable copying
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+private:
+    union alignas(alignof(Order)) Slot {
+        struct {
+            Slot* next;
+            uint32_t index;
+        } free;
+        unsigned char storage[sizeof(Order)];
+    };
+    static_assert(sizeof(Slot) == sizeof(Order), "Order slots must not add padding");
+    static_assert(std::is_trivially_destructible_v<Order>, "OrderPool never runs Order destructors on teardown");
+
+    std::vector<Slot*> chunks;
+    /// generation of each slot, indexed like the slots; odd while the slot holds an order
+    std::vector<uint32_t> generations;
+    Slot* freeList;
+    size_t slotsPerChunk;
+    int chunkShift;
+    size_t liveCount;
+    size_t highWaterMark;
+
+    void grow();
+};
+
+/**
+ * @brief Constructs an Order in a free slot, growing the pool by one chunk if needed.
+ *        The slot is returned to the free list if the Order constructor throws.
+ * @param args Arguments forwarded to the Order constructor.
+ * @return Pointer to the newly constructed Order.
+ */
+template<typename... Args>
+Order* OrderPool::create(Args&&... args) {
+    if (!freeList) {
+        grow();
+    }
+
+    Slot* slot = freeList;
+    freeList = slot->free.next;
+    const uint32_t index = slot->free.index;
+
+    try {
+        Order* order = ::new (static_cast<void*>(slot->storage)) Order(std::forward<Args>(args)...);
+        order->poolSlot = index;
+        ++generations[index];
+        if (++liveCount > highWaterMark) {
+            highWaterMark = liveCount;
+        }
+        return order;
+    } catch (...) {
+        slot->free.next = freeList;
+        freeList = slot;
+        throw;
+    }
+}
+
+/**
+ * @brief Returns the live order a handle refers to, checking the slot's generation before
+ *        touching the order itself.
+ * @param handle Handle taken from a live order with handleOf().
+ * @return Pointer to the order, or nullptr if the handle is stale or was never issued.
+ */
+inline Order* OrderPool::resolve(OrderHandle handle) const {
+    if (handle.slot >= generations.size() || generations[handle.slot] != handle.generation || !(handle.generation & 1)) {
+        return nullptr;
+    }
+    return at(handle.slot);
+}
+
+/**
+ * @brief Returns the order held by a slot, without checking that the slot is live.
+ * @param slot Index of a slot known to hold an order, e.g. from Order::getPoolSlot().
+ * @return Pointer to the order.
+ */
+inline Order* OrderPool::at(uint32_t slot) const {
+    Slot* chunk = chunks[slot >> chunkShift];
+    return reinterpret_cast<Order*>(chunk[slot & (slotsPerChunk - 1)].storage);
+}
+
+/**
+ * @brief Returns the handle of a live order.
+ * @param order Pointer previously returned by create() and not yet destroyed.
+ * @return The order's handle.
+ */
+inline OrderHandle OrderPool::handleOf(const Order* order) const {
+    const uint32_t index = order->getPoolSlot();
+    return {index, generations[index]};
+}
@@ -0,0 +1,78 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include "OrderHandle.h"
+#include "ParticipantId.h"
+#include "OrderType.h"
+#include "Price.h"
+#include "Side.hpp"
+
+/**
+ * @struct OrderRequest
+ * @brief One new order in a batch submitted to Book::submitBatch or Exchange::submitBatch.
+ */
+struct OrderRequest {
+    Side side;
+    OrderType type;
+    int32_t shares;
+    Price limit; // in ticks; ignored for market orders
+    TimeInForce timeInForce = TimeInForce::GoodTillCancel;
+    ParticipantId participant = NO_PARTICIPANT;
+};
+
+/**
+ * @enum OrderStatus
+ * @brief Outcome of an order submission, or of a cancel or modify addressed by OrderHandle.
+ */
+enum class OrderStatus : uint8_t {
+    Resting,                    ///< no fill; the whole order rests on the book
+    PartiallyFilled,            ///< some shares traded and the remainder rests on the book
+    Filled,                     ///< every share traded
+    RejectedInvalidSize,        ///< shares <= 0
+    RejectedInvalidPrice,       ///< limit price <= 0 or beyond the book's range
+    RejectedNoLiquidity,        ///< market order larger than the opposite side
+    RejectedUnknownInstrument,  ///< the instrument is not listed
+    RejectedInvalidTimeInForce, ///< post-only market order, or an unknown time in force
+    RejectedWouldCross,         ///< post-only order that would have traded on arrival
+    RejectedInvalidType,        ///< stop types entered without a stop price
+    Expired,                    ///< IOC or FOK: filledShares traded and the rest was dropped without resting
+    StopPending,                ///< stop order parked until a trade reaches its trigger price
+    Cancelled,                  ///< the order was removed from the book by a cancel
+    RejectedUnknownOrder,       ///< the handle is stale: its order already filled or was canceled
+    CancelledSelfTrade          ///< self-trade prevention canceled the order; filledShares traded before it
+};
+
+/**
+ * @struct OrderResult
+ * @brief Per-order result of a submission.
+ */
+struct OrderResult {
+    int64_t orderId;      ///< ID assigned to the order, or -1 if it was rejected before getting one
+    int32_t filledShares; ///< shares traded on entry
+    OrderStatus status;
+    OrderHandle handle{}; ///< the resting or parked order, for cancels and modifies; invalid otherwise
+};
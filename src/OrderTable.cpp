@@ -0,0 +1,221 @@
+#include "OrderTable.h"
+#include <bit>
+#include <stdexcept>
+
+/**
+ * @brief Constructs an empty table with MIN_CAPACITY slots.
+ */
+OrderTable::OrderTable()
+    : slots(MIN_CAPACITY, value_type{EMPTY, nullptr}),
+      mask(MIN_CAPACITY - 1),
+      shift(64 - std::countr_zero(MIN_CAPACITY)),
+      count(0)
+{}
+
+/**
+ * @brief Inserts an order under its ID, replacing the entry if the ID is already present.
+ * @param orderId The order ID (must be non-negative).
+ * @param order Pointer to the order.
+ * @throws std::invalid_argument if the ID is negative.
+ */
+void OrderTable::insert(int64_t orderId, Order* order) {
+    if (orderId < 0) {
+        throw std::invalid_argument("Order ID must be non-negative");
+    }
+    if ((count + 1) * 2 > slots.size()) {
+        rehash(slots.size() * 2);
+    }
+
+    for (size_t i = home(orderId);; i = (i + 1) & mask) {
+        value_type& slot = slots[i];
+        if (slot.first == orderId) {
+            slot.second = order;
+            return;
+        }
+        if (slot.first == EMPTY) {
+            slot = {orderId, order};
+            ++count;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Removes an order by ID, shifting back the entries probed past it so no tombstone is left.
+ * @param orderId The order ID.
+ * @return True if an entry was removed.
+ */
+bool OrderTable::erase(int64_t orderId) {
+    size_t hole = locate(orderId);
+    if (hole == slots.size()) {
+        return false;
+    }
+
+    for (size_t j = (hole + 1) & mask; slots[j].first != EMPTY; j = (j + 1) & mask) {
+        // an entry may fill the hole only if the hole lies between its home slot and where it sits
+        if (((j - home(slots[j].first)) & mask) >= ((j - hole) & mask)) {
+            slots[hole] = slots[j];
+            hole = j;
+        }
+    }
+    slots[hole] = {EMPTY, nullptr};
+    --count;
+
+    return true;
+}
+
+/**
+ * @brief Grows the table so it holds a number of orders without rehashing, e.g. ahead of a bulk load.
+ * @param orders The number of orders the table must hold.
+ */
+void OrderTable::reserve(size_t orders) {
+    if (orders * 2 > slots.size()) {
+        rehash(std::bit_ceil(orders * 2));
+    }
+}
+
+/**
+ * @brief Looks up an order by ID.
+ * @param orderId The order ID.
+ * @return Pointer to the order, or nullptr if not present.
+ */
+Order* OrderTable::get(int64_t orderId) const {
+    const size_t i = locate(orderId);
+    return i == slots.size() ? nullptr : slots[i].second;
+}
+
+/**
+ * @brief Hints the cache to load the home slot of an ID that is about to be inserted or looked up.
+ *        Lets bulk loads that visit IDs out of sequence overlap their cache misses.
+ * @param orderId The order ID.
+ */
+void OrderTable::prefetch(int64_t orderId) const {
+    __builtin_prefetch(&slots[home(orderId)], 1);
+}
+
+/**
+ * @brief Finds an order by ID.
+ * @param orderId The order ID.
+ * @return Iterator to the entry, or end() if not present.
+ */
+OrderTable::const_iterator OrderTable::find(int64_t orderId) const {
+    const value_type* last = slots.data() + slots.size();
+    return const_iterator(slots.data() + locate(orderId), last);
+}
+
+/**
+ * @brief Returns an iterator to the first live order.
+ */
+OrderTable::const_iterator OrderTable::begin() const {
+    const_iterator it(slots.data(), slots.data() + slots.size());
+    it.skipEmpty();
+    return it;
+}
+
+/**
+ * @brief Returns the past-the-end iterator.
+ */
+OrderTable::const_iterator OrderTable::end() const {
+    const value_type* last = slots.data() + slots.size();
+    return const_iterator(last, last);
+}
+
+/**
+ * @brief Returns the number of orders in the table.
+ */
+size_t OrderTable::size() const {
+    return count;
+}
+
+/**
+ * @brief Checks whether the table holds no orders.
+ */
+bool OrderTable::empty() const {
+    return count == 0;
+}
+
+/**
+ * @brief Returns the number of slots currently allocated.
+ */
+size_t OrderTable::capacity() const {
+    return slots.size();
+}
+
+/**
+ * @brief Returns the slot an ID's probe sequence starts from.
+ */
+size_t OrderTable::home(int64_t orderId) const {
+    return static_cast<size_t>((static_cast<uint64_t>(orderId) * 0x9E3779B97F4A7C15ULL) >> shift);
+}
+
+/**
+ * @brief Returns the slot holding an ID, or the capacity if it is not present.
+ */
+size_t OrderTable::locate(int64_t orderId) const {
+    if (orderId < 0) {
+        return slots.size();
+    }
+    for (size_t i = home(orderId);; i = (i + 1) & mask) {
+        if (slots[i].first == orderId) {
+            return i;
+        }
+        if (slots[i].first == EMPTY) {
+            return slots.size();
+        }
+    }
+}
+
+/**
+ * @brief Moves every entry into a table of a new power-of-two capacity.
+ */
+void OrderTable::rehash(size_t newCapacity) {
+    std::vector<value_type> old(newCapacity, value_type{EMPTY, nullptr});
+    old.swap(slots);
+    mask = newCapacity - 1;
+    shift = 64 - std::countr_zero(newCapacity);
+
+    for (const value_type& entry : old) {
+        if (entry.first == EMPTY) {
+            continue;
+        }
+        size_t i = home(entry.first);
+        while (slots[i].first != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = entry;
+    }
+}
+
+/**
+ * @brief Positions the iterator on a slot; skipEmpty() moves it to a live one.
+ */
+OrderTable::const_iterator::const_iterator(const value_type* slot, const value_type* last)
+    : slot(slot), last(last)
+{}
+
+/**
+ * @brief Advances to the next live entry.
+ */
+OrderTable::const_iterator& OrderTable::const_iterator::operator++() {
+    ++slot;
+    skipEmpty();
+    return *this;
+}
+
+/**
+ * @brief Post-increment.
+ */
+OrderTable::const_iterator OrderTable::const_iterator::operator++(int) {
+    const_iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+/**
+ * @brief Skips unused slots up to the end of the table.
+ */
+void OrderTable::const_iterator::skipEmpty() {
+    while (slot != last && slot->first == EMPTY) {
+        ++slot;
+    }
+}
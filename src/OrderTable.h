@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+class Order;
+
+/**
+ * @class OrderTable
+ * @brief Maps order IDs to resting orders in an open-addressing flat hash table.
+ *
+ * Entries live inline in one power-of-two array, probed linearly from a Fibonacci hash
+ * of the ID, so a lookup is usually a single cache line with no per-entry allocation.
+ * Order IDs are drawn from a sequence shared by every book of an exchange, so the IDs a
+ * single book holds are sparse; the table is sized by the peak number of live orders, like
+ * the order pool, rather than by the span of their IDs. It doubles past half full and never
+ * shrinks, and erase shifts the following entries back instead of leaving tombstones.
+ * Iteration visits every live order once, in no particular order.
+ */
+class OrderTable {
+public:
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    using value_type = std::pair<int64_t, Order*>;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = OrderTable::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return *slot; }
+        pointer operator->() const { return slot; }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const { return slot == other.slot; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class OrderTable;
+        const_iterator(const value_type* slot, const value_type* last);
+
+        void skipEmpty();
+
+        const value_type* slot = nullptr;
+        const value_type* last = nullptr;
+    };
+
+    OrderTable();
+
+    void insert(int64_t orderId, Order* order);
+    bool erase(int64_t orderId);
+    void reserve(size_t orders);
+    Order* get(int64_t orderId) const;
+    void prefetch(int64_t orderId) const;
+
+    const_iterator find(int64_t orderId) const;
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    size_t size() const;
+    bool empty() const;
+    size_t capacity() const;
+
+private:
+    /// key of an unused slot; order IDs are never negative
+    static constexpr int64_t EMPTY = -1;
+
+    std::vector<value_type> slots;
+    size_t mask;
+    /// 64 - log2(capacity), so the top bits of the hash select the home slot
+    int shift;
+    size_t count;
+
+    size_t home(int64_t orderId) const;
+    size_t locate(int64_t orderId) const;
+    void rehash(size_t newCapacity);
+};
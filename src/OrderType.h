@@ -24,11 +24,28 @@
 
 #pragma once
 
+#include <cstdint>
+
 /**
  * @enum OrderType
  * @brief Represents the type of order, either a Limit order or a Market order.
+ *        Stop and StopLimit mark orders parked in a book's TriggerBook until their trigger trades.
  */
 enum class OrderType : uint8_t {
     Limit,
-    Market
+    Market,
+    Stop,     ///< becomes an immediate-or-cancel market order when triggered
+    StopLimit ///< becomes a good-till-cancel limit order when triggered
+};
+
+/**
+ * @enum TimeInForce
+ * @brief What happens to the part of a new order that does not trade on arrival.
+ */
+enum class TimeInForce : uint8_t {
+    GoodTillCancel,    ///< the remainder rests on the book
+    ImmediateOrCancel, ///< the remainder is dropped
+    FillOrKill,        ///< the order trades in full on arrival or not at all
+    PostOnly,          ///< limit only; rejected if it would trade on arrival
+    PostOnlyReprice    ///< limit only; moved one tick behind the opposite best price if it would trade
 };
@@ -0,0 +1,74 @@
+#include "ParticipantIndex.h"
+#include <algorithm>
+
+/**
+ * @brief Links an order at the tail of its participant's list.
+ * @param order A pooled order of some participant other than NO_PARTICIPANT, not already linked.
+ */
+void ParticipantIndex::add(const Order* order) {
+    const ParticipantId participant = order->getParticipant();
+    const uint32_t slot = order->getPoolSlot();
+    if (slot >= links.size()) {
+        links.resize(std::max<size_t>(size_t{slot} + 1, links.size() * 2));
+    }
+    if (participant >= lists.size()) {
+        lists.resize(size_t{participant} + 1);
+    }
+
+    List& list = lists[participant];
+    links[slot] = {list.tail, NONE};
+    if (list.tail != NONE) {
+        links[list.tail].next = slot;
+    } else {
+        list.head = slot;
+    }
+    list.tail = slot;
+    ++list.count;
+}
+
+/**
+ * @brief Unlinks an order from its participant's list.
+ * @param order An order previously passed to add().
+ */
+void ParticipantIndex::remove(const Order* order) {
+    List& list = lists[order->getParticipant()];
+    const Link link = links[order->getPoolSlot()];
+    if (link.prev != NONE) {
+        links[link.prev].next = link.next;
+    } else {
+        list.head = link.next;
+    }
+    if (link.next != NONE) {
+        links[link.next].prev = link.prev;
+    } else {
+        list.tail = link.prev;
+    }
+    --list.count;
+}
+
+/**
+ * @brief Returns the pool slot of the oldest linked order of a participant.
+ * @param participant The participant.
+ * @return The slot, or NONE if the participant has no orders.
+ */
+uint32_t ParticipantIndex::first(ParticipantId participant) const {
+    return participant < lists.size() ? lists[participant].head : NONE;
+}
+
+/**
+ * @brief Returns the pool slot of the order linked after another one of the same participant.
+ * @param slot Pool slot of a linked order.
+ * @return The next order's slot, or NONE at the end of the list.
+ */
+uint32_t ParticipantIndex::next(uint32_t slot) const {
+    return links[slot].next;
+}
+
+/**
+ * @brief Returns the number of live orders of a participant.
+ * @param participant The participant.
+ * @return Order count.
+ */
+size_t ParticipantIndex::count(ParticipantId participant) const {
+    return participant < lists.size() ? lists[participant].count : 0;
+}
@@ -0,0 +1,70 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Order.h"
+#include "ParticipantId.h"
+
+/**
+ * @class ParticipantIndex
+ * @brief Threads each participant's live orders into a doubly linked list, so that all of them
+ *        can be found without scanning the book.
+ *
+ * The links live beside the orders rather than in them: a table indexed by the order's
+ * OrderPool slot holds the slots of each order's neighbours, so linking or unlinking an order is
+ * O(1), Order stays one cache line, and a participant's list can be walked ahead of the orders
+ * being removed without touching them. Orders of NO_PARTICIPANT are never passed in, so they cost nothing here.
+ */
+class ParticipantIndex {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    void add(const Order* order);
+    void remove(const Order* order);
+
+    uint32_t first(ParticipantId participant) const;
+    uint32_t next(uint32_t slot) const;
+    size_t count(ParticipantId participant) const;
+
+private:
+    struct Link {
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+    };
+    struct List {
+        uint32_t head = NONE;
+        uint32_t tail = NONE;
+        size_t count = 0;
+    };
+
+    /// pool slots of the neighbours of each linked order, indexed by pool slot
+    std::vector<Link> links;
+    /// one list per participant, indexed by ParticipantId
+    std::vector<List> lists;
+};
@@ -0,0 +1,46 @@
+#include "Price.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * @brief Constructs a scale with the given number of ticks per price unit (100 for cents).
+ * @throws std::invalid_argument if ticksPerUnit is not positive.
+ */
+TickScale::TickScale(int32_t ticksPerUnit)
+    : ticksPerUnit(ticksPerUnit)
+{
+    if (ticksPerUnit <= 0) {
+        throw std::invalid_argument("Ticks per unit must be positive.");
+    }
+}
+
+/**
+ * @brief Rounds a decimal price to the nearest tick.
+ * @param price The decimal price.
+ * @return The price in ticks.
+ * @throws std::invalid_argument if the price is NaN, infinite or its tick count does not fit in a Price.
+ */
+Price TickScale::toTicks(double price) const {
+    const double ticks = std::round(price * ticksPerUnit);
+    if (!std::isfinite(ticks) || ticks < std::numeric_limits<Price>::min() || ticks > std::numeric_limits<Price>::max()) {
+        throw std::invalid_argument("Price cannot be represented in ticks.");
+    }
+    return static_cast<Price>(ticks);
+}
+
+/**
+ * @brief Converts ticks back to a decimal price, e.g. for display.
+ * @param ticks The price in ticks.
+ * @return The decimal price.
+ */
+double TickScale::toDecimal(Price ticks) const {
+    return static_cast<double>(ticks) / ticksPerUnit;
+}
+
+/**
+ * @brief Returns the number of ticks per price unit.
+ */
+int32_t TickScale::getTicksPerUnit() const {
+    return ticksPerUnit;
+}
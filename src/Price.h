@@ -0,0 +1,54 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+/// A price in integer ticks of the instrument it belongs to. Books and orders only ever see ticks.
+using Price = int32_t;
+
+/// Placeholder price carried by market orders.
+constexpr Price NO_PRICE = -1;
+
+/**
+ * @class TickScale
+ * @brief Converts between decimal prices and an instrument's integer ticks.
+ *
+ * Used once at the edge of the exchange, where prices arrive as decimals; everything past
+ * that point works in ticks and never touches floating point.
+ */
+class TickScale {
+public:
+    static constexpr int32_t DEFAULT_TICKS_PER_UNIT = 100;
+
+    explicit TickScale(int32_t ticksPerUnit = DEFAULT_TICKS_PER_UNIT);
+
+    Price toTicks(double price) const;
+    double toDecimal(Price ticks) const;
+    int32_t getTicksPerUnit() const;
+
+private:
+    int32_t ticksPerUnit;
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @class PriceBitmap
+ * @brief Three-level occupancy bitmap over a fixed price range.
+ *
+ * Level 0 holds one bit per price, level 1 one bit per non-empty level-0 word and
+ * the top word one bit per non-empty level-1 word. Finding the lowest or highest
+ * set price, or the next set price on either side of a given one, costs at most
+ * three ctz/clz operations regardless of where the prices sit in the range.
+ *
+ * @tparam N Number of prices tracked (bits 0 .. N-1).
+ */
+template<int32_t N>
+class PriceBitmap {
+public:
+    static constexpr int32_t L0_WORDS = (N + 63) / 64;
+    static constexpr int32_t L1_WORDS = (L0_WORDS + 63) / 64;
+    static_assert(L1_WORDS <= 64, "PriceBitmap range exceeds three levels");
+
+    void set(int32_t pos);
+    void clear(int32_t pos);
+    void clearBits(int32_t word, uint64_t mask);
+    void clearWord(int32_t word);
+    bool test(int32_t pos) const;
+    bool empty() const;
+    uint64_t word(int32_t word) const;
+
+    int32_t findFirst() const;
+    int32_t findLast() const;
+    int32_t findNext(int32_t pos) const;
+    int32_t findPrev(int32_t pos) const;
+
+private:
+    uint64_t top = 0;
+    uint64_t l1[L1_WORDS]{};
+    uint64_t l0[L0_WORDS]{};
+
+    static uint64_t maskAbove(int32_t bit);
+    static uint64_t maskBelow(int32_t bit);
+    int32_t lowestIn(int32_t l1Index) const;
+    int32_t highestIn(int32_t l1Index) const;
+};
+
+/**
+ * @brief Marks a price as occupied, propagating to the summary levels.
+ * @param pos The price (bit index).
+ */
+template<int32_t N>
+void PriceBitmap<N>::set(int32_t pos) {
+    const int32_t w0 = pos >> 6;
+    const int32_t w1 = w0 >> 6;
+    l0[w0] |= 1ULL << (pos & 63);
+    l1[w1] |= 1ULL << (w0 & 63);
+    top |= 1ULL << w1;
+}
+
+/**
+ * @brief Marks a price as empty, clearing summary bits whose words become empty.
+ * @param pos The price (bit index).
+ */
+template<int32_t N>
+void PriceBitmap<N>::clear(int32_t pos) {
+    clearBits(pos >> 6, 1ULL << (pos & 63));
+}
+
+/**
+ * @brief Marks several prices within one level-0 word as empty in a single store.
+ * @param word Index of the level-0 word.
+ * @param mask Bits of the word to clear.
+ */
+template<int32_t N>
+void PriceBitmap<N>::clearBits(int32_t word, uint64_t mask) {
+    l0[word] &= ~mask;
+    if (l0[word] == 0)
+        clearWord(word);
+}
+
+/**
+ * @brief Clears a whole level-0 word (64 consecutive prices) in one store.
+ * @param word Index of the level-0 word.
+ */
+template<int32_t N>
+void PriceBitmap<N>::clearWord(int32_t word) {
+    const int32_t w1 = word >> 6;
+    l0[word] = 0;
+    l1[w1] &= ~(1ULL << (word & 63));
+    if (l1[w1] == 0)
+        top &= ~(1ULL << w1);
+}
+
+/**
+ * @brief Checks whether a price is occupied.
+ * @param pos The price (bit index).
+ * @return True if the bit is set.
+ */
+template<int32_t N>
+bool PriceBitmap<N>::test(int32_t pos) const {
+    return (l0[pos >> 6] >> (pos & 63)) & 1ULL;
+}
+
+/**
+ * @brief Checks whether no price is occupied.
+ * @return True if every bit is clear.
+ */
+template<int32_t N>
+bool PriceBitmap<N>::empty() const {
+    return top == 0;
+}
+
+/**
+ * @brief Returns the raw level-0 word covering prices [word * 64, word * 64 + 63].
+ * @param word Index of the level-0 word.
+ * @return The occupancy bits of that word.
+ */
+template<int32_t N>
+uint64_t PriceBitmap<N>::word(int32_t word) const {
+    return l0[word];
+}
+
+/**
+ * @brief Returns the lowest occupied price.
+ * @return The price, or -1 if the bitmap is empty.
+ */
+template<int32_t N>
+int32_t PriceBitmap<N>::findFirst() const {
+    if (!top)
+        return -1;
+    return lowestIn(__builtin_ctzll(top));
+}
+
+/**
+ * @brief Returns the highest occupied price.
+ * @return The price, or -1 if the bitmap is empty.
+ */
+template<int32_t N>
+int32_t PriceBitmap<N>::findLast() const {
+    if (!top)
+        return -1;
+    return highestIn(63 - __builtin_clzll(top));
+}
+
+/**
+ * @brief Returns the lowest occupied price strictly above pos.
+ * @param pos Starting price (may be -1 to search from the beginning).
+ * @return The price, or -1 if there is none.
+ */
+template<int32_t N>
+int32_t PriceBitmap<N>::findNext(int32_t pos) const {
+    const int32_t p = pos + 1;
+    if (p >= N)
+        return -1;
+    if (p <= 0)
+        return findFirst();
+
+    const int32_t w0 = p >> 6;
+    const uint64_t m0 = l0[w0] & ~maskBelow(p & 63);
+    if (m0)
+        return (w0 << 6) + __builtin_ctzll(m0);
+
+    const int32_t w1 = w0 >> 6;
+    const uint64_t m1 = l1[w1] & maskAbove(w0 & 63);
+    if (m1) {
+        const int32_t next0 = (w1 << 6) + __builtin_ctzll(m1);
+        return (next0 << 6) + __builtin_ctzll(l0[next0]);
+    }
+
+    const uint64_t mt = top & maskAbove(w1);
+    if (!mt)
+        return -1;
+    return lowestIn(__builtin_ctzll(mt));
+}
+
+/**
+ * @brief Returns the highest occupied price strictly below pos.
+ * @param pos Starting price (may be N to search from the end).
+ * @return The price, or -1 if there is none.
+ */
+template<int32_t N>
+int32_t PriceBitmap<N>::findPrev(int32_t pos) const {
+    const int32_t p = pos - 1;
+    if (p < 0)
+        return -1;
+    if (p >= N - 1)
+        return findLast();
+
+    const int32_t w0 = p >> 6;
+    const uint64_t m0 = l0[w0] & (maskBelow(p & 63) | (1ULL << (p & 63)));
+    if (m0)
+        return (w0 << 6) + 63 - __builtin_clzll(m0);
+
+    const int32_t w1 = w0 >> 6;
+    const uint64_t m1 = l1[w1] & maskBelow(w0 & 63);
+    if (m1) {
+        const int32_t prev0 = (w1 << 6) + 63 - __builtin_clzll(m1);
+        return (prev0 << 6) + 63 - __builtin_clzll(l0[prev0]);
+    }
+
+    const uint64_t mt = top & maskBelow(w1);
+    if (!mt)
+        return -1;
+    return highestIn(63 - __builtin_clzll(mt));
+}
+
+/**
+ * @brief Mask of the bits strictly above the given bit.
+ */
+template<int32_t N>
+uint64_t PriceBitmap<N>::maskAbove(int32_t bit) {
+    return bit >= 63 ? 0 : ~0ULL << (bit + 1);
+}
+
+/**
+ * @brief Mask of the bits strictly below the given bit.
+ */
+template<int32_t N>
+uint64_t PriceBitmap<N>::maskBelow(int32_t bit) {
+    return (1ULL << bit) - 1;
+}
+
+/**
+ * @brief Lowest set price under a non-empty level-1 word.
+ */
+template<int32_t N>
+int32_t PriceBitmap<N>::lowestIn(int32_t l1Index) const {
+    const int32_t w0 = (l1Index << 6) + __builtin_ctzll(l1[l1Index]);
+    return (w0 << 6) + __builtin_ctzll(l0[w0]);
+}
+
+/**
+ * @brief Highest set price under a non-empty level-1 word.
+ */
+template<int32_t N>
+int32_t PriceBitmap<N>::highestIn(int32_t l1Index) const {
+    const int32_t w0 = (l1Index << 6) + 63 - __builtin_clzll(l1[l1Index]);
+    return (w0 << 6) + 63 - __builtin_clzll(l0[w0]);
+}
@@ -0,0 +1,361 @@
+#include "ShardedExchange.hpp"
+#include <stdexcept>
+
+/**
+ * @brief Constructs the exchange and starts one matching thread per shard.
+ * @param exchangeName The name of the exchange.
+ * @param shardCount Number of matching threads (at least one).
+ * @param queueCapacity Capacity of each shard's inbound command queue.
+ */
+ShardedExchange::ShardedExchange(const std::string& exchangeName, size_t shardCount, size_t queueCapacity)
+    : exchangeName(exchangeName), running(true)
+{
+    if (shardCount == 0) {
+        throw std::invalid_argument("A sharded exchange needs at least one shard.");
+    }
+
+    shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards.push_back(std::make_unique<Shard>(i, queueCapacity));
+    }
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards[i]->worker = std::thread(&ShardedExchange::run, this, i);
+    }
+}
+
+/**
+ * @brief Applies every pending command, then stops and joins the matching threads.
+ */
+ShardedExchange::~ShardedExchange() {
+    flush();
+    running.store(false, std::memory_order_release);
+    for (auto& shard : shards) {
+        shard->worker.join();
+    }
+}
+
+/**
+ * @brief Lists a new instrument on the next shard in round-robin order.
+ *        The Book itself is created on the owning shard's thread.
+ * @return The instrument's ID; listing a ticker twice returns the existing ID.
+ */
+InstrumentId ShardedExchange::addInstrument(const std::string& newTicker) {
+    auto [it, inserted] = tickerIds.emplace(newTicker, InstrumentId{static_cast<uint32_t>(placements.size())});
+    if (!inserted) {
+        return it->second;
+    }
+
+    const uint32_t shardIndex = static_cast<uint32_t>(placements.size() % shards.size());
+    const uint32_t bookIndex = shards[shardIndex]->listed++;
+    placements.push_back(Placement{shardIndex, bookIndex});
+
+    submit(shardIndex, Command{CommandType::AddInstrument, Side::Buy, OrderType::Limit, TimeInForce::GoodTillCancel, bookIndex, 0, 0, 0, -1});
+    return it->second;
+}
+
+/**
+ * @brief Submits an order to the shard that owns the ticker.
+ * @return The order ID assigned to the order.
+ */
+int64_t ShardedExchange::addOrder(const std::string& ticker, Side orderSide, int shares, Price limit, OrderType orderType,
+                                  TimeInForce timeInForce) {
+    return addOrder(resolve(ticker), orderSide, shares, limit, orderType, timeInForce);
+}
+
+/**
+ * @brief Submits an order to the shard that owns the instrument.
+ * @return The order ID assigned to the order.
+ * @throws std::runtime_error if the instrument is not listed, std::invalid_argument if a limit
+ *         order has no price; no order ID is consumed in either case.
+ */
+int64_t ShardedExchange::addOrder(InstrumentId instrument, Side orderSide, int shares, Price limit, OrderType orderType,
+                                  TimeInForce timeInForce) {
+    checkListed(instrument);
+    if (orderType == OrderType::Limit && limit == NO_PRICE) {
+        throw std::invalid_argument("Limit price must be provided for limit orders.");
+    }
+    const int64_t orderId = globalOrderId.getNextId();
+    submit(instrument, Command{CommandType::AddOrder, orderSide, orderType, timeInForce, 0, shares, limit, 0, orderId});
+    return orderId;
+}
+
+/**
+ * @brief Submits a stop (limit == NO_PRICE) or stop-limit order to the shard that owns the ticker.
+ * @return The order ID assigned to the order.
+ */
+int64_t ShardedExchange::addStopOrder(const std::string& ticker, Side orderSide, int shares, Price stopPrice, Price limit) {
+    return addStopOrder(resolve(ticker), orderSide, shares, stopPrice, limit);
+}
+
+/**
+ * @brief Submits a stop (limit == NO_PRICE) or stop-limit order to the shard that owns the instrument.
+ * @return The order ID assigned to the order.
+ * @throws std::runtime_error if the instrument is not listed, std::invalid_argument if the stop
+ *         price is out of range or a stop-limit price is not positive; no order ID is consumed in either case.
+ */
+int64_t ShardedExchange::addStopOrder(InstrumentId instrument, Side orderSide, int shares, Price stopPrice, Price limit) {
+    checkListed(instrument);
+    if (stopPrice <= 0 || stopPrice > TriggerBook::MAX_PRICE) {
+        throw std::invalid_argument("Incorrect stop price");
+    }
+    if (limit != NO_PRICE && limit <= 0) {
+        throw std::invalid_argument("Limit price of a stop-limit order must be positive.");
+    }
+    const int64_t orderId = globalOrderId.getNextId();
+    const OrderType orderType = limit == NO_PRICE ? OrderType::Stop : OrderType::StopLimit;
+    submit(instrument, Command{CommandType::AddStopOrder, orderSide, orderType, TimeInForce::GoodTillCancel, 0, shares, limit,
+                               stopPrice, orderId});
+    return orderId;
+}
+
+/**
+ * @brief Submits a cancel to the shard that owns the ticker.
+ */
+void ShardedExchange::cancelOrder(const std::string& ticker, int64_t orderId) {
+    cancelOrder(resolve(ticker), orderId);
+}
+
+/**
+ * @brief Submits a cancel to the shard that owns the instrument.
+ */
+void ShardedExchange::cancelOrder(InstrumentId instrument, int64_t orderId) {
+    submit(instrument, Command{CommandType::CancelOrder, Side::Buy, OrderType::Limit, TimeInForce::GoodTillCancel, 0, 0, 0, 0, orderId});
+}
+
+/**
+ * @brief Submits a price modification to the shard that owns the ticker.
+ */
+void ShardedExchange::modifyLimitPrice(const std::string& ticker, int64_t orderId, Price newLimitPrice) {
+    modifyLimitPrice(resolve(ticker), orderId, newLimitPrice);
+}
+
+/**
+ * @brief Submits a price modification to the shard that owns the instrument.
+ */
+void ShardedExchange::modifyLimitPrice(InstrumentId instrument, int64_t orderId, Price newLimitPrice) {
+    submit(instrument, Command{CommandType::ModifyLimitPrice, Side::Buy, OrderType::Limit, TimeInForce::GoodTillCancel, 0, 0, newLimitPrice, 0, orderId});
+}
+
+/**
+ * @brief Submits a size modification to the shard that owns the ticker.
+ */
+void ShardedExchange::modifyOrderSize(const std::string& ticker, int64_t orderId, int newSize) {
+    modifyOrderSize(resolve(ticker), orderId, newSize);
+}
+
+/**
+ * @brief Submits a size modification to the shard that owns the instrument.
+ */
+void ShardedExchange::modifyOrderSize(InstrumentId instrument, int64_t orderId, int newSize) {
+    submit(instrument, Command{CommandType::ModifyOrderSize, Side::Buy, OrderType::Limit, TimeInForce::GoodTillCancel, 0, newSize, 0, 0, orderId});
+}
+
+/**
+ * @brief Installs the consumer of execution reports. It is invoked on the shard threads, concurrently
+ *        across shards, so it must be set before orders are submitted and must be thread-safe.
+ *        Without a handler, executions are discarded once each command has been applied.
+ */
+void ShardedExchange::setExecutionHandler(ExecutionHandler handler) {
+    flush();
+    executionHandler = std::move(handler);
+}
+
+/**
+ * @brief Installs the consumer of L2 depth updates, called with the book they belong to after each
+ *        command that changed a level. Same threading rules as setExecutionHandler.
+ *        Without a handler, depth updates are discarded.
+ */
+void ShardedExchange::setDepthHandler(DepthHandler handler) {
+    flush();
+    depthHandler = std::move(handler);
+}
+
+/**
+ * @brief Blocks until every shard has applied all commands submitted so far.
+ */
+void ShardedExchange::flush() {
+    for (auto& shard : shards) {
+        while (shard->applied.load(std::memory_order_acquire) != shard->submitted) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of matching threads.
+ */
+size_t ShardedExchange::getShardCount() const {
+    return shards.size();
+}
+
+/**
+ * @brief Returns the shard that owns a ticker.
+ * @throws std::runtime_error if the ticker is not listed.
+ */
+size_t ShardedExchange::getShardFor(const std::string& ticker) const {
+    return placements[resolve(ticker).value].shard;
+}
+
+/**
+ * @brief Retrieves the order book for a ticker. Only safe from the gateway thread after flush().
+ */
+Book* ShardedExchange::getOrderBook(const std::string& ticker) const {
+    auto it = tickerIds.find(ticker);
+    if (it == tickerIds.end()) {
+        return nullptr;
+    }
+    const Placement& placement = placements[it->second.value];
+    const auto& books = shards[placement.shard]->books;
+    return placement.bookIndex < books.size() ? books[placement.bookIndex].get() : nullptr;
+}
+
+/**
+ * @brief Retrieves the top of book slot for a ticker. Look it up from the gateway thread after
+ *        flush(); the slot itself can then be read from any thread while the shard keeps matching.
+ * @return The slot, or nullptr if the ticker is not listed.
+ */
+const TopOfBookSlot* ShardedExchange::getTopOfBook(const std::string& ticker) const {
+    const Book* book = getOrderBook(ticker);
+    return book ? &book->getTopOfBook() : nullptr;
+}
+
+/**
+ * @brief Returns the number of commands the books rejected (unknown IDs, invalid orders, no liquidity).
+ */
+uint64_t ShardedExchange::getRejectCount() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->rejected.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @brief Checks that an instrument is listed, before anything is done on its behalf.
+ * @throws std::runtime_error if the instrument is not listed.
+ */
+void ShardedExchange::checkListed(InstrumentId instrument) const {
+    if (instrument.value >= placements.size()) {
+        throw std::runtime_error("Instrument not covered by the exchange.");
+    }
+}
+
+/**
+ * @brief Routes a command to the shard owning the instrument.
+ * @throws std::runtime_error if the instrument is not listed.
+ */
+void ShardedExchange::submit(InstrumentId instrument, Command command) {
+    checkListed(instrument);
+    const Placement& placement = placements[instrument.value];
+    command.bookIndex = placement.bookIndex;
+    submit(placement.shard, command);
+}
+
+/**
+ * @brief Pushes a command onto a shard's queue, spinning while the queue is full.
+ */
+void ShardedExchange::submit(uint32_t shardIndex, const Command& command) {
+    Shard& shard = *shards[shardIndex];
+    while (!shard.queue.tryPush(command)) {
+        std::this_thread::yield();
+    }
+    ++shard.submitted;
+}
+
+/**
+ * @brief Matching thread body: drains the shard's queue in batches until the exchange shuts down.
+ */
+void ShardedExchange::run(size_t shardIndex) {
+    Shard& shard = *shards[shardIndex];
+    constexpr size_t BATCH = 256;
+
+    while (true) {
+        size_t processed = shard.queue.popBatch(BATCH, [&](const Command& command) { apply(shard, command); });
+        if (processed > 0) {
+            shard.applied.fetch_add(processed, std::memory_order_release);
+            continue;
+        }
+        if (!running.load(std::memory_order_acquire)) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * @brief Applies one command to the shard's books. Failures are counted rather than propagated,
+ *        since the submitting thread has already moved on.
+ */
+void ShardedExchange::apply(Shard& shard, const Command& command) {
+    if (command.type == CommandType::AddInstrument) {
+        if (shard.books.size() <= command.bookIndex) {
+            shard.books.resize(command.bookIndex + 1);
+        }
+        shard.books[command.bookIndex] = std::make_unique<Book>();
+        shard.books[command.bookIndex]->getExecutions().setOverflowHandler(
+            [this, &shard](std::span<const ExecutionReport> batch) {
+                if (executionHandler) {
+                    executionHandler(shard.index, batch);
+                }
+            });
+        Book& book = *shard.books[command.bookIndex];
+        book.getDepthUpdates().setOverflowHandler([this, &shard, &book](std::span<const DepthUpdate> batch) {
+            if (depthHandler) {
+                depthHandler(shard.index, book, batch);
+            }
+        });
+        return;
+    }
+
+    Book& book = *shard.books[command.bookIndex];
+    try {
+        switch (command.type) {
+            case CommandType::AddOrder:
+                book.addOrderToBook(command.side, command.shares, command.limit, command.orderType, command.orderId,
+                                    command.timeInForce);
+                break;
+            case CommandType::CancelOrder:
+                book.cancelOrder(command.orderId);
+                break;
+            case CommandType::ModifyLimitPrice:
+                book.modifyOrderLimitPrice(command.orderId, command.limit);
+                break;
+            case CommandType::ModifyOrderSize:
+                book.modifyOrderSize(command.orderId, command.shares);
+                break;
+            case CommandType::AddStopOrder:
+                book.addStopOrder(command.side, command.shares, command.stopPrice, command.limit, command.orderId);
+                break;
+            case CommandType::AddInstrument:
+                break;
+        }
+    } catch (const std::exception&) {
+        shard.rejected.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ExecutionReportBuffer& executions = book.getExecutions();
+    if (executionHandler) {
+        executions.drain([&](std::span<const ExecutionReport> batch) { executionHandler(shard.index, batch); });
+    } else {
+        executions.drain([](std::span<const ExecutionReport>) {});
+    }
+
+    DepthUpdateBuffer& depthUpdates = book.getDepthUpdates();
+    if (depthHandler) {
+        depthUpdates.drain([&](std::span<const DepthUpdate> batch) { depthHandler(shard.index, book, batch); });
+    } else {
+        depthUpdates.drain([](std::span<const DepthUpdate>) {});
+    }
+}
+
+/**
+ * @brief Resolves a ticker to its instrument ID for the string API.
+ * @throws std::runtime_error if the ticker is not listed.
+ */
+InstrumentId ShardedExchange::resolve(const std::string& ticker) const {
+    auto it = tickerIds.find(ticker);
+    if (it == tickerIds.end()) {
+        throw std::runtime_error("Instrument not covered by the exchange.");
+    }
+    return it->second;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Book.h"
+#include "InstrumentId.h"
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class ShardedExchange
+ * @brief Exchange variant that partitions instruments across N matching threads.
+ *
+ * Every instrument is assigned to one shard when it is listed, and its Book is created and
+ * mutated only by that shard's thread, so each book keeps strict single-writer semantics.
+ * Order entry is a single gateway thread: it assigns order IDs, then hands each command to
+ * the owning shard through a lock-free SPSC queue. Throughput scales with the number of
+ * shards while the gateway only pays for a queue push per message.
+ *
+ * Commands are applied asynchronously. flush() waits until every shard has applied all
+ * commands submitted so far; only after that may books be inspected from the gateway thread.
+ */
+class ShardedExchange {
+public:
+    using ExecutionHandler = std::function<void(size_t shard, std::span<const ExecutionReport>)>;
+    using DepthHandler = std::function<void(size_t shard, const Book& book, std::span<const DepthUpdate>)>;
+
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 1 << 16;
+
+    ShardedExchange(const std::string& exchangeName, size_t shardCount, size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+    ~ShardedExchange();
+
+    InstrumentId addInstrument(const std::string& newTicker);
+    int64_t addOrder(const std::string& ticker, Side orderSide, int shares, Price limit, OrderType orderType,
+                     TimeInForce timeInForce = TimeInForce::GoodTillCancel);
+    int64_t addOrder(InstrumentId instrument, Side orderSide, int shares, Price limit, OrderType orderType,
+                     TimeInForce timeInForce = TimeInForce::GoodTillCancel);
+    int64_t addStopOrder(const std::string& ticker, Side orderSide, int shares, Price stopPrice, Price limit = NO_PRICE);
+    int64_t addStopOrder(InstrumentId instrument, Side orderSide, int shares, Price stopPrice, Price limit = NO_PRICE);
+    void cancelOrder(const std::string& ticker, int64_t orderId);
+    void cancelOrder(InstrumentId instrument, int64_t orderId);
+    void modifyLimitPrice(const std::string& ticker, int64_t orderId, Price newLimitPrice);
+    void modifyLimitPrice(InstrumentId instrument, int64_t orderId, Price newLimitPrice);
+    void modifyOrderSize(const std::string& ticker, int64_t orderId, int newSize);
+    void modifyOrderSize(InstrumentId instrument, int64_t orderId, int newSize);
+
+    void setExecutionHandler(ExecutionHandler handler);
+    void setDepthHandler(DepthHandler handler);
+    void flush();
+
+    size_t getShardCount() const;
+    size_t getShardFor(const std::string& ticker) const;
+    Book* getOrderBook(const std::string& ticker) const;
+    const TopOfBookSlot* getTopOfBook(const std::string& ticker) const;
+    uint64_t getRejectCount() const;
+
+    // Deleted copy constructor and assignment operator to prevent copying
+    ShardedExchange(const ShardedExchange&) = delete;
+    ShardedExchange& operator=(const ShardedExchange&) = delete;
+
+private:
+    enum class CommandType : uint8_t {
+        AddInstrument,
+        AddOrder,
+        CancelOrder,
+        ModifyLimitPrice,
+        ModifyOrderSize,
+        AddStopOrder
+    };
+
+    struct Command {
+        CommandType type;
+        Side side;
+        OrderType orderType;
+        TimeInForce timeInForce;
+        uint32_t bookIndex;
+        int32_t shares;
+        Price limit;
+        Price stopPrice;
+        int64_t orderId;
+    };
+
+    struct Shard {
+        Shard(size_t index, size_t queueCapacity) : index(index), queue(queueCapacity) {}
+
+        const size_t index;
+        SpscQueue<Command> queue;
+        std::vector<std::unique_ptr<Book>> books;
+        uint64_t submitted = 0;                     // gateway thread only
+        uint32_t listed = 0;                        // gateway thread only
+        alignas(64) std::atomic<uint64_t> applied{0};
+        std::atomic<uint64_t> rejected{0};
+        std::thread worker;
+    };
+
+    struct Placement {
+        uint32_t shard;
+        uint32_t bookIndex;
+    };
+
+    void checkListed(InstrumentId instrument) const;
+    void submit(InstrumentId instrument, Command command);
+    void submit(uint32_t shard, const Command& command);
+    void run(size_t shardIndex);
+    void apply(Shard& shard, const Command& command);
+    InstrumentId resolve(const std::string& ticker) const;
+
+    /// the name of the exchange
+    std::string exchangeName;
+    /// Order ID sequence generator
+    OrderIdSequence globalOrderId;
+    /// where each listed instrument lives, indexed by InstrumentId (gateway thread only)
+    std::vector<Placement> placements;
+    /// ticker symbols to instrument IDs, only consulted by the string API
+    std::unordered_map<std::string, InstrumentId> tickerIds;
+    std::vector<std::unique_ptr<Shard>> shards;
+    ExecutionHandler executionHandler;
+    DepthHandler depthHandler;
+    std::atomic<bool> running;
+};
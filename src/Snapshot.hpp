@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class SnapshotWriter
+ * @brief Appends fixed-width fields to a byte buffer in native byte order.
+ *
+ * Snapshots are captured into memory first so the book is only held for as long as a copy
+ * of its resting orders takes; writing the buffer to disk can happen after matching resumes.
+ */
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::vector<char>& out) : out(out) {}
+
+    template<typename T>
+    void put(const T& value);
+    template<typename T>
+    void patch(size_t offset, const T& value);
+    char* extend(size_t length);
+    size_t size() const;
+
+private:
+    std::vector<char>& out;
+};
+
+/**
+ * @class SnapshotReader
+ * @brief Reads fields written by a SnapshotWriter, throwing on a truncated buffer.
+ */
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::span<const char> data) : data(data), offset(0) {}
+
+    template<typename T>
+    T get();
+    const char* take(size_t length);
+    bool atEnd() const;
+
+private:
+    std::span<const char> data;
+    size_t offset;
+};
+
+/**
+ * @brief Appends one trivially copyable value.
+ */
+template<typename T>
+void SnapshotWriter::put(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Snapshot fields must be trivially copyable");
+    std::memcpy(extend(sizeof(T)), &value, sizeof(T));
+}
+
+/**
+ * @brief Overwrites a value written earlier, e.g. a count only known after its entries.
+ * @param offset Buffer offset returned by size() before the placeholder was put.
+ */
+template<typename T>
+void SnapshotWriter::patch(size_t offset, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Snapshot fields must be trivially copyable");
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+/**
+ * @brief Grows the buffer by length bytes and returns where they start, for bulk copies.
+ */
+inline char* SnapshotWriter::extend(size_t length) {
+    const size_t start = out.size();
+    out.resize(start + length);
+    return out.data() + start;
+}
+
+/**
+ * @brief Returns the number of bytes in the buffer.
+ */
+inline size_t SnapshotWriter::size() const {
+    return out.size();
+}
+
+/**
+ * @brief Reads one trivially copyable value.
+ * @throws std::runtime_error if the snapshot is truncated.
+ */
+template<typename T>
+T SnapshotReader::get() {
+    static_assert(std::is_trivially_copyable_v<T>, "Snapshot fields must be trivially copyable");
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Consumes length bytes and returns a pointer to them, for bulk reads.
+ * @throws std::runtime_error if the snapshot is truncated.
+ */
+inline const char* SnapshotReader::take(size_t length) {
+    if (length > data.size() - offset) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    const char* start = data.data() + offset;
+    offset += length;
+    return start;
+}
+
+/**
+ * @brief Checks whether every byte has been consumed.
+ */
+inline bool SnapshotReader::atEnd() const {
+    return offset == data.size();
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+/**
+ * @class SpscQueue
+ * @brief Bounded lock-free single-producer/single-consumer ring.
+ *
+ * The producer and consumer indices live on separate cache lines, and each side keeps a
+ * cached copy of the other's index so that it only touches the shared line when its
+ * cached view says the ring is full (producer) or empty (consumer).
+ *
+ * @tparam T Trivially copyable element type.
+ */
+template<typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscQueue elements are copied with plain stores");
+
+public:
+    explicit SpscQueue(size_t capacity);
+
+    bool tryPush(const T& item);
+    bool tryPop(T& item);
+    template<typename Fn>
+    size_t popBatch(size_t maxItems, Fn&& onItem);
+
+    size_t capacity() const;
+
+    // disable copying
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::unique_ptr<T[]> slots;
+    size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail{0}; // written by the producer
+    uint64_t cachedHead = 0;                           // producer's view of head
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> head{0}; // written by the consumer
+    uint64_t cachedTail = 0;                           // consumer's view of tail
+};
+
+/**
+ * @brief Constructs a queue able to hold at least the requested number of elements.
+ * @param capacity Requested capacity, rounded up to a power of two.
+ */
+template<typename T>
+SpscQueue<T>::SpscQueue(size_t capacity)
+    : slots(new T[std::bit_ceil(capacity < 2 ? size_t{2} : capacity)]),
+      mask(std::bit_ceil(capacity < 2 ? size_t{2} : capacity) - 1)
+{}
+
+/**
+ * @brief Appends an element (producer thread only).
+ * @param item The element to copy in.
+ * @return False if the queue is full.
+ */
+template<typename T>
+bool SpscQueue<T>::tryPush(const T& item) {
+    const uint64_t t = tail.load(std::memory_order_relaxed);
+    if (t - cachedHead > mask) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (t - cachedHead > mask)
+            return false;
+    }
+    slots[t & mask] = item;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Removes the oldest element (consumer thread only).
+ * @param item Receives the element.
+ * @return False if the queue is empty.
+ */
+template<typename T>
+bool SpscQueue<T>::tryPop(T& item) {
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    if (h == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h == cachedTail)
+            return false;
+    }
+    item = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Consumes up to maxItems elements, publishing the new head once for the whole batch
+ *        (consumer thread only).
+ * @param maxItems Upper bound on the number of elements consumed.
+ * @param onItem Called with a const reference to each element, oldest first.
+ * @return Number of elements consumed.
+ */
+template<typename T>
+template<typename Fn>
+size_t SpscQueue<T>::popBatch(size_t maxItems, Fn&& onItem) {
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    if (h == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h == cachedTail)
+            return 0;
+    }
+
+    const uint64_t available = cachedTail - h;
+    const size_t count = available < maxItems ? static_cast<size_t>(available) : maxItems;
+    for (size_t i = 0; i < count; ++i) {
+        onItem(static_cast<const T&>(slots[(h + i) & mask]));
+    }
+    head.store(h + count, std::memory_order_release);
+    return count;
+}
+
+/**
+ * @brief Returns the number of elements the queue can hold.
+ */
+template<typename T>
+size_t SpscQueue<T>::capacity() const {
+    return mask + 1;
+}
@@ -0,0 +1,128 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Price.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @struct TopOfBook
+ * @brief Best bid and offer of one book: price, resting shares and resting orders on each side.
+ */
+struct TopOfBook {
+    Price bidPrice = NO_PRICE; ///< best bid, or NO_PRICE if no buy order rests
+    int32_t bidVolume = 0;     ///< total resting shares at the best bid
+    int32_t bidOrders = 0;     ///< number of resting orders at the best bid
+    Price askPrice = NO_PRICE; ///< best offer, or NO_PRICE if no sell order rests
+    int32_t askVolume = 0;     ///< total resting shares at the best offer
+    int32_t askOrders = 0;     ///< number of resting orders at the best offer
+
+    bool operator==(const TopOfBook&) const = default;
+};
+
+/**
+ * @class TopOfBookSlot
+ * @brief Single-writer, many-reader seqlock holding a book's current TopOfBook.
+ *
+ * The matching thread publishes by making the version odd, storing the fields and making the
+ * version even again; it never waits for readers. The fields are atomics ordered by release
+ * stores and acquire loads rather than fences, which on x86 compile to plain moves. A reader copies the fields between two
+ * version loads and keeps the copy only if both saw the same even version. The slot fills a
+ * cache line of its own, so polling readers only contend with the writer of this book.
+ */
+class alignas(64) TopOfBookSlot {
+public:
+    void publish(const TopOfBook& top);
+    bool tryRead(TopOfBook& top) const;
+    TopOfBook read() const;
+    uint64_t getVersion() const;
+
+private:
+    std::atomic<uint64_t> version{0};   // odd while a publish is in progress
+    std::atomic<int32_t> bidPrice{NO_PRICE};
+    std::atomic<int32_t> bidVolume{0};
+    std::atomic<int32_t> bidOrders{0};
+    std::atomic<int32_t> askPrice{NO_PRICE};
+    std::atomic<int32_t> askVolume{0};
+    std::atomic<int32_t> askOrders{0};
+};
+
+static_assert(sizeof(TopOfBookSlot) == 64, "A top of book slot fills exactly one cache line");
+
+/**
+ * @brief Replaces the slot's contents (the book's matching thread only).
+ * @param top The new best bid and offer.
+ */
+inline void TopOfBookSlot::publish(const TopOfBook& top) {
+    const uint64_t v = version.load(std::memory_order_relaxed);
+    version.store(v + 1, std::memory_order_relaxed);
+    // release stores keep the odd version ahead of the fields for any reader that sees a new field
+    bidPrice.store(top.bidPrice, std::memory_order_release);
+    bidVolume.store(top.bidVolume, std::memory_order_release);
+    bidOrders.store(top.bidOrders, std::memory_order_release);
+    askPrice.store(top.askPrice, std::memory_order_release);
+    askVolume.store(top.askVolume, std::memory_order_release);
+    askOrders.store(top.askOrders, std::memory_order_release);
+    version.store(v + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Makes one attempt at a consistent copy; wait-free, safe from any thread.
+ * @param top Receives the copy; left unspecified when the attempt fails.
+ * @return False if a publish overlapped the attempt.
+ */
+inline bool TopOfBookSlot::tryRead(TopOfBook& top) const {
+    const uint64_t before = version.load(std::memory_order_acquire);
+    if (before & 1)
+        return false;
+    // acquire loads keep the second version load behind the fields
+    top.bidPrice = bidPrice.load(std::memory_order_acquire);
+    top.bidVolume = bidVolume.load(std::memory_order_acquire);
+    top.bidOrders = bidOrders.load(std::memory_order_acquire);
+    top.askPrice = askPrice.load(std::memory_order_acquire);
+    top.askVolume = askVolume.load(std::memory_order_acquire);
+    top.askOrders = askOrders.load(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == before;
+}
+
+/**
+ * @brief Returns a consistent copy, retrying while publishes overlap; safe from any thread.
+ *        Only a reader racing a continuously publishing book retries more than once.
+ */
+inline TopOfBook TopOfBookSlot::read() const {
+    TopOfBook top;
+    while (!tryRead(top)) {
+    }
+    return top;
+}
+
+/**
+ * @brief Returns a counter that grows by two with every publish, so a reader polling many slots
+ *        can skip the ones that have not changed since its last copy.
+ */
+inline uint64_t TopOfBookSlot::getVersion() const {
+    return version.load(std::memory_order_acquire);
+}
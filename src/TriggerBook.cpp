@@ -0,0 +1,132 @@
+#include "TriggerBook.h"
+
+/**
+ * @brief Constructs an empty trigger book; trigger price pages are materialized on demand.
+ */
+TriggerBook::TriggerBook()
+    : buyStops(RANGE),
+      sellStops(RANGE),
+      releasedHead(nullptr),
+      releasedTail(nullptr),
+      parked(0)
+{}
+
+/**
+ * @brief Parks a stop order behind any stops already waiting at the same trigger price.
+ * @param order The stop order; its limit is the price it trades at once triggered.
+ * @param stopPrice The trigger price, within (0, MAX_PRICE].
+ */
+void TriggerBook::add(Order* order, Price stopPrice) {
+    LimitLadder& ladder = order->getOrderSide() == Side::Buy ? buyStops : sellStops;
+    PriceBitmap<RANGE>& triggers = order->getOrderSide() == Side::Buy ? buyTriggers : sellTriggers;
+    Limit& limit = ladder.materialize(stopPrice);
+    if (limit.empty()) {
+        triggers.set(stopPrice);
+        ladder.occupy(stopPrice);
+    }
+    limit.addOrder(order);
+    order->setParentLimit(&limit);
+    ++parked;
+}
+
+/**
+ * @brief Unlinks a parked stop order, e.g. when it is canceled. The order itself is not released.
+ * @param order The parked order.
+ */
+void TriggerBook::remove(Order* order) {
+    LimitLadder& ladder = order->getOrderSide() == Side::Buy ? buyStops : sellStops;
+    PriceBitmap<RANGE>& triggers = order->getOrderSide() == Side::Buy ? buyTriggers : sellTriggers;
+    Limit& limit = *order->getParentLimit();
+    const Price stopPrice = limit.getLimitPrice();
+    limit.adjustVolume(-order->getShares());
+    limit.removeOrder(order);
+    order->setParentLimit(nullptr);
+    --parked;
+    if (limit.empty()) {
+        triggers.clear(stopPrice);
+        ladder.vacate(stopPrice);
+    }
+}
+
+/**
+ * @brief Changes the size of a parked stop order, keeping its place in the queue.
+ * @param order The parked order.
+ * @param newShares Its new size.
+ */
+void TriggerBook::resize(Order* order, int32_t newShares) {
+    order->getParentLimit()->adjustVolume(newShares - order->getShares());
+    order->setShares(newShares);
+}
+
+/**
+ * @brief Moves every stop whose trigger a trade has crossed onto the release queue.
+ * @param high Highest price traded since the last call, or -1 if none; fires buy stops at or below it.
+ * @param low Lowest price traded since the last call, or above MAX_PRICE if none; fires sell stops at or above it.
+ * @return Number of stops released.
+ */
+size_t TriggerBook::trigger(Price high, Price low) {
+    const size_t before = parked;
+    for (int32_t price = buyTriggers.findFirst(); price >= 0 && price <= high; price = buyTriggers.findFirst()) {
+        release(buyStops, buyTriggers, price);
+    }
+    for (int32_t price = sellTriggers.findLast(); price >= 0 && price >= low; price = sellTriggers.findLast()) {
+        release(sellStops, sellTriggers, price);
+    }
+    return before - parked;
+}
+
+/**
+ * @brief Appends a whole trigger price's queue to the release queue and empties that price.
+ */
+void TriggerBook::release(LimitLadder& ladder, PriceBitmap<RANGE>& triggers, int32_t price) {
+    Limit& limit = *ladder.find(price);
+    Order* head = limit.getHead();
+    Order* tail = limit.getTail();
+    parked -= static_cast<size_t>(limit.getSize());
+    for (Order* order = head; order; order = order->getNextOrder()) {
+        order->setParentLimit(nullptr);
+    }
+
+    head->setPrevOrder(releasedTail);
+    if (releasedTail)
+        releasedTail->setNextOrder(head);
+    else
+        releasedHead = head;
+    releasedTail = tail;
+
+    limit.clear();
+    triggers.clear(price);
+    ladder.vacate(price);
+}
+
+/**
+ * @brief Takes the oldest triggered order off the release queue.
+ * @return The order, unlinked from everything, or nullptr if nothing is waiting.
+ */
+Order* TriggerBook::popReleased() {
+    Order* order = releasedHead;
+    if (!order)
+        return nullptr;
+    releasedHead = order->getNextOrder();
+    if (releasedHead)
+        releasedHead->setPrevOrder(nullptr);
+    else
+        releasedTail = nullptr;
+    order->setNextOrder(nullptr);
+    return order;
+}
+
+/**
+ * @brief Returns the number of stops still waiting for their trigger.
+ */
+size_t TriggerBook::size() const {
+    return parked;
+}
+
+/**
+ * @brief Returns the trigger price of a parked stop order.
+ * @param order The parked order.
+ */
+Price TriggerBook::getStopPrice(const Order* order) const {
+    return order->getParentLimit()->getLimitPrice();
+}
@@ -0,0 +1,100 @@
+// An order book implementation
+//
+// MIT License
+//
+// Copyright (c) 2024 Riccardo Canton
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "LOBSide.hpp"
+#include "LimitLadder.h"
+#include "Order.h"
+#include "PriceBitmap.hpp"
+
+/**
+ * @class TriggerBook
+ * @brief Parks a book's stop and stop-limit orders by trigger price until a trade crosses it.
+ *
+ * Each side keeps the same structures as an LOBSide: a paged ladder of Limit queues, one per
+ * trigger price, and an occupancy bitmap over the price range. Buy stops fire when a trade
+ * prints at or above their trigger and sell stops at or below it, so the triggered set is
+ * always a run of adjacent occupied prices starting at one end of the bitmap: finding it costs
+ * one bitmap step per triggered price, however many stops stay parked.
+ *
+ * Triggered orders are unlinked and appended, in trigger order, to a release queue threaded
+ * through their own list pointers, from which the book pops and enters them one at a time.
+ * Within one trigger call, buy stops are released from the lowest trigger up and sell stops
+ * from the highest down, oldest first at each price.
+ */
+class TriggerBook {
+public:
+    static constexpr int32_t MAX_PRICE = LOBSide<Side::Buy>::MAX_PRICE;
+    static constexpr int32_t RANGE = LOBSide<Side::Buy>::RANGE;
+
+    TriggerBook();
+
+    void add(Order* order, Price stopPrice);
+    void remove(Order* order);
+    void resize(Order* order, int32_t newShares);
+    size_t trigger(Price high, Price low);
+    Order* popReleased();
+    template<typename Fn>
+    void forEach(Fn&& fn) const;
+
+    size_t size() const;
+    Price getStopPrice(const Order* order) const;
+
+    // disable copying
+    TriggerBook(const TriggerBook&) = delete;
+    TriggerBook& operator=(const TriggerBook&) = delete;
+
+private:
+    LimitLadder buyStops;
+    LimitLadder sellStops;
+    PriceBitmap<RANGE> buyTriggers;
+    PriceBitmap<RANGE> sellTriggers;
+    Order* releasedHead;
+    Order* releasedTail;
+    size_t parked;
+
+    void release(LimitLadder& ladder, PriceBitmap<RANGE>& triggers, int32_t price);
+};
+
+/**
+ * @brief Visits every parked stop, buy stops from the lowest trigger up and then sell stops
+ *        from the highest down, oldest first at each trigger price: the order they would fire in.
+ * @param fn Called as fn(const Order&, Price stopPrice).
+ */
+template<typename Fn>
+void TriggerBook::forEach(Fn&& fn) const {
+    for (int32_t price = buyTriggers.findFirst(); price >= 0; price = buyTriggers.findNext(price)) {
+        for (const Order* order = buyStops.find(price)->getHead(); order; order = order->getNextOrder()) {
+            fn(*order, price);
+        }
+    }
+    for (int32_t price = sellTriggers.findLast(); price >= 0; price = sellTriggers.findPrev(price)) {
+        for (const Order* order = sellStops.find(price)->getHead(); order; order = order->getNextOrder()) {
+            fn(*order, price);
+        }
+    }
+}